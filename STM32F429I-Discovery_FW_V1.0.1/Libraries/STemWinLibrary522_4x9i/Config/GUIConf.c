@@ -56,6 +56,7 @@ Purpose     : Display controller initialization
   */
 
 #include "GUI.h"
+#include "stm32f429i_discovery_sdram_alloc.h"
 
 /*********************************************************************
 *
@@ -65,10 +66,57 @@ Purpose     : Display controller initialization
 */
 
 //
-// Define the available number of bytes available for the GUI
+// Memory tier of the GUI heap. emWin allocates the window manager
+// objects and the memory device bitmaps from one heap. With memory
+// devices the bitmaps dominate (a 32 bpp full screen device takes
+// 300 KByte), so the heap is placed in the SDRAM and the internal SRAM
+// is left to the application. Without memory devices the heap only holds
+// small, often used objects and stays in the internal SRAM.
 //
+#ifndef   GUI_HEAP_IN_SDRAM
+  #define GUI_HEAP_IN_SDRAM  GUI_SUPPORT_MEMDEV
+#endif
+
+//
+// Define the available number of bytes available for the GUI in the
+// internal SRAM. The default includes the 8 KByte given back by the right
+// sized DMA2D scratch buffers of the display driver
+//
+#ifndef   GUI_NUMBYTES
+  #define GUI_NUMBYTES  (1024 * 134)    // x KByte
+#endif
+
+//
+// Size of the heap in the external SDRAM. It is placed at the end of the
+// SDRAM, in other internal banks than the frame buffers which start at
+// LCD_FRAME_BUFFER: the DMA2D copies from memory devices to the layers do
+// not close the rows opened by the LTDC
+//
+#ifndef   GUI_EXTMEM_NUMBYTES
+  #define GUI_EXTMEM_NUMBYTES  (1024 * 1024 * 4)
+#endif
 
-#define GUI_NUMBYTES  (1024 * 126)    // x KByte
+//
+// Size of the internal SRAM heap used when the SDRAM heap cannot be
+// reserved. It only holds the window manager objects: the memory devices
+// fail to be created
+//
+#ifndef   GUI_FALLBACK_NUMBYTES
+  #define GUI_FALLBACK_NUMBYTES  (1024 * 16)
+#endif
+
+//
+// Average block size used by emWin to size its handle table. Memory
+// device bitmaps are large: a larger average keeps the table of a 4 MByte
+// heap small
+//
+#ifndef   GUI_BLOCKSIZE
+  #if GUI_HEAP_IN_SDRAM
+    #define GUI_BLOCKSIZE  0x80
+  #else
+    #define GUI_BLOCKSIZE  0x20
+  #endif
+#endif
 
 /*********************************************************************
 *
@@ -76,16 +124,15 @@ Purpose     : Display controller initialization
 *
 **********************************************************************
 */
-#if defined ( __CC_ARM   ) 
-  U32 HeapMem[1024 * 1024] __attribute__((at(0xD0100000)));
-#elif defined ( __ICCARM__ ) 
-  #pragma location=0xD0100000
-  static __no_init U32 HeapMem[1024 * 1024];
-#elif defined   (  __GNUC__  ) 
-  U32 HeapMem[1024 * 1024] __attribute__((section(".HeapMemSection")));
-#endif
+static U32 * _pHeapMem;
+static U32   _HeapNumBytes;
+static U32   _HeapPeakUsedBytes;
 
+#if GUI_HEAP_IN_SDRAM
+static U32 _aFallbackMem[GUI_FALLBACK_NUMBYTES / 4];
+#else
 U32 extMem[GUI_NUMBYTES / 4];
+#endif
 
 /*********************************************************************
 *
@@ -99,11 +146,51 @@ U32 extMem[GUI_NUMBYTES / 4];
 *       Get_ExtMemHeap
 *
 * Purpose:
-*   Allocate heap from external memory
+*   Allocate heap from external memory. The heap is reserved in the SDRAM
+*   allocator at the end of the SDRAM: GUI_X_Config() runs before
+*   LCD_X_Config() reserves the frame buffers at the start of the SDRAM.
+*   Returns 0 if the area is already used by another region.
 */
 U32* Get_ExtMemHeap (void)
 {
-  return HeapMem;
+  if (_pHeapMem == 0) {
+    _pHeapMem = (U32 *)SDRAM_RegionReserve("emWin heap", SDRAM_REGION_HEAP,
+                                           (SDRAM_BANK_ADDR + SDRAM_SIZE - GUI_EXTMEM_NUMBYTES) & ~(SDRAM_ROW_SIZE - 1),
+                                           GUI_EXTMEM_NUMBYTES);
+  }
+  return _pHeapMem;
+}
+
+/*********************************************************************
+*
+*       GUI_X_GetHeapStats
+*
+* Purpose:
+*   Returns the use of the GUI heap. The fragmentation is the percentage
+*   of the free bytes which are not part of the largest free block. The
+*   peak is the highest use seen by this function: call it after each
+*   screen update.
+*/
+void GUI_X_GetHeapStats(GUI_HEAP_STATS * pStats)
+{
+  U32 NumFreeBytes;
+  U32 MaxFreeBlock;
+
+  NumFreeBytes = GUI_ALLOC_GetNumFreeBytes();
+  MaxFreeBlock = GUI_ALLOC_GetMaxSize();
+  pStats->NumBytes      = _HeapNumBytes;
+  pStats->NumUsedBytes  = GUI_ALLOC_GetNumUsedBytes();
+  pStats->NumFreeBytes  = NumFreeBytes;
+  pStats->NumFreeBlocks = GUI_ALLOC_GetNumFreeBlocks();
+  pStats->MaxFreeBlock  = MaxFreeBlock;
+  pStats->Fragmentation = 0;
+  if ((NumFreeBytes != 0) && (MaxFreeBlock < NumFreeBytes)) {
+    pStats->Fragmentation = ((NumFreeBytes - MaxFreeBlock) * 100) / NumFreeBytes;
+  }
+  if (pStats->NumUsedBytes > _HeapPeakUsedBytes) {
+    _HeapPeakUsedBytes = pStats->NumUsedBytes;
+  }
+  pStats->PeakUsedBytes = _HeapPeakUsedBytes;
 }
 
 /*********************************************************************
@@ -116,7 +203,24 @@ U32* Get_ExtMemHeap (void)
 */
 void GUI_X_Config(void)
 {
+#if GUI_HEAP_IN_SDRAM
+  //
+  // The SDRAM must be initialized before GUI_Init(). If the SDRAM area is
+  // already used by another region, fall back to the small internal SRAM
+  // heap: GUI_X_GetHeapStats() then reports GUI_FALLBACK_NUMBYTES
+  //
+  if (Get_ExtMemHeap() != 0) {
+    GUI_ALLOC_AssignMemory(Get_ExtMemHeap(), GUI_EXTMEM_NUMBYTES);
+    _HeapNumBytes = GUI_EXTMEM_NUMBYTES;
+  } else {
+    GUI_ALLOC_AssignMemory(_aFallbackMem, GUI_FALLBACK_NUMBYTES);
+    _HeapNumBytes = GUI_FALLBACK_NUMBYTES;
+  }
+#else
   GUI_ALLOC_AssignMemory(extMem, GUI_NUMBYTES);
+  _HeapNumBytes = GUI_NUMBYTES;
+#endif
+  GUI_ALLOC_SetAvBlockSize(GUI_BLOCKSIZE);
 }
 
 /*************************** End of file ****************************/
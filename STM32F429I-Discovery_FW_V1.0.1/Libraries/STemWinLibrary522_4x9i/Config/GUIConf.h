@@ -93,4 +93,22 @@ Purpose     : Configures emWins abilities, fonts etc.
 #define GUI_SUPPORT_MEMDEV            (1)    /* Memory device package available */
 #define GUI_SUPPORT_DEVICES           (1)    /* Enable use of device pointers */
 
+/*********************************************************************
+*
+*       GUI heap statistics (GUIConf.c)
+*/
+#include "Global.h"
+
+typedef struct {
+  U32 NumBytes;       // Size of the heap
+  U32 NumUsedBytes;
+  U32 NumFreeBytes;
+  U32 NumFreeBlocks;
+  U32 MaxFreeBlock;   // Largest block which can be allocated
+  U32 PeakUsedBytes;  // Highest NumUsedBytes returned
+  U32 Fragmentation;  // Free bytes out of the largest free block, percent
+} GUI_HEAP_STATS;
+
+void GUI_X_GetHeapStats(GUI_HEAP_STATS * pStats);
+
 #endif  /* Avoid multiple inclusion */
@@ -66,6 +66,7 @@ can be set here.
 #include "GUI_Private.h"
 #include "GUIDRV_Lin.h"
 #include "global_includes.h"
+#include "GUIDRV_stm32f429i_discovery.h"
 
 /*********************************************************************
 *
@@ -90,10 +91,41 @@ can be set here.
 #define XSIZE_PHYS 240
 #define YSIZE_PHYS 320
 
+//
+// Landscape mode (1): emWin draws 320x240 layers into render buffers, the
+// drawn areas are rotated into the portrait scanout buffers read by the
+// LTDC. The board is to be turned by 90 degrees clockwise.
+//
+#ifndef LCD_LANDSCAPE
+  #define LCD_LANDSCAPE 0
+#endif
+#if LCD_LANDSCAPE
+  #define XSIZE_LOG YSIZE_PHYS
+  #define YSIZE_LOG XSIZE_PHYS
+#else
+  #define XSIZE_LOG XSIZE_PHYS
+  #define YSIZE_LOG YSIZE_PHYS
+#endif
+
+//
+// Tiles of the landscape rotation: 8 or 16 pixels square
+//
+#ifndef LANDSCAPE_TILE_SIZE
+  #define LANDSCAPE_TILE_SIZE 16
+#endif
+
 //
 // Buffers / VScreens
 //
-#define NUM_BUFFERS  1 // Number of multiple buffers to be used
+#ifndef NUM_BUFFERS
+  #define NUM_BUFFERS  3 // Number of multiple buffers to be used (1: single, 2: double, 3: triple buffering)
+#endif
+#ifndef NUM_BUFFERS_0
+  #define NUM_BUFFERS_0 NUM_BUFFERS
+#endif
+#ifndef NUM_BUFFERS_1
+  #define NUM_BUFFERS_1 NUM_BUFFERS
+#endif
 #define NUM_VSCREENS 1 // Number of virtual screens to be used
 
 //
@@ -131,8 +163,8 @@ can be set here.
 //
 // Layer size
 //
-#define XSIZE_0 240
-#define YSIZE_0 320
+#define XSIZE_0 XSIZE_LOG
+#define YSIZE_0 YSIZE_LOG
 
 /*********************************************************************
 *
@@ -142,8 +174,8 @@ can be set here.
 //
 // Layer size
 //
-#define XSIZE_1 240
-#define YSIZE_1 320
+#define XSIZE_1 XSIZE_LOG
+#define YSIZE_1 YSIZE_LOG
 
 /*********************************************************************
 *
@@ -215,8 +247,8 @@ can be set here.
 */
 #undef XSIZE_0
 #undef YSIZE_0
-#define XSIZE_0 XSIZE_PHYS
-#define YSIZE_0 YSIZE_PHYS
+#define XSIZE_0 XSIZE_LOG
+#define YSIZE_0 YSIZE_LOG
 
 #endif
 
@@ -250,9 +282,90 @@ can be set here.
     #error At least one screeen needs to be defined!
   #endif
 #endif
-#if (NUM_VSCREENS > 1) && (NUM_BUFFERS > 1)
+#if (NUM_VSCREENS > 1) && ((NUM_BUFFERS_0 > 1) || (NUM_BUFFERS_1 > 1))
   #error Virtual screens and multiple buffers are not allowed!
 #endif
+#if (NUM_BUFFERS_0 <= 0) || (NUM_BUFFERS_1 <= 0)
+  #error At least one buffer needs to be defined!
+#endif
+#if (NUM_BUFFERS_0 > 3) || (NUM_BUFFERS_1 > 3)
+  #error emWin manages up to 3 buffers per layer!
+#endif
+#if (XSIZE_0 > XSIZE_LOG) || (XSIZE_1 > XSIZE_LOG)
+  #error Layer wider than the display!
+#endif
+#if LCD_LANDSCAPE
+  #if (NUM_VSCREENS > 1)
+    #error Virtual screens are not available in landscape mode!
+  #endif
+  #if (LANDSCAPE_TILE_SIZE != 8) && (LANDSCAPE_TILE_SIZE != 16)
+    #error Landscape tiles are 8 or 16 pixels square!
+  #endif
+  #if (COLOR_MODE_0 == _CM_RGB888) || (COLOR_MODE_0 == _CM_L8) || (COLOR_MODE_0 == _CM_AL44) || \
+      (COLOR_MODE_1 == _CM_RGB888) || (COLOR_MODE_1 == _CM_L8) || (COLOR_MODE_1 == _CM_AL44)
+    #error Landscape mode rotates 16 or 32 bpp layers only!
+  #endif
+#endif
+
+/*********************************************************************
+*
+*       Frame buffer layout
+*
+*   Each layer holds NUM_BUFFERS_x buffers (or NUM_VSCREENS screens) of its
+*   own size and pixel format. Layer 1 follows layer 0 at the next SDRAM
+*   row, the rest of the SDRAM is left to the SDRAM allocator.
+*/
+#define _BYTES_PER_PIXEL(CM)  (((CM) == _CM_ARGB8888) ? 4 : \
+                               ((CM) == _CM_RGB888)   ? 3 : \
+                               (((CM) == _CM_L8) || ((CM) == _CM_AL44)) ? 1 : 2)
+
+#define LAYER_NUMBYTES_0  (XSIZE_0 * YSIZE_0 * _BYTES_PER_PIXEL(COLOR_MODE_0) * NUM_VSCREENS * NUM_BUFFERS_0)
+#define LAYER_NUMBYTES_1  (XSIZE_1 * YSIZE_1 * _BYTES_PER_PIXEL(COLOR_MODE_1) * NUM_VSCREENS * NUM_BUFFERS_1)
+#define LAYER_OFFSET_1    ((LAYER_NUMBYTES_0 + SDRAM_ROW_SIZE - 1) & ~(SDRAM_ROW_SIZE - 1))
+#define LAYER_END_1       (LAYER_OFFSET_1 + LAYER_NUMBYTES_1)
+
+//
+// Landscape mode: the layer buffers above are the render buffers, the
+// scanout buffers of the layers follow. Each layer has one scanout buffer
+// per render buffer (at least 2): the rotation never writes into the
+// buffer scanned by the LTDC.
+//
+#if LCD_LANDSCAPE
+  #define NUM_SCANOUT_0     ((NUM_BUFFERS_0 > 2) ? NUM_BUFFERS_0 : 2)
+  #define NUM_SCANOUT_1     ((NUM_BUFFERS_1 > 2) ? NUM_BUFFERS_1 : 2)
+  #define NUM_SCANOUT_MAX   3
+  #define SCAN_NUMBYTES_0   (XSIZE_0 * YSIZE_0 * _BYTES_PER_PIXEL(COLOR_MODE_0) * NUM_SCANOUT_0)
+  #define SCAN_NUMBYTES_1   (XSIZE_1 * YSIZE_1 * _BYTES_PER_PIXEL(COLOR_MODE_1) * NUM_SCANOUT_1)
+  #define SCAN_OFFSET_0     ((LAYER_END_1 + SDRAM_ROW_SIZE - 1) & ~(SDRAM_ROW_SIZE - 1))
+  #define SCAN_OFFSET_1     ((SCAN_OFFSET_0 + SCAN_NUMBYTES_0 + SDRAM_ROW_SIZE - 1) & ~(SDRAM_ROW_SIZE - 1))
+  #define FRAMEBUFFER_END   (SCAN_OFFSET_1 + SCAN_NUMBYTES_1)
+#else
+  #define FRAMEBUFFER_END   LAYER_END_1
+#endif
+
+//
+// Items of the DMA2D scratch buffers: one line of 32 bit colors, or a
+// complete 256 entries palette
+//
+#define DMA2D_BUFFER_ITEMS  ((XSIZE_LOG > 256) ? XSIZE_LOG : 256)
+
+//
+// Number of converted palettes kept for the DMA2D CLUT (1 KByte each)
+//
+#ifndef   DMA2D_CLUT_CACHE_ITEMS
+  #define DMA2D_CLUT_CACHE_ITEMS  4
+#endif
+
+//
+// Compile time checks of expressions not usable by the preprocessor
+//
+#define _STATIC_ASSERT(Cond, Name)  typedef char Name[(Cond) ? 1 : -1]
+
+_STATIC_ASSERT(FRAMEBUFFER_END <= SDRAM_SIZE,     _LayersFitInSDRAM);
+_STATIC_ASSERT(DMA2D_BUFFER_ITEMS >= XSIZE_LOG,   _DMA2DBufferHoldsLine);
+#if LCD_LANDSCAPE
+_STATIC_ASSERT(((XSIZE_0 | YSIZE_0 | XSIZE_1 | YSIZE_1) % LANDSCAPE_TILE_SIZE) == 0, _LayersMadeOfTiles);
+#endif
 
 /*********************************************************************
 *
@@ -263,7 +376,7 @@ static void _Color2IndexBulk_##PFIX##_DMA2D(LCD_COLOR * pColor, void * pIndex, U
   _DMA_Color2IndexBulk(pColor, pIndex, NumItems, SizeOfIndex, PIXELFORMAT);                                    \
 }                                                                                                              \
 static void _Index2ColorBulk_##PFIX##_DMA2D(void * pIndex, LCD_COLOR * pColor, U32 NumItems, U8 SizeOfIndex) { \
-  _DMA_Index2ColorBulk(pColor, pIndex, NumItems, SizeOfIndex, PIXELFORMAT);                                    \
+  _DMA_Index2ColorBulk(pIndex, pColor, NumItems, SizeOfIndex, PIXELFORMAT);                                    \
 }
 /*********************************************************************
 *
@@ -272,13 +385,72 @@ static void _Index2ColorBulk_##PFIX##_DMA2D(void * pIndex, LCD_COLOR * pColor, U
 **********************************************************************
 */
 static LTDC_Layer_TypeDef       * _apLayer[]        = { LTDC_Layer1, LTDC_Layer2 };
-static const U32                  _aAddr[]          = { LCD_FRAME_BUFFER, LCD_FRAME_BUFFER + XSIZE_PHYS * YSIZE_PHYS * sizeof(U32) * NUM_VSCREENS * NUM_BUFFERS };
+static const U32                  _aAddr[]          = { LCD_FRAME_BUFFER, LCD_FRAME_BUFFER + LAYER_OFFSET_1 };
+static const U32                  _aLayerNumBytes[] = { LAYER_NUMBYTES_0, LAYER_NUMBYTES_1 };
+static const char               * _apLayerName[]    = { "emWin layer 0", "emWin layer 1" };
+static const int                  _aNumBuffers[]    = { NUM_BUFFERS_0, NUM_BUFFERS_1 };
 static int                        _aPendingBuffer[GUI_NUM_LAYERS];
-static int                        _aBufferIndex[GUI_NUM_LAYERS];
+static int                        _aBufferIndex[GUI_NUM_LAYERS];   // Buffer drawn by emWin, not the visible one
+static int                        _aVisibleBuffer[GUI_NUM_LAYERS];
+static GUI_RECT                   _aWindow[GUI_NUM_LAYERS];        // Part read by the LTDC if shrunk
+static U8                         _aWindowState[GUI_NUM_LAYERS];
+static U32                        _aWindowOffset[GUI_NUM_LAYERS];  // Bytes from the buffer start to the window
 static int                        _axSize[GUI_NUM_LAYERS];
 static int                        _aySize[GUI_NUM_LAYERS];
 static int                        _aBytesPerPixels[GUI_NUM_LAYERS];
 
+//
+// _aWindowState
+//
+#define WINDOW_FULL   0                             // Complete layer scanned
+#define WINDOW_SHRUNK 1                             // Only _aWindow scanned
+#define WINDOW_OFF    2                             // Transparent layer switched off
+
+static U32                        _DMA2D_NumOperations;
+static U32                        _DMA2D_WaitCycles;
+static U32                        _MULTIBUF_NumFrames;
+static U32                        _MULTIBUF_NumFlips;
+static U32                        _MULTIBUF_NumTears;
+
+#if LCD_LANDSCAPE
+//
+// Scanout buffers read by the LTDC in landscape mode. The areas drawn since
+// the last rotation are collected in _aDirty, the areas a scanout buffer
+// lacks since it was last written in _aStale
+//
+static const U32                  _aScanAddr[]      = { LCD_FRAME_BUFFER + SCAN_OFFSET_0, LCD_FRAME_BUFFER + SCAN_OFFSET_1 };
+static const U32                  _aScanNumBytes[]  = { SCAN_NUMBYTES_0, SCAN_NUMBYTES_1 };
+static const char               * _apScanName[]     = { "emWin scanout 0", "emWin scanout 1" };
+static const int                  _aNumScanBuffers[] = { NUM_SCANOUT_0, NUM_SCANOUT_1 };
+static const int                  _aScanPitch[]     = { YSIZE_0, YSIZE_1 };  // Pixels per scanout line
+static volatile int               _aPendingScan[GUI_NUM_LAYERS];
+static volatile int               _aVisibleScan[GUI_NUM_LAYERS];
+static GUI_RECT                   _aDirty[GUI_NUM_LAYERS];
+static GUI_RECT                   _aStale[GUI_NUM_LAYERS][NUM_SCANOUT_MAX];
+static U32                        _LANDSCAPE_NumRotations;
+static U32                        _LANDSCAPE_NumPixels;
+static U32                        _LANDSCAPE_Cycles;
+#endif
+
+//
+// Palettes converted to the DMA2D format. The entry loaded into the DMA2D
+// CLUT is resident: drawing with the same palette again loads nothing
+//
+typedef struct {
+  const LCD_COLOR * pPalEntries;
+  U32               Hash;                           // Colors of palettes in RAM, 0 in flash
+  U32               LastUse;
+  U16               NumEntries;
+  U8                Trans;                          // Index 0 transparent
+  U32               aColor[256];
+} CLUT_CACHE_ENTRY;
+
+static CLUT_CACHE_ENTRY           _aCLUTCache[DMA2D_CLUT_CACHE_ITEMS];
+static CLUT_CACHE_ENTRY         * _pCLUTResident;
+static U32                        _CLUT_UseCount;
+static U32                        _CLUT_NumLoads;
+static U32                        _CLUT_NumAvoided;
+
 
 //
 // Prototypes of DMA2D color conversion routines
@@ -295,9 +467,9 @@ DEFINE_DMA2D_COLORCONVERSION(M565,   LTDC_Pixelformat_RGB565)
 DEFINE_DMA2D_COLORCONVERSION(M1555I, LTDC_Pixelformat_ARGB1555)
 DEFINE_DMA2D_COLORCONVERSION(M4444I, LTDC_Pixelformat_ARGB4444)
 
-static U32 _aBuffer_DMA2D[XSIZE_PHYS * sizeof(U32)];
-static U32 _aBuffer_FG   [XSIZE_PHYS * sizeof(U32)];
-static U32 _aBuffer_BG   [XSIZE_PHYS * sizeof(U32)];
+static U32 _aBuffer_DMA2D[DMA2D_BUFFER_ITEMS];
+static U32 _aBuffer_FG   [DMA2D_BUFFER_ITEMS];
+static U32 _aBuffer_BG   [DMA2D_BUFFER_ITEMS];
 /*********************************************************************
 *
 *       Static data
@@ -360,6 +532,110 @@ static int _GetBytesPerLine(int LayerIndex, int xSize) {
   return BytesPerLine;
 }
 
+/*********************************************************************
+*
+*       _GetBufferSize
+*/
+static U32 _GetBufferSize(int LayerIndex) {
+  U32 BufferSize;
+
+  BufferSize = _axSize[LayerIndex] * _aySize[LayerIndex] * _aBytesPerPixels[LayerIndex];
+  return BufferSize;
+}
+
+#if LCD_LANDSCAPE
+/*********************************************************************
+*
+*       _MergeRect
+*/
+static void _MergeRect(GUI_RECT * pRect, int x0, int y0, int x1, int y1) {
+  if (pRect->x0 > x0) {
+    pRect->x0 = x0;
+  }
+  if (pRect->y0 > y0) {
+    pRect->y0 = y0;
+  }
+  if (pRect->x1 < x1) {
+    pRect->x1 = x1;
+  }
+  if (pRect->y1 < y1) {
+    pRect->y1 = y1;
+  }
+}
+
+/*********************************************************************
+*
+*       _ClearRect
+*
+* Purpose:
+*   Makes pRect empty: any rectangle merged into it replaces it.
+*/
+static void _ClearRect(GUI_RECT * pRect) {
+  pRect->x0 = 0x7FFF;
+  pRect->y0 = 0x7FFF;
+  pRect->x1 = -1;
+  pRect->y1 = -1;
+}
+#endif
+
+/*********************************************************************
+*
+*       _MarkDirty
+*
+* Purpose:
+*   Records an area drawn into the layer buffers: in landscape mode it is
+*   rotated into the scanout buffers on the next buffer switch.
+*/
+static void _MarkDirty(int LayerIndex, int x0, int y0, int x1, int y1) {
+#if LCD_LANDSCAPE
+  _MergeRect(&_aDirty[LayerIndex], x0, y0, x1, y1);
+#else
+  GUI_USE_PARA(LayerIndex);
+  GUI_USE_PARA(x0);
+  GUI_USE_PARA(y0);
+  GUI_USE_PARA(x1);
+  GUI_USE_PARA(y1);
+#endif
+}
+
+/*********************************************************************
+*
+*       _DMA_ExecOperation
+*
+* Purpose:
+*   Starts the DMA2D operation set up in the registers and waits for its
+*   transfer complete interrupt (DMA2D_ISR_Handler):
+*   - GUI_OS == 1: the task sleeps in GUI_X_WaitEvent(), the other tasks
+*     run during the transfer. GUI_X_WaitEvent() must keep an event
+*     signaled before the wait (semaphore or event flag).
+*   - GUI_OS == 0: the CPU sleeps in __WFI(). The interrupts are masked
+*     between the check and __WFI(): a pending interrupt wakes up the CPU,
+*     so the end of the transfer cannot be missed.
+*   The cycles spent waiting, given back to the other tasks or saved by
+*   the sleep, are accumulated for LCD_X_DMA2D_GetStats().
+*/
+static void _DMA_ExecOperation(void) {
+  U32 Start;
+
+  Start = DWT->CYCCNT;
+  DMA2D->CR |= DMA2D_CR_START;                      // Control Register (Start operation)
+#if GUI_OS
+  while (DMA2D->CR & DMA2D_CR_START) {
+    GUI_X_WaitEvent();                              // Sleep until the transfer complete event
+  }
+#else
+  __disable_irq();
+  while (DMA2D->CR & DMA2D_CR_START) {
+    __WFI();                                        // Sleep until next interrupt
+    __enable_irq();                                 // Let the pending interrupt run
+    __disable_irq();
+  }
+  __enable_irq();
+#endif
+  _DMA2D_WaitCycles += DWT->CYCCNT - Start;
+  _DMA2D_NumOperations++;
+}
+
 /*********************************************************************
 *
 *       _DMA_LoadLUT
@@ -397,6 +673,76 @@ static void _InvertAlpha_SwapRB(LCD_COLOR * pColorSrc, LCD_COLOR * pColorDst, U3
   } while (--NumItems);
 }
 
+/*********************************************************************
+*
+*       _DMA_LoadLUTCached
+*
+* Purpose:
+*   Makes the palette resident in the DMA2D foreground CLUT. The converted
+*   palette is taken from the cache, the CLUT is only loaded if another
+*   palette is resident. Palettes outside of the internal flash (SRAM, CCM,
+*   SDRAM) are identified by a hash of their colors, as they may be changed
+*   at the same address.
+*   Returns the converted palette.
+*/
+static U32 * _DMA_LoadLUTCached(const LCD_LOGPALETTE GUI_UNI_PTR * pLogPal, int Trans) {
+  CLUT_CACHE_ENTRY * pEntry;
+  CLUT_CACHE_ENTRY * pLRU;
+  const LCD_COLOR  * pColor;
+  U32 Hash;
+  int NumEntries;
+  int i;
+
+  pColor     = pLogPal->pPalEntries;
+  NumEntries = (pLogPal->NumEntries > 256) ? 256 : pLogPal->NumEntries;
+  Hash       = 0;
+  if (((U32)pColor < 0x08000000) || ((U32)pColor > 0x081FFFFF)) {
+    Hash = 2166136261UL;                            // FNV-1a
+    for (i = 0; i < NumEntries; i++) {
+      Hash = (Hash ^ pColor[i]) * 16777619UL;
+    }
+  }
+  _CLUT_UseCount++;
+  pLRU = &_aCLUTCache[0];
+  for (i = 0; i < DMA2D_CLUT_CACHE_ITEMS; i++) {
+    pEntry = &_aCLUTCache[i];
+    if ((pEntry->pPalEntries == pColor) && (pEntry->NumEntries == NumEntries) &&
+        (pEntry->Hash == Hash) && (pEntry->Trans == Trans)) {
+      pEntry->LastUse = _CLUT_UseCount;
+      if (pEntry == _pCLUTResident) {
+        _CLUT_NumAvoided++;
+        return pEntry->aColor;
+      }
+      break;
+    }
+    if (pEntry->LastUse < pLRU->LastUse) {
+      pLRU = pEntry;
+    }
+  }
+  if (i == DMA2D_CLUT_CACHE_ITEMS) {
+    //
+    // Convert the palette into the least recently used entry
+    //
+    pEntry = pLRU;
+    if (pEntry == _pCLUTResident) {
+      _pCLUTResident = NULL;
+    }
+    _InvertAlpha_SwapRB((U32 *)pColor, pEntry->aColor, NumEntries);
+    if (Trans) {
+      pEntry->aColor[0] &= 0x00FFFFFF;
+    }
+    pEntry->pPalEntries = pColor;
+    pEntry->NumEntries  = NumEntries;
+    pEntry->Hash        = Hash;
+    pEntry->Trans       = Trans;
+    pEntry->LastUse     = _CLUT_UseCount;
+  }
+  _DMA_LoadLUT(pEntry->aColor, NumEntries);
+  _pCLUTResident = pEntry;
+  _CLUT_NumLoads++;
+  return pEntry->aColor;
+}
+
 /*********************************************************************
 *
 *       _InvertAlpha
@@ -447,14 +793,9 @@ static void _DMA_AlphaBlendingBulk(LCD_COLOR * pColorFG, LCD_COLOR * pColorBG, L
   //
   DMA2D->NLR     = (U32)(NumItems << 16) | 1;       // Number of Line Register (Size configuration of area to be transfered)
   //
-  // Execute operation
+  // Execute operation and wait until it is done
   //
-  
-  DMA2D->CR     |= 1;  
-    
-  while (DMA2D->CR & DMA2D_CR_START) {
-    //__WFI();                                        // Sleep until next interrupt
-  }
+  _DMA_ExecOperation();
 }
 
 /*********************************************************************
@@ -499,17 +840,9 @@ static LCD_COLOR _DMA_MixColors(LCD_COLOR Color, LCD_COLOR BkColor, U8 Intens) {
   //
   DMA2D->NLR     = (U32)(1 << 16) | 1;              // Number of Line Register (Size configuration of area to be transfered)
   //
-  // Execute operation
-  //
-
-  //_DMA_ExecOperation();
-  DMA2D->CR     |= 1;                               // Control Register (Start operation)
-  //
-  // Wait until transfer is done
+  // Execute operation and wait until it is done
   //
-  while (DMA2D->CR & DMA2D_CR_START) {
-    __WFI();                                        // Sleep until next interrupt
-  }
+  _DMA_ExecOperation();
 
   return ColorDst ^ 0xFF000000;
 }
@@ -543,13 +876,9 @@ static void _DMA_ConvertColor(void * pSrc, void * pDst,  U32 PixelFormatSrc, U32
   //
   DMA2D->NLR     = (U32)(NumItems << 16) | 1;       // Number of Line Register (Size configuration of area to be transfered)
   //
-  // Execute operation
+  // Execute operation and wait until it is done
   //
-  DMA2D->CR     |= 1;  
-    
-  while (DMA2D->CR & DMA2D_CR_START) {
-    //__WFI();                                        // Sleep until next interrupt
-  }
+  _DMA_ExecOperation();
 }
 
 /*********************************************************************
@@ -595,17 +924,10 @@ static LCD_PIXELINDEX * _LCD_GetpPalConvTable(const LCD_LOGPALETTE GUI_UNI_PTR *
     return LCD_GetpPalConvTable(pLogPal);
   }
   //
-  // Convert palette colors from ARGB to ABGR
-  //
-  _InvertAlpha_SwapRB((U32 *)pLogPal->pPalEntries, _aBuffer_DMA2D, pLogPal->NumEntries);
-  //
-  // Load LUT using DMA2D
-  //
-  _DMA_LoadLUT(_aBuffer_DMA2D, pLogPal->NumEntries);
-  //
-  // Return something not NULL
+  // Convert palette colors from ARGB to ABGR and load the LUT using DMA2D,
+  // unless already done. Return something not NULL
   //
-  return _aBuffer_DMA2D;
+  return _DMA_LoadLUTCached(pLogPal, 0);
 }
 
 
@@ -639,32 +961,40 @@ static void _DMA_MixColorsBulk(LCD_COLOR * pColorFG, LCD_COLOR * pColorBG, LCD_C
   //
   DMA2D->NLR     = (U32)(NumItems << 16) | 1;              // Number of Line Register (Size configuration of area to be transfered)
   //
-  // Execute operation
+  // Execute operation and wait until it is done
   //
-  DMA2D->CR     |= 1;  
-    
-  while (DMA2D->CR & DMA2D_CR_START) {
-    //__WFI();                                        // Sleep until next interrupt
-  }
+  _DMA_ExecOperation();
 }
 /*********************************************************************
 *
 *       _DMA_AlphaBlending
 */
 static void _DMA_AlphaBlending(LCD_COLOR * pColorFG, LCD_COLOR * pColorBG, LCD_COLOR * pColorDst, U32 NumItems) {
+  U32 NumChunk;
+
   //
-  // Invert alpha values
-  //
-  _InvertAlpha(pColorFG, _aBuffer_FG, NumItems);
-  _InvertAlpha(pColorBG, _aBuffer_BG, NumItems);
-  //
-  // Use DMA2D for mixing
-  //
-  _DMA_AlphaBlendingBulk(_aBuffer_FG, _aBuffer_BG, _aBuffer_DMA2D, NumItems);
-  //
-  // Invert alpha values
+  // Blocks of DMA2D_BUFFER_ITEMS colors at most
   //
-  _InvertAlpha(_aBuffer_DMA2D, pColorDst, NumItems);
+  while (NumItems) {
+    NumChunk = (NumItems > DMA2D_BUFFER_ITEMS) ? DMA2D_BUFFER_ITEMS : NumItems;
+    //
+    // Invert alpha values
+    //
+    _InvertAlpha(pColorFG, _aBuffer_FG, NumChunk);
+    _InvertAlpha(pColorBG, _aBuffer_BG, NumChunk);
+    //
+    // Use DMA2D for mixing
+    //
+    _DMA_AlphaBlendingBulk(_aBuffer_FG, _aBuffer_BG, _aBuffer_DMA2D, NumChunk);
+    //
+    // Invert alpha values
+    //
+    _InvertAlpha(_aBuffer_DMA2D, pColorDst, NumChunk);
+    pColorFG  += NumChunk;
+    pColorBG  += NumChunk;
+    pColorDst += NumChunk;
+    NumItems  -= NumChunk;
+  }
 }
 
 /*********************************************************************
@@ -678,14 +1008,25 @@ static void _DMA_AlphaBlending(LCD_COLOR * pColorFG, LCD_COLOR * pColorBG, LCD_C
 *   transparent the color array needs to be converted after DMA2D has been used.
 */
 static void _DMA_Index2ColorBulk(void * pIndex, LCD_COLOR * pColor, U32 NumItems, U8 SizeOfIndex, U32 PixelFormat) {
+  U32 NumChunk;
+
   //
-  // Use DMA2D for the conversion
-  //
-  _DMA_ConvertColor(pIndex, _aBuffer_DMA2D, PixelFormat, LTDC_Pixelformat_ARGB8888, NumItems);
-  //
-  // Convert colors from ARGB to ABGR and invert alpha values
+  // Blocks of DMA2D_BUFFER_ITEMS colors at most
   //
-  _InvertAlpha_SwapRB(_aBuffer_DMA2D, pColor, NumItems);
+  while (NumItems) {
+    NumChunk = (NumItems > DMA2D_BUFFER_ITEMS) ? DMA2D_BUFFER_ITEMS : NumItems;
+    //
+    // Use DMA2D for the conversion
+    //
+    _DMA_ConvertColor(pIndex, _aBuffer_DMA2D, PixelFormat, LTDC_Pixelformat_ARGB8888, NumChunk);
+    //
+    // Convert colors from ARGB to ABGR and invert alpha values
+    //
+    _InvertAlpha_SwapRB(_aBuffer_DMA2D, pColor, NumChunk);
+    pIndex    = (U8 *)pIndex + NumChunk * SizeOfIndex;
+    pColor   += NumChunk;
+    NumItems -= NumChunk;
+  }
 }
 
 /*********************************************************************
@@ -699,14 +1040,25 @@ static void _DMA_Index2ColorBulk(void * pIndex, LCD_COLOR * pColor, U32 NumItems
 *   transparent the given color array needs to be converted before DMA2D can be used.
 */
 static void _DMA_Color2IndexBulk(LCD_COLOR * pColor, void * pIndex, U32 NumItems, U8 SizeOfIndex, U32 PixelFormat) {
+  U32 NumChunk;
+
   //
-  // Convert colors from ABGR to ARGB and invert alpha values
-  //
-  _InvertAlpha_SwapRB(pColor, _aBuffer_DMA2D, NumItems);
-  //
-  // Use DMA2D for the conversion
+  // Blocks of DMA2D_BUFFER_ITEMS colors at most
   //
-  _DMA_ConvertColor(_aBuffer_DMA2D, pIndex, LTDC_Pixelformat_ARGB8888, PixelFormat, NumItems);
+  while (NumItems) {
+    NumChunk = (NumItems > DMA2D_BUFFER_ITEMS) ? DMA2D_BUFFER_ITEMS : NumItems;
+    //
+    // Convert colors from ABGR to ARGB and invert alpha values
+    //
+    _InvertAlpha_SwapRB(pColor, _aBuffer_DMA2D, NumChunk);
+    //
+    // Use DMA2D for the conversion
+    //
+    _DMA_ConvertColor(_aBuffer_DMA2D, pIndex, LTDC_Pixelformat_ARGB8888, PixelFormat, NumChunk);
+    pColor   += NumChunk;
+    pIndex    = (U8 *)pIndex + NumChunk * SizeOfIndex;
+    NumItems -= NumChunk;
+  }
 }
 
 /*********************************************************************
@@ -715,23 +1067,30 @@ static void _DMA_Color2IndexBulk(LCD_COLOR * pColor, void * pIndex, U32 NumItems
 */
 static void _LCD_MixColorsBulk(U32 * pFG, U32 * pBG, U32 * pDst, unsigned OffFG, unsigned OffBG, unsigned OffDest, unsigned xSize, unsigned ySize, U8 Intens) {
   int y;
+  unsigned x, NumChunk;
 
   GUI_USE_PARA(OffFG);
   GUI_USE_PARA(OffDest);
   for (y = 0; y < ySize; y++) {
     //
-    // Invert alpha values
-    //
-    _InvertAlpha(pFG, _aBuffer_FG, xSize);
-    _InvertAlpha(pBG, _aBuffer_BG, xSize);
-    //
-    //
-    //
-    _DMA_MixColorsBulk(_aBuffer_FG, _aBuffer_BG, _aBuffer_DMA2D, Intens, xSize);
-    //
-    //
+    // Blocks of DMA2D_BUFFER_ITEMS colors at most
     //
-    _InvertAlpha(_aBuffer_DMA2D, pDst, xSize);
+    for (x = 0; x < xSize; x += NumChunk) {
+      NumChunk = ((xSize - x) > DMA2D_BUFFER_ITEMS) ? DMA2D_BUFFER_ITEMS : (xSize - x);
+      //
+      // Invert alpha values
+      //
+      _InvertAlpha(pFG + x, _aBuffer_FG, NumChunk);
+      _InvertAlpha(pBG + x, _aBuffer_BG, NumChunk);
+      //
+      //
+      //
+      _DMA_MixColorsBulk(_aBuffer_FG, _aBuffer_BG, _aBuffer_DMA2D, Intens, NumChunk);
+      //
+      //
+      //
+      _InvertAlpha(_aBuffer_DMA2D, pDst + x, NumChunk);
+    }
     pFG  += xSize + OffFG;
     pBG  += xSize + OffBG;
     pDst += xSize + OffDest;
@@ -771,10 +1130,30 @@ static void _LTDC_LayerEnableLUT(LTDC_Layer_TypeDef * LTDC_Layerx, int NewState)
 */
 static void _LTDC_SetLayerPos(int LayerIndex, int xPos, int yPos) {
   int xSize, ySize;
+#if LCD_LANDSCAPE
+  int Temp;
+#endif
   U32 HorizontalStart, HorizontalStop, VerticalStart, VerticalStop;
 
   xSize = LCD_GetXSizeEx(LayerIndex);
   ySize = LCD_GetYSizeEx(LayerIndex);
+  if (_aWindowState[LayerIndex] == WINDOW_SHRUNK) {
+    xPos  += _aWindow[LayerIndex].x0;
+    yPos  += _aWindow[LayerIndex].y0;
+    xSize  = _aWindow[LayerIndex].x1 - _aWindow[LayerIndex].x0 + 1;
+    ySize  = _aWindow[LayerIndex].y1 - _aWindow[LayerIndex].y0 + 1;
+  }
+#if LCD_LANDSCAPE
+  //
+  // Window of the rotated layer on the portrait panel
+  //
+  Temp  = xPos;
+  xPos  = yPos;
+  yPos  = YSIZE_PHYS - Temp - xSize;
+  Temp  = xSize;
+  xSize = ySize;
+  ySize = Temp;
+#endif
   HorizontalStart = xPos + HBP + 1;
   HorizontalStop  = xPos + HBP + xSize;
   VerticalStart   = yPos + VBP + 1;
@@ -795,6 +1174,102 @@ static void _LTDC_SetLayerPos(int LayerIndex, int xPos, int yPos) {
   LTDC_ReloadConfig(LTDC_SRCR_VBR); // Reload on next blanking period
 }
 
+/*********************************************************************
+*
+*       _LTDC_SetLayerWindow
+*
+* Purpose:
+*   Sets the part of the visible buffer read by the LTDC: the window of a
+*   shrunk layer or the complete layer. Reload on next blanking period.
+*/
+static void _LTDC_SetLayerWindow(int LayerIndex) {
+  int xPos, yPos, x0, y0, x1, y1, BytesPerLine;
+
+  x0 = 0;
+  y0 = 0;
+  x1 = _axSize[LayerIndex] - 1;
+  y1 = _aySize[LayerIndex] - 1;
+  if (_aWindowState[LayerIndex] == WINDOW_SHRUNK) {
+    x0 = _aWindow[LayerIndex].x0;
+    y0 = _aWindow[LayerIndex].y0;
+    x1 = _aWindow[LayerIndex].x1;
+    y1 = _aWindow[LayerIndex].y1;
+  }
+  BytesPerLine = _GetBytesPerLine(LayerIndex, _axSize[LayerIndex]);
+  GUI_GetLayerPosEx(LayerIndex, &xPos, &yPos);
+  //
+  // The line interrupt must not switch the buffer in between
+  //
+  NVIC_DisableIRQ(LTDC_IRQn);
+  _aWindowOffset[LayerIndex]   = y0 * BytesPerLine + x0 * _aBytesPerPixels[LayerIndex];
+  _apLayer[LayerIndex]->CFBLR  = (BytesPerLine << 16) | ((x1 - x0 + 1) * _aBytesPerPixels[LayerIndex] + 3);
+  _apLayer[LayerIndex]->CFBLNR = y1 - y0 + 1;
+  _apLayer[LayerIndex]->CFBAR  = _aAddr[LayerIndex] + _GetBufferSize(LayerIndex) * _aVisibleBuffer[LayerIndex] + _aWindowOffset[LayerIndex];
+  LTDC_LayerCmd(_apLayer[LayerIndex], (_aWindowState[LayerIndex] == WINDOW_OFF) ? DISABLE : ENABLE);
+  _LTDC_SetLayerPos(LayerIndex, xPos, yPos);
+  NVIC_EnableIRQ(LTDC_IRQn);
+}
+
+/*********************************************************************
+*
+*       _GetContentRect
+*
+* Purpose:
+*   Returns in pRect the bounding box of the pixels of the visible buffer
+*   which are not fully transparent. Layers without alpha are returned
+*   complete.
+*   Returns 0 if all pixels are transparent.
+*/
+static int _GetContentRect(int LayerIndex, GUI_RECT * pRect) {
+  U32 Addr, Mask, PixelFormat;
+  int xSize, ySize, Bpp, x, y;
+
+  xSize = _axSize[LayerIndex];
+  ySize = _aySize[LayerIndex];
+  pRect->x0 = 0;
+  pRect->y0 = 0;
+  pRect->x1 = xSize - 1;
+  pRect->y1 = ySize - 1;
+  PixelFormat = _GetPixelformat(LayerIndex);
+  if        (PixelFormat == LTDC_Pixelformat_ARGB8888) {
+    Mask = 0xFF000000;
+  } else if (PixelFormat == LTDC_Pixelformat_ARGB1555) {
+    Mask = 0x8000;
+  } else if (PixelFormat == LTDC_Pixelformat_ARGB4444) {
+    Mask = 0xF000;
+  } else {
+    return 1;
+  }
+  #define _IS_OPAQUE(x) (((Bpp == 4) ? *((U32 *)Addr + (x)) : *((U16 *)Addr + (x))) & Mask)
+  Bpp  = _aBytesPerPixels[LayerIndex];
+  Addr = _aAddr[LayerIndex] + _GetBufferSize(LayerIndex) * _aVisibleBuffer[LayerIndex];
+  pRect->x0 = xSize;
+  pRect->y0 = -1;
+  pRect->x1 = -1;
+  for (y = 0; y < ySize; y++, Addr += xSize * Bpp) {
+    for (x = 0; (x < xSize) && !_IS_OPAQUE(x); x++);
+    if (x == xSize) {
+      continue;
+    }
+    if (x < pRect->x0) {
+      pRect->x0 = x;
+    }
+    //
+    // Right end: only the part right of the current box remains to check
+    //
+    for (x = xSize - 1; (x > pRect->x1) && !_IS_OPAQUE(x); x--);
+    if (x > pRect->x1) {
+      pRect->x1 = x;
+    }
+    if (pRect->y0 < 0) {
+      pRect->y0 = y;
+    }
+    pRect->y1 = y;
+  }
+  #undef _IS_OPAQUE
+  return (pRect->y0 >= 0) ? 1 : 0;
+}
+
 /*********************************************************************
 *
 *       _LTDC_SetLayerAlpha
@@ -845,13 +1320,10 @@ static void _DMA_Copy(int LayerIndex, void * pSrc, void * pDst, int xSize, int y
   DMA2D->OOR     = OffLineDst;                      // Output Offset Register (Destination line offset)
   DMA2D->FGPFCCR = PixelFormat;                     // Foreground PFC Control Register (Defines the input pixel format)
   DMA2D->NLR     = (U32)(xSize << 16) | (U16)ySize; // Number of Line Register (Size configuration of area to be transfered)
-  DMA2D->CR     |= 1;                               // Start operation
   //
-  // Wait until transfer is done
+  // Execute operation and wait until it is done
   //
-  while (DMA2D->CR & DMA2D_CR_START) {
-    //__WFI();                                        // Sleep until next interrupt
-  }
+  _DMA_ExecOperation();
 }
 
 /*********************************************************************
@@ -868,13 +1340,10 @@ static void _DMA_Fill(int LayerIndex, void * pDst, int xSize, int ySize, int Off
   DMA2D->OOR     = OffLine;                         // Destination line offset
   DMA2D->OPFCCR  = PixelFormat;                     // Defines the number of pixels to be transfered
   DMA2D->NLR     = (U32)(xSize << 16) | (U16)ySize; // Size configuration of area to be transfered
-  DMA2D->CR     |= 1;                               // Start operation
   //
-  // Wait until transfer is done
+  // Execute operation and wait until it is done
   //
-  while (DMA2D->CR & DMA2D_CR_START) {
-    //__WFI();                                        // Sleep until next interrupt
-  }
+  _DMA_ExecOperation();
 }
 
 /*********************************************************************
@@ -904,8 +1373,12 @@ static void _LCD_InitController(int LayerIndex) {
 
     LCD_Init();
     //
-    // Enable line interrupt
+    // Enable line interrupt on the first line of the vertical front porch:
+    // the buffer switch of LTDC_ISR_Handler() then happens during the whole
+    // vertical blanking period (front porch, sync and back porch) instead of
+    // the few lines left after line 0.
     //
+    LTDC_LIPConfig(VBP + YSIZE_PHYS + 1);
     LTDC_ITConfig(LTDC_IER_LIE, ENABLE);
     NVIC_SetPriority(LTDC_IRQn, 0);
     NVIC_EnableIRQ(LTDC_IRQn);
@@ -919,12 +1392,24 @@ static void _LCD_InitController(int LayerIndex) {
     // Clear transfer complete interrupt flag
     //
     DMA2D->IFCR = (U32)DMA2D_IFSR_CTCIF;
+    //
+    // Enable the cycle counter used by LCD_X_DMA2D_GetStats()
+    //
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
   }
   //
   // Layer configuration
   //
   xSize = LCD_GetXSizeEx(LayerIndex);
   ySize = LCD_GetYSizeEx(LayerIndex);
+#if LCD_LANDSCAPE
+  //
+  // The LTDC reads the scanout buffers, rotated by 90 degrees
+  //
+  xSize = LCD_GetYSizeEx(LayerIndex);
+  ySize = LCD_GetXSizeEx(LayerIndex);
+#endif
 
   LTDC_Layer_InitStruct.LTDC_HorizontalStart = HBP + 1;
   LTDC_Layer_InitStruct.LTDC_HorizontalStop  = (xSize + HBP);
@@ -958,7 +1443,11 @@ static void _LCD_InitController(int LayerIndex) {
   //
   // Input Address configuration
   //
+#if LCD_LANDSCAPE
+  LTDC_Layer_InitStruct.LTDC_CFBStartAdress = _aScanAddr[LayerIndex];
+#else
   LTDC_Layer_InitStruct.LTDC_CFBStartAdress = _aAddr[LayerIndex];
+#endif
   LTDC_LayerInit(_apLayer[LayerIndex], &LTDC_Layer_InitStruct);
   //
   // Enable LUT on demand
@@ -991,17 +1480,6 @@ static void _LCD_InitController(int LayerIndex) {
   LTDC_ReloadConfig(LTDC_SRCR_IMR);
 }
 
-/*********************************************************************
-*
-*       _GetBufferSize
-*/
-static U32 _GetBufferSize(int LayerIndex) {
-  U32 BufferSize;
-
-  BufferSize = _axSize[LayerIndex] * _aySize[LayerIndex] * _aBytesPerPixels[LayerIndex];
-  return BufferSize;
-}
-
 /*********************************************************************
 *
 *       _DMA_DrawBitmapL8
@@ -1031,15 +1509,9 @@ static void _DMA_DrawBitmapL8(void * pSrc, void * pDst,  U32 OffSrc, U32 OffDst,
   //
   DMA2D->NLR     = (U32)(xSize << 16) | ySize;      // Number of Line Register (Size configuration of area to be transfered)
   //
-  // Execute operation
-  //
-  DMA2D->CR     |= 1;                               // Start operation
-  //
-  // Wait until transfer is done
+  // Execute operation and wait until it is done
   //
-  while (DMA2D->CR & DMA2D_CR_START) {
-    //__WFI();                                        // Sleep until next interrupt
-  }
+  _DMA_ExecOperation();
 }
 /*********************************************************************
 *
@@ -1052,6 +1524,11 @@ static void _LCD_CopyBuffer(int LayerIndex, int IndexSrc, int IndexDst) {
   AddrSrc    = _aAddr[LayerIndex] + BufferSize * IndexSrc;
   AddrDst    = _aAddr[LayerIndex] + BufferSize * IndexDst;
   _DMA_Copy(LayerIndex, (void *)AddrSrc, (void *)AddrDst, _axSize[LayerIndex], _aySize[LayerIndex], 0, 0);
+  //
+  // emWin copies the visible buffer into the next one before drawing
+  // it (GUI_MULTIBUF_Begin): the drawing routines now target IndexDst
+  //
+  _aBufferIndex[LayerIndex] = IndexDst;
 }
 
 /*********************************************************************
@@ -1065,6 +1542,7 @@ static void _LCD_CopyRect(int LayerIndex, int x0, int y0, int x1, int y1, int xS
   AddrSrc = _aAddr[LayerIndex] + BufferSize * _aBufferIndex[LayerIndex] + (y0 * _axSize[LayerIndex] + x0) * _aBytesPerPixels[LayerIndex];
   AddrDst = _aAddr[LayerIndex] + BufferSize * _aBufferIndex[LayerIndex] + (y1 * _axSize[LayerIndex] + x1) * _aBytesPerPixels[LayerIndex];
   _DMA_Copy(LayerIndex, (void *)AddrSrc, (void *)AddrDst, xSize, ySize, _axSize[LayerIndex] - xSize, 0);
+  _MarkDirty(LayerIndex, x1, y1, x1 + xSize - 1, y1 + ySize - 1);
 }
 
 /*********************************************************************
@@ -1098,7 +1576,7 @@ static void _LCD_DrawBitmap16bpp(int LayerIndex, int x, int y, U16 const * p, in
 
   BufferSize = _GetBufferSize(LayerIndex);
   AddrDst = _aAddr[LayerIndex] + BufferSize * _aBufferIndex[LayerIndex] + (y * _axSize[LayerIndex] + x) * _aBytesPerPixels[LayerIndex];
-  OffLineSrc = 240/*(BytesPerLine / 2)*/ - xSize;
+  OffLineSrc = (BytesPerLine / 2) - xSize;
   OffLineDst = _axSize[LayerIndex] - xSize;
   _DMA_Copy(LayerIndex, (void *)p, (void *)AddrDst, xSize, ySize, OffLineSrc, OffLineDst);
 }
@@ -1120,6 +1598,430 @@ static void _LCD_DrawBitmap8bpp(int LayerIndex, int x, int y, U8 const * p, int
   PixelFormat = _GetPixelformat(LayerIndex);
   _DMA_DrawBitmapL8((void *)p, (void *)AddrDst, OffLineSrc, OffLineDst, PixelFormat, xSize, ySize);
 }
+
+/*********************************************************************
+*
+*       _DMA_DrawBitmap
+*
+* Purpose:
+*   Converts (Blend = 0) or blends (Blend = 1) a bitmap of any DMA2D input
+*   format into the frame buffer. ColorFG is the RGB888 color of the A4
+*   and A8 formats.
+*/
+static void _DMA_DrawBitmap(void * pSrc, void * pDst, U32 OffSrc, U32 OffDst, U32 PixelFormatSrc, U32 PixelFormatDst, U32 ColorFG, U32 xSize, U32 ySize, int Blend) {
+  //
+  // Set up mode
+  //
+  DMA2D->CR      = (Blend ? 0x00020000UL : 0x00010000UL) | (1 << 9); // Memory to memory with blending or pixel format conversion and TCIE
+  //
+  // Set up pointers, the frame buffer is the background and the output
+  //
+  DMA2D->FGMAR   = (U32)pSrc;                       // Foreground Memory Address Register (Source address)
+  DMA2D->BGMAR   = (U32)pDst;                       // Background Memory Address Register (Destination address)
+  DMA2D->OMAR    = (U32)pDst;                       // Output Memory Address Register (Destination address)
+  //
+  // Set up offsets
+  //
+  DMA2D->FGOR    = OffSrc;                          // Foreground Offset Register (Source line offset)
+  DMA2D->BGOR    = OffDst;                          // Background Offset Register (Destination line offset)
+  DMA2D->OOR     = OffDst;                          // Output Offset Register (Destination line offset)
+  //
+  // Set up pixel format and color
+  //
+  DMA2D->FGPFCCR = PixelFormatSrc;                  // Foreground PFC Control Register (Defines the input pixel format)
+  DMA2D->FGCOLR  = ColorFG;                         // Foreground Color Register (Color of A4 and A8 pixels)
+  DMA2D->BGPFCCR = PixelFormatDst;                  // Background PFC Control Register (Defines the background pixel format)
+  DMA2D->OPFCCR  = PixelFormatDst;                  // Output PFC Control Register (Defines the output pixel format)
+  //
+  // Set up size
+  //
+  DMA2D->NLR     = (U32)(xSize << 16) | ySize;      // Number of Line Register (Size configuration of area to be transfered)
+  //
+  // Execute operation and wait until it is done
+  //
+  _DMA_ExecOperation();
+}
+
+/*********************************************************************
+*
+*       _GetPixelDMA2D
+*
+* Purpose:
+*   Returns the emWin color of a pixel of a DMA2D format bitmap and its
+*   opacity (0: transparent, 255: opaque) in *pAlpha.
+*/
+static LCD_COLOR _GetPixelDMA2D(const U8 * pData, int BytesPerLine, int x, int y, U32 PixelFormat, const LCD_LOGPALETTE * pLogPal, LCD_COLOR Color, int * pAlpha) {
+  const U8 * p;
+  U32 Data;
+  U32 Index;
+
+  switch (PixelFormat) {
+  case CM_A8:
+    *pAlpha = *(pData + y * BytesPerLine + x);
+    return Color;
+  case CM_A4:
+  case CM_L4:
+    //
+    // DMA2D order: the first pixel of a byte is in its low nibble
+    //
+    Index = (*(pData + y * BytesPerLine + (x >> 1)) >> ((x & 1) << 2)) & 0xF;
+    if (PixelFormat == CM_A4) {
+      *pAlpha = Index * 17;
+      return Color;
+    }
+    *pAlpha = ((Index == 0) && pLogPal->HasTrans) ? 0 : 255;
+    return pLogPal->pPalEntries[Index];
+  default: // CM_ARGB4444
+    p    = pData + y * BytesPerLine + (x << 1);
+    Data = *p | (*(p + 1) << 8);
+    *pAlpha = (Data >> 12) * 17;
+    return (((Data >> 8) & 0xF) * 0x000011)         // Red
+         | (((Data >> 4) & 0xF) * 0x001100)         // Green
+         | (( Data       & 0xF) * 0x110000);        // Blue
+  }
+}
+
+/*********************************************************************
+*
+*       _DrawBitmapDMA2D
+*
+* Purpose:
+*   Draws a bitmap of a DMA2D input format, clipped to the current clip
+*   rectangle. The DMA2D is used when drawing into a layer of a DMA2D
+*   output format without magnification. Memory devices, magnified
+*   bitmaps and 4 bpp areas not starting and ending on a byte are drawn
+*   pixel by pixel.
+*/
+static void _DrawBitmapDMA2D(int x0, int y0, int xSize, int ySize, const U8 * pData, const LCD_LOGPALETTE * pLogPal, int xMag, int yMag, U32 PixelFormat) {
+  const U8 * pSrc;
+  LCD_COLOR  Color;
+  LCD_COLOR  ColorBk;
+  U32        PixelFormatDst, BufferSize, AddrDst, ColorFG;
+  int        LayerIndex, BitsPerPixel, BytesPerLine;
+  int        x, y, x1, y1, xs, ys, xOff, yOff, Alpha;
+  int        Blend;
+
+  LayerIndex   = GUI_pContext->SelLayer;
+  BitsPerPixel = ((PixelFormat == CM_A4) || (PixelFormat == CM_L4)) ? 4 : (PixelFormat == CM_A8) ? 8 : 16;
+  BytesPerLine = (xSize * BitsPerPixel + 7) >> 3;
+  //
+  // Clip the magnified area
+  //
+  x1 = x0 + xSize * xMag - 1;
+  y1 = y0 + ySize * yMag - 1;
+  xs = (x0 < GUI_pContext->ClipRect.x0) ? GUI_pContext->ClipRect.x0 : x0;
+  ys = (y0 < GUI_pContext->ClipRect.y0) ? GUI_pContext->ClipRect.y0 : y0;
+  if (x1 > GUI_pContext->ClipRect.x1) {
+    x1 = GUI_pContext->ClipRect.x1;
+  }
+  if (y1 > GUI_pContext->ClipRect.y1) {
+    y1 = GUI_pContext->ClipRect.y1;
+  }
+  if ((xs > x1) || (ys > y1)) {
+    return;
+  }
+  xOff = xs - x0;
+  yOff = ys - y0;
+  Color = GUI_pContext->Color;
+  PixelFormatDst = _GetPixelformat(LayerIndex);
+  //
+  // Above the driver only the landscape modifier may be linked, a memory
+  // device is of a higher class
+  //
+  if ((xMag == 1) && (yMag == 1) && (LayerIndex < GUI_COUNTOF(_apLayer)) &&
+      (GUI__apDevice[LayerIndex]->pDeviceAPI->DeviceClassIndex <= DEVICE_CLASS_DRIVER_MODIFIER) &&
+      (PixelFormatDst <= LTDC_Pixelformat_ARGB4444) &&
+      ((BitsPerPixel != 4) || (((xOff | (x1 - xs + 1)) & 1) == 0))) {
+    pSrc       = pData + yOff * BytesPerLine + ((xOff * BitsPerPixel) >> 3);
+    BufferSize = _GetBufferSize(LayerIndex);
+    AddrDst    = _aAddr[LayerIndex] + BufferSize * _aBufferIndex[LayerIndex] + (ys * _axSize[LayerIndex] + xs) * _aBytesPerPixels[LayerIndex];
+    ColorFG    = ((Color & 0xFF) << 16) | (Color & 0xFF00) | ((Color >> 16) & 0xFF);
+    Blend      = 1;
+    if (PixelFormat == CM_L4) {
+      //
+      // Load the palette into the CLUT, the transparent index gets alpha 0
+      //
+      Blend = pLogPal->HasTrans ? 1 : 0;
+      _DMA_LoadLUTCached(pLogPal, Blend);
+    }
+    _DMA_DrawBitmap((void *)pSrc, (void *)AddrDst, (BytesPerLine * 8) / BitsPerPixel - (x1 - xs + 1), _axSize[LayerIndex] - (x1 - xs + 1),
+                    PixelFormat, PixelFormatDst, ColorFG, x1 - xs + 1, y1 - ys + 1, Blend);
+    _MarkDirty(LayerIndex, xs, ys, x1, y1);
+    return;
+  }
+  //
+  // Pixel by pixel
+  //
+  for (y = ys; y <= y1; y++) {
+    for (x = xs; x <= x1; x++) {
+      Color = _GetPixelDMA2D(pData, BytesPerLine, (x - x0) / xMag, (y - y0) / yMag, PixelFormat, pLogPal, GUI_pContext->Color, &Alpha);
+      if (Alpha == 0) {
+        continue;
+      }
+      if (Alpha < 255) {
+        ColorBk = LCD_Index2Color(LCD_GetPixelIndex(x, y));
+        Color   = LCD_MixColors256(Color, ColorBk, Alpha);
+      }
+      LCD_SetPixelIndex(x, y, LCD_Color2Index(Color));
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _DrawBitmapA4, _DrawBitmapA8, _DrawBitmapL4, _DrawBitmapARGB4444
+*/
+static void _DrawBitmapA4(int x0, int y0, int xSize, int ySize, const U8 GUI_UNI_PTR * pPixel, const LCD_LOGPALETTE GUI_UNI_PTR * pLogPal, int xMag, int yMag) {
+  _DrawBitmapDMA2D(x0, y0, xSize, ySize, pPixel, pLogPal, xMag, yMag, CM_A4);
+}
+
+static void _DrawBitmapA8(int x0, int y0, int xSize, int ySize, const U8 GUI_UNI_PTR * pPixel, const LCD_LOGPALETTE GUI_UNI_PTR * pLogPal, int xMag, int yMag) {
+  _DrawBitmapDMA2D(x0, y0, xSize, ySize, pPixel, pLogPal, xMag, yMag, CM_A8);
+}
+
+static void _DrawBitmapL4(int x0, int y0, int xSize, int ySize, const U8 GUI_UNI_PTR * pPixel, const LCD_LOGPALETTE GUI_UNI_PTR * pLogPal, int xMag, int yMag) {
+  _DrawBitmapDMA2D(x0, y0, xSize, ySize, pPixel, pLogPal, xMag, yMag, CM_L4);
+}
+
+static void _DrawBitmapARGB4444(int x0, int y0, int xSize, int ySize, const U8 GUI_UNI_PTR * pPixel, const LCD_LOGPALETTE GUI_UNI_PTR * pLogPal, int xMag, int yMag) {
+  _DrawBitmapDMA2D(x0, y0, xSize, ySize, pPixel, pLogPal, xMag, yMag, CM_ARGB4444);
+}
+
+#if LCD_LANDSCAPE
+/*********************************************************************
+*
+*       _TransposeTile16, _TransposeTile32
+*
+* Purpose:
+*   Rotate one tile of the render buffer into the scanout buffer. The
+*   Cortex-M4 has no data cache: the tile is read line by line into
+*   internal RAM and written line by line from there, the SDRAM is only
+*   accessed sequentially, in words, within a few open rows. pDst points
+*   to the scanout line of the first tile column, the next columns are in
+*   the lines above.
+*/
+static void _TransposeTile16(const U16 * pSrc, U16 * pDst, int SrcPitch, int DstPitch) {
+  U16 aTile[LANDSCAPE_TILE_SIZE][LANDSCAPE_TILE_SIZE];
+  const U32 * pSrcLine;
+  U32       * pDstLine;
+  U32         Data;
+  int         i, j;
+
+  for (i = 0; i < LANDSCAPE_TILE_SIZE; i++) {
+    pSrcLine = (const U32 *)(pSrc + i * SrcPitch);
+    for (j = 0; j < LANDSCAPE_TILE_SIZE; j += 2) {
+      Data            = *pSrcLine++;
+      aTile[j][i]     = (U16)Data;
+      aTile[j + 1][i] = (U16)(Data >> 16);
+    }
+  }
+  for (j = 0; j < LANDSCAPE_TILE_SIZE; j++) {
+    pDstLine = (U32 *)(pDst - j * DstPitch);
+    for (i = 0; i < LANDSCAPE_TILE_SIZE; i += 2) {
+      *pDstLine++ = aTile[j][i] | ((U32)aTile[j][i + 1] << 16);
+    }
+  }
+}
+
+static void _TransposeTile32(const U32 * pSrc, U32 * pDst, int SrcPitch, int DstPitch) {
+  U32 aTile[LANDSCAPE_TILE_SIZE][LANDSCAPE_TILE_SIZE];
+  int i, j;
+
+  for (i = 0; i < LANDSCAPE_TILE_SIZE; i++) {
+    for (j = 0; j < LANDSCAPE_TILE_SIZE; j++) {
+      aTile[j][i] = pSrc[i * SrcPitch + j];
+    }
+  }
+  for (j = 0; j < LANDSCAPE_TILE_SIZE; j++) {
+    for (i = 0; i < LANDSCAPE_TILE_SIZE; i++) {
+      pDst[i - j * DstPitch] = aTile[j][i];
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       _Landscape_Rotate
+*
+* Purpose:
+*   Rotates pRect of a render buffer into a scanout buffer, extended to
+*   whole tiles. The landscape pixel (x, y) is shown at (y, xSize - 1 - x)
+*   of the portrait panel.
+*/
+static void _Landscape_Rotate(int LayerIndex, int BufferIndex, int ScanIndex, const GUI_RECT * pRect) {
+  U32 Start, AddrSrc, AddrDst;
+  int x0, y0, x1, y1, x, y, xSize, DstPitch;
+
+  Start = DWT->CYCCNT;
+  xSize = _axSize[LayerIndex];
+  x0 = (pRect->x0 < 0) ? 0 : pRect->x0 & ~(LANDSCAPE_TILE_SIZE - 1);
+  y0 = (pRect->y0 < 0) ? 0 : pRect->y0 & ~(LANDSCAPE_TILE_SIZE - 1);
+  x1 = (pRect->x1 >= xSize)               ? xSize - 1               : pRect->x1 | (LANDSCAPE_TILE_SIZE - 1);
+  y1 = (pRect->y1 >= _aySize[LayerIndex]) ? _aySize[LayerIndex] - 1 : pRect->y1 | (LANDSCAPE_TILE_SIZE - 1);
+  DstPitch = _aScanPitch[LayerIndex];
+  AddrSrc  = _aAddr[LayerIndex] + _GetBufferSize(LayerIndex) * BufferIndex;
+  AddrDst  = _aScanAddr[LayerIndex] + _aScanNumBytes[LayerIndex] / _aNumScanBuffers[LayerIndex] * ScanIndex;
+  for (y = y0; y <= y1; y += LANDSCAPE_TILE_SIZE) {
+    for (x = x0; x <= x1; x += LANDSCAPE_TILE_SIZE) {
+      if (_aBytesPerPixels[LayerIndex] == 4) {
+        _TransposeTile32((const U32 *)AddrSrc + y * xSize + x, (U32 *)AddrDst + (xSize - 1 - x) * DstPitch + y, xSize, DstPitch);
+      } else {
+        _TransposeTile16((const U16 *)AddrSrc + y * xSize + x, (U16 *)AddrDst + (xSize - 1 - x) * DstPitch + y, xSize, DstPitch);
+      }
+    }
+  }
+  _LANDSCAPE_NumRotations++;
+  _LANDSCAPE_NumPixels += (x1 - x0 + 1) * (y1 - y0 + 1);
+  _LANDSCAPE_Cycles    += DWT->CYCCNT - Start;
+}
+
+/*********************************************************************
+*
+*       _Landscape_Show
+*
+* Purpose:
+*   Brings the areas drawn into the render buffer BufferIndex up to date
+*   in a scanout buffer neither scanned nor waiting to be, and has
+*   LTDC_ISR_Handler() show it on the next vertical blanking period. With
+*   two scanout buffers the previous switch has to take place first.
+*/
+static void _Landscape_Show(int LayerIndex, int BufferIndex) {
+  GUI_RECT Rect;
+  int      ScanIndex, NumScanBuffers, i;
+
+  NumScanBuffers = _aNumScanBuffers[LayerIndex];
+  do {
+    for (ScanIndex = 0; ScanIndex < NumScanBuffers; ScanIndex++) {
+      if ((ScanIndex != _aPendingScan[LayerIndex]) && (ScanIndex != _aVisibleScan[LayerIndex])) {
+        break;
+      }
+    }
+  } while (ScanIndex == NumScanBuffers);
+  //
+  // The scanout buffer misses what was drawn since it was last written,
+  // the other ones miss the new areas too
+  //
+  Rect = _aStale[LayerIndex][ScanIndex];
+  _MergeRect(&Rect, _aDirty[LayerIndex].x0, _aDirty[LayerIndex].y0, _aDirty[LayerIndex].x1, _aDirty[LayerIndex].y1);
+  for (i = 0; i < NumScanBuffers; i++) {
+    if (i != ScanIndex) {
+      _MergeRect(&_aStale[LayerIndex][i], _aDirty[LayerIndex].x0, _aDirty[LayerIndex].y0, _aDirty[LayerIndex].x1, _aDirty[LayerIndex].y1);
+    }
+  }
+  _ClearRect(&_aStale[LayerIndex][ScanIndex]);
+  _ClearRect(&_aDirty[LayerIndex]);
+  if ((Rect.x0 <= Rect.x1) && (Rect.y0 <= Rect.y1)) {
+    _Landscape_Rotate(LayerIndex, BufferIndex, ScanIndex, &Rect);
+  }
+  _aPendingScan[LayerIndex] = ScanIndex;
+}
+
+/*********************************************************************
+*
+*       Landscape modifier device
+*
+*   Linked above the driver of each layer, it records the drawn areas and
+*   passes the operations on. The DMA2D drawing routines record their
+*   areas themselves.
+*/
+static void _Landscape_DrawBitmap(GUI_DEVICE * pDevice, int x0, int y0, int xSize, int ySize, int BitsPerPixel, int BytesPerLine, const U8 GUI_UNI_PTR * pData, int Diff, const LCD_PIXELINDEX * pTrans) {
+  _MarkDirty(pDevice->LayerIndex, x0, y0, x0 + xSize - 1, y0 + ySize - 1);
+  pDevice = pDevice->pNext;
+  pDevice->pDeviceAPI->pfDrawBitmap(pDevice, x0, y0, xSize, ySize, BitsPerPixel, BytesPerLine, pData, Diff, pTrans);
+}
+
+static void _Landscape_DrawHLine(GUI_DEVICE * pDevice, int x0, int y, int x1) {
+  _MarkDirty(pDevice->LayerIndex, x0, y, x1, y);
+  pDevice = pDevice->pNext;
+  pDevice->pDeviceAPI->pfDrawHLine(pDevice, x0, y, x1);
+}
+
+static void _Landscape_DrawVLine(GUI_DEVICE * pDevice, int x, int y0, int y1) {
+  _MarkDirty(pDevice->LayerIndex, x, y0, x, y1);
+  pDevice = pDevice->pNext;
+  pDevice->pDeviceAPI->pfDrawVLine(pDevice, x, y0, y1);
+}
+
+static void _Landscape_FillRect(GUI_DEVICE * pDevice, int x0, int y0, int x1, int y1) {
+  _MarkDirty(pDevice->LayerIndex, x0, y0, x1, y1);
+  pDevice = pDevice->pNext;
+  pDevice->pDeviceAPI->pfFillRect(pDevice, x0, y0, x1, y1);
+}
+
+static unsigned _Landscape_GetPixelIndex(GUI_DEVICE * pDevice, int x, int y) {
+  pDevice = pDevice->pNext;
+  return pDevice->pDeviceAPI->pfGetPixelIndex(pDevice, x, y);
+}
+
+static void _Landscape_SetPixelIndex(GUI_DEVICE * pDevice, int x, int y, int ColorIndex) {
+  _MarkDirty(pDevice->LayerIndex, x, y, x, y);
+  pDevice = pDevice->pNext;
+  pDevice->pDeviceAPI->pfSetPixelIndex(pDevice, x, y, ColorIndex);
+}
+
+static void _Landscape_XorPixel(GUI_DEVICE * pDevice, int x, int y) {
+  _MarkDirty(pDevice->LayerIndex, x, y, x, y);
+  pDevice = pDevice->pNext;
+  pDevice->pDeviceAPI->pfXorPixel(pDevice, x, y);
+}
+
+static void _Landscape_SetOrg(GUI_DEVICE * pDevice, int x, int y) {
+  pDevice = pDevice->pNext;
+  pDevice->pDeviceAPI->pfSetOrg(pDevice, x, y);
+}
+
+static void (* _Landscape_GetDevFunc(GUI_DEVICE ** ppDevice, int Index))(void) {
+  *ppDevice = (*ppDevice)->pNext;
+  return (*ppDevice)->pDeviceAPI->pfGetDevFunc(ppDevice, Index);
+}
+
+static I32 _Landscape_GetDevProp(GUI_DEVICE * pDevice, int Index) {
+  pDevice = pDevice->pNext;
+  return pDevice->pDeviceAPI->pfGetDevProp(pDevice, Index);
+}
+
+static void * _Landscape_GetDevData(GUI_DEVICE * pDevice, int Index) {
+  pDevice = pDevice->pNext;
+  return pDevice->pDeviceAPI->pfGetDevData(pDevice, Index);
+}
+
+static void _Landscape_GetRect(GUI_DEVICE * pDevice, LCD_RECT * pRect) {
+  pDevice = pDevice->pNext;
+  pDevice->pDeviceAPI->pfGetRect(pDevice, pRect);
+}
+
+static const GUI_DEVICE_API _Landscape_DeviceAPI = {
+  DEVICE_CLASS_DRIVER_MODIFIER,
+  _Landscape_DrawBitmap,
+  _Landscape_DrawHLine,
+  _Landscape_DrawVLine,
+  _Landscape_FillRect,
+  _Landscape_GetPixelIndex,
+  _Landscape_SetPixelIndex,
+  _Landscape_XorPixel,
+  _Landscape_SetOrg,
+  _Landscape_GetDevFunc,
+  _Landscape_GetDevProp,
+  _Landscape_GetDevData,
+  _Landscape_GetRect,
+};
+#endif
+
+/*********************************************************************
+*
+*       Public data
+*
+**********************************************************************
+*/
+/*********************************************************************
+*
+*       Bitmap methods of the DMA2D formats (GUIDRV_stm32f429i_discovery.h)
+*/
+const GUI_BITMAP_METHODS GUI_BitmapMethodsDMA2D_A4       = { _DrawBitmapA4,       NULL, NULL };
+const GUI_BITMAP_METHODS GUI_BitmapMethodsDMA2D_A8       = { _DrawBitmapA8,       NULL, NULL };
+const GUI_BITMAP_METHODS GUI_BitmapMethodsDMA2D_L4       = { _DrawBitmapL4,       NULL, NULL };
+const GUI_BITMAP_METHODS GUI_BitmapMethodsDMA2D_ARGB4444 = { _DrawBitmapARGB4444, NULL, NULL };
+
 /*********************************************************************
 *
 *       Public code
@@ -1135,8 +2037,177 @@ static void _LCD_DrawBitmap8bpp(int LayerIndex, int x, int y, U8 const * p, int
 */
 void DMA2D_ISR_Handler(void) {
   DMA2D->IFCR = (U32)DMA2D_IFSR_CTCIF;
+#if GUI_OS
+  GUI_X_SignalEvent();                              // Wake up the task waiting in _DMA_ExecOperation()
+#endif
+}
+
+/*********************************************************************
+*
+*       LCD_X_DMA2D_GetStats
+*
+* Purpose:
+*   Returns the number of DMA2D operations and the CPU cycles (DWT cycle
+*   counter) spent waiting for their completion since the last call. The
+*   counters are reset.
+*/
+void LCD_X_DMA2D_GetStats(U32 * pNumOperations, U32 * pWaitCycles) {
+  *pNumOperations       = _DMA2D_NumOperations;
+  *pWaitCycles          = _DMA2D_WaitCycles;
+  _DMA2D_NumOperations = 0;
+  _DMA2D_WaitCycles    = 0;
+}
+
+/*********************************************************************
+*
+*       LCD_X_DMA2D_GetCLUTStats
+*
+* Purpose:
+*   Returns the number of DMA2D CLUT loads and of loads avoided because
+*   the palette was resident since the last call. The counters are reset.
+*/
+void LCD_X_DMA2D_GetCLUTStats(U32 * pNumLoads, U32 * pNumAvoided) {
+  *pNumLoads       = _CLUT_NumLoads;
+  *pNumAvoided     = _CLUT_NumAvoided;
+  _CLUT_NumLoads   = 0;
+  _CLUT_NumAvoided = 0;
+}
+
+/*********************************************************************
+*
+*       LCD_X_ShrinkLayer
+*
+* Purpose:
+*   Restricts the part of the layer read by the LTDC (OnOff = 1) to the
+*   bounding box of the pixels of the visible buffer which are not fully
+*   transparent. A fully transparent layer is switched off. The change
+*   takes effect on the next vertical blanking period.
+*   To be called once the content of the layer is static: content drawn
+*   later out of the box is not shown until the next call. OnOff = 0
+*   scans the complete layer again.
+*   Returns the bytes per frame the LTDC does not read anymore.
+*/
+U32 LCD_X_ShrinkLayer(int LayerIndex, int OnOff) {
+  GUI_RECT Rect;
+  U32 NumBytes;
+
+  //
+  // In landscape mode the LTDC reads the scanout buffers, always complete
+  //
+  if ((LayerIndex >= GUI_COUNTOF(_apLayer)) || LCD_LANDSCAPE) {
+    return 0;
+  }
+  NumBytes = _axSize[LayerIndex] * _aySize[LayerIndex] * _aBytesPerPixels[LayerIndex];
+  if (OnOff == 0) {
+    _aWindowState[LayerIndex] = WINDOW_FULL;
+    NumBytes = 0;
+  } else if (_GetContentRect(LayerIndex, &Rect) == 0) {
+    _aWindowState[LayerIndex] = WINDOW_OFF;
+  } else {
+    _aWindow[LayerIndex]      = Rect;
+    _aWindowState[LayerIndex] = WINDOW_SHRUNK;
+    NumBytes -= (Rect.x1 - Rect.x0 + 1) * (Rect.y1 - Rect.y0 + 1) * _aBytesPerPixels[LayerIndex];
+  }
+  _LTDC_SetLayerWindow(LayerIndex);
+  return NumBytes;
+}
+
+/*********************************************************************
+*
+*       LCD_X_GetScanSavedBytes
+*
+* Purpose:
+*   Returns the bytes per frame not read by the LTDC because of shrunk
+*   or switched off layers (LCD_X_ShrinkLayer()).
+*/
+U32 LCD_X_GetScanSavedBytes(void) {
+  U32 NumBytes;
+  int i;
+
+  NumBytes = 0;
+  for (i = 0; i < GUI_NUM_LAYERS; i++) {
+    if (_aWindowState[i] == WINDOW_OFF) {
+      NumBytes += _axSize[i] * _aySize[i] * _aBytesPerPixels[i];
+    } else if (_aWindowState[i] == WINDOW_SHRUNK) {
+      NumBytes += (_axSize[i] * _aySize[i] - (_aWindow[i].x1 - _aWindow[i].x0 + 1) * (_aWindow[i].y1 - _aWindow[i].y0 + 1)) * _aBytesPerPixels[i];
+    }
+  }
+  return NumBytes;
+}
+
+/*********************************************************************
+*
+*       LCD_X_MULTIBUF_GetStats
+*
+* Purpose:
+*   Returns the number of displayed frames (line interrupts), of buffer
+*   switches and of switches done while the active area was already
+*   scanned (tearing) since the last call. The counters are reset.
+*   Frames per second: NumFlips * refresh rate / NumFrames.
+*/
+void LCD_X_MULTIBUF_GetStats(U32 * pNumFrames, U32 * pNumFlips, U32 * pNumTears) {
+  *pNumFrames         = _MULTIBUF_NumFrames;
+  *pNumFlips          = _MULTIBUF_NumFlips;
+  *pNumTears          = _MULTIBUF_NumTears;
+  _MULTIBUF_NumFrames = 0;
+  _MULTIBUF_NumFlips  = 0;
+  _MULTIBUF_NumTears  = 0;
+}
+
+#if LCD_LANDSCAPE
+/*********************************************************************
+*
+*       LCD_X_LANDSCAPE_Invalidate
+*
+* Purpose:
+*   Landscape mode: records an area of the layer written without emWin,
+*   directly into the render buffer. emWin drawing operations are
+*   recorded by the driver.
+*/
+void LCD_X_LANDSCAPE_Invalidate(int LayerIndex, int x0, int y0, int x1, int y1) {
+  if (LayerIndex < GUI_NUM_LAYERS) {
+    _MarkDirty(LayerIndex, x0, y0, x1, y1);
+  }
 }
 
+/*********************************************************************
+*
+*       LCD_X_LANDSCAPE_Update
+*
+* Purpose:
+*   Landscape mode with a single buffer: rotates the areas drawn since the
+*   last call into the scanout buffers and shows them on the next vertical
+*   blanking period. With multiple buffers this is done at the end of each
+*   frame (GUI_MULTIBUF_End()) and this function must not be called.
+*/
+void LCD_X_LANDSCAPE_Update(int LayerIndex) {
+  if (LayerIndex < GUI_NUM_LAYERS) {
+    _Landscape_Show(LayerIndex, 0);
+  }
+}
+
+/*********************************************************************
+*
+*       LCD_X_LANDSCAPE_GetStats
+*
+* Purpose:
+*   Returns the number of rotations into the scanout buffers, the pixels
+*   rotated and the CPU cycles (DWT cycle counter) spent since the last
+*   call. The counters are reset.
+*   To compare with the emWin orientation path, the same frames are drawn
+*   with LCD_LANDSCAPE 0 after GUI_SetOrientation() with GUI_SWAP_XY:
+*   drawing time plus rotation cycles here against drawing time there.
+*/
+void LCD_X_LANDSCAPE_GetStats(U32 * pNumRotations, U32 * pNumPixels, U32 * pCycles) {
+  *pNumRotations          = _LANDSCAPE_NumRotations;
+  *pNumPixels             = _LANDSCAPE_NumPixels;
+  *pCycles                = _LANDSCAPE_Cycles;
+  _LANDSCAPE_NumRotations = 0;
+  _LANDSCAPE_NumPixels    = 0;
+  _LANDSCAPE_Cycles       = 0;
+}
+#endif
+
 /*********************************************************************
 *
 *       LTDC_ISR_Handler
@@ -1146,15 +2217,27 @@ void DMA2D_ISR_Handler(void) {
 */
 void LTDC_ISR_Handler(void) {
   U32 Addr;
+  U32 yPos;
   int i;
 
   LTDC->ICR = (U32)LTDC_IER_LIE;
+  _MULTIBUF_NumFrames++;
   for (i = 0; i < GUI_NUM_LAYERS; i++) {
+#if LCD_LANDSCAPE
+    if (_aPendingScan[i] >= 0) {
+      //
+      // Landscape mode: the scanout buffer brought up to date by _Landscape_Show()
+      //
+      Addr = _aScanAddr[i] + _aScanNumBytes[i] / _aNumScanBuffers[i] * _aPendingScan[i];
+      _aVisibleScan[i] = _aPendingScan[i];
+      _aPendingScan[i] = -1;
+#else
     if (_aPendingBuffer[i] >= 0) {
       //
       // Calculate address of buffer to be used  as visible frame buffer
       //
-      Addr = _aAddr[i] + _axSize[i] * _aySize[i] * _aPendingBuffer[i] * _aBytesPerPixels[i];
+      Addr = _aAddr[i] + _axSize[i] * _aySize[i] * _aPendingBuffer[i] * _aBytesPerPixels[i] + _aWindowOffset[i];
+#endif
       //
       // Store address into SFR
       //
@@ -1165,14 +2248,26 @@ void LTDC_ISR_Handler(void) {
       //
       LTDC_ReloadConfig(LTDC_SRCR_IMR);
       //
-      // Tell emWin that buffer is used
+      // A switch taking effect once the active area is scanned again shows
+      // parts of two buffers in the same frame
       //
-      GUI_MULTIBUF_ConfirmEx(i, _aPendingBuffer[i]);
+      yPos = LTDC->CPSR & LTDC_CPSR_CYPOS;
+      if ((yPos > VBP) && (yPos <= VBP + YSIZE_PHYS)) {
+        _MULTIBUF_NumTears++;
+      }
+      _MULTIBUF_NumFlips++;
       //
-      // Clear pending buffer flag of layer
+      // Tell emWin that buffer is used (no emWin buffer with
+      // LCD_X_LANDSCAPE_Update())
       //
-      _aBufferIndex[i] = _aPendingBuffer[i];
-      _aPendingBuffer[i] = -1;
+      if (_aPendingBuffer[i] >= 0) {
+        GUI_MULTIBUF_ConfirmEx(i, _aPendingBuffer[i]);
+        //
+        // Clear pending buffer flag of layer
+        //
+        _aVisibleBuffer[i] = _aPendingBuffer[i];
+        _aPendingBuffer[i] = -1;
+      }
     }
   }
 }
@@ -1211,13 +2306,16 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
   }
   case LCD_X_SETORG: {
     //
-    // Required for setting the display origin which is passed in the 'xPos' and 'yPos' element of p
+    // Required for setting the display origin which is passed in the 'xPos' and 'yPos' element of p.
+    // In landscape mode the LTDC keeps reading the scanout buffers.
     //
+#if (LCD_LANDSCAPE == 0)
     LCD_X_SETORG_INFO * p;
 
     p = (LCD_X_SETORG_INFO *)pData;
-    _apLayer[LayerIndex]->CFBAR = _aAddr[LayerIndex] + p->yPos * _axSize[LayerIndex] * _aBytesPerPixels[LayerIndex];
+    _apLayer[LayerIndex]->CFBAR = _aAddr[LayerIndex] + p->yPos * _axSize[LayerIndex] * _aBytesPerPixels[LayerIndex] + _aWindowOffset[LayerIndex];
     LTDC_ReloadConfig(LTDC_SRCR_VBR); // Reload on next blanking period
+#endif
     break;
   }
   case LCD_X_SHOWBUFFER: {
@@ -1228,6 +2326,9 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
 
     p = (LCD_X_SHOWBUFFER_INFO *)pData;
     _aPendingBuffer[LayerIndex] = p->Index;
+#if LCD_LANDSCAPE
+    _Landscape_Show(LayerIndex, p->Index);
+#endif
     break;
   }
   case LCD_X_SETLUTENTRY: {
@@ -1286,6 +2387,9 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
 
     GUI_GetLayerPosEx(LayerIndex, &xPos, &yPos);
     p = (LCD_X_SETSIZE_INFO *)pData;
+    if (_aWindowState[LayerIndex] != WINDOW_FULL) {
+      LCD_X_ShrinkLayer(LayerIndex, 0);             // The window of the old size is meaningless
+    }
     _axSize[LayerIndex] = p->xSize;
     _aySize[LayerIndex] = p->ySize;
     _LTDC_SetLayerPos(LayerIndex, xPos, yPos);
@@ -1341,13 +2445,18 @@ int LCD_X_DisplayDriver(unsigned LayerIndex, unsigned Cmd, void * pData) {
 */
 void LCD_X_Config(void) {
   int i;
+#if LCD_LANDSCAPE
+  int j;
+#endif
 
   //
   // At first initialize use of multiple buffers on demand
   //
-  #if (NUM_BUFFERS > 1)
+  #if (NUM_BUFFERS_0 > 1) || (NUM_BUFFERS_1 > 1)
     for (i = 0; i < GUI_NUM_LAYERS; i++) {
-      GUI_MULTIBUF_ConfigEx(i, NUM_BUFFERS);
+      if (_aNumBuffers[i] > 1) {
+        GUI_MULTIBUF_ConfigEx(i, _aNumBuffers[i]);
+      }
     }
   #endif
   //
@@ -1380,6 +2489,23 @@ void LCD_X_Config(void) {
     // Set VRAM address
     //
     LCD_SetVRAMAddrEx(i, (void *)(_aAddr[i]));
+    //
+    // Record the layer buffers in the SDRAM memory map
+    //
+    SDRAM_RegionReserve(_apLayerName[i], SDRAM_REGION_FRAMEBUFFER, _aAddr[i], _aLayerNumBytes[i]);
+#if LCD_LANDSCAPE
+    SDRAM_RegionReserve(_apScanName[i],  SDRAM_REGION_FRAMEBUFFER, _aScanAddr[i], _aScanNumBytes[i]);
+    //
+    // Scanout buffer 0 is shown first, no scanout buffer holds anything yet
+    //
+    _aPendingScan[i] = -1;
+    _aVisibleScan[i] = 0;
+    _ClearRect(&_aDirty[i]);
+    for (j = 0; j < NUM_SCANOUT_MAX; j++) {
+      _ClearRect(&_aStale[i][j]);
+      _MergeRect(&_aStale[i][j], 0, 0, XSIZE_LOG - 1, YSIZE_LOG - 1);
+    }
+#endif
     //
     // Remember color depth for further operations
     //
@@ -1431,6 +2557,15 @@ void LCD_X_Config(void) {
   //
   GUI_SetFuncMixColorsBulk(_LCD_MixColorsBulk);
   }
+#if LCD_LANDSCAPE
+  //
+  // Link the modifier devices recording the areas drawn by emWin above the
+  // drivers, once these are completely set up
+  //
+  for (i = 0; i < GUI_NUM_LAYERS; i++) {
+    GUI_DEVICE_CreateAndLink(&_Landscape_DeviceAPI, _apColorConvAPI[i], 0, i);
+  }
+#endif
 }
 
 /*************************** End of file ****************************/
@@ -0,0 +1,95 @@
+/*********************************************************************
+*          Portions COPYRIGHT 2013 STMicroelectronics                *
+*          Portions SEGGER Microcontroller GmbH & Co. KG             *
+*        Solutions for real time microcontroller applications        *
+**********************************************************************
+*                                                                    *
+*        (c) 1996 - 2012  SEGGER Microcontroller GmbH & Co. KG       *
+*                                                                    *
+*        Internet: www.segger.com    Support:  support@segger.com    *
+*                                                                    *
+**********************************************************************
+
+** emWin V5.22 - Graphical user interface for embedded applications **
+All  Intellectual Property rights  in the Software belongs to  SEGGER.
+emWin is protected by  international copyright laws.  Knowledge of the
+source code may not be used to write a similar product.  This file may
+only be used in accordance with the following terms:
+
+The software  has been  licensed to  STMicroelectronics  International
+N.V. whose  registered office  is situated at Plan-les-Ouates, Geneva,
+39 Chemin du Champ des Filles,  Switzerland solely for the purposes of
+creating libraries for  STMicroelectronics  ARM Cortex-M-based 32-bit
+microcontroller    products,    sublicensed    and    distributed   by
+STMicroelectronics  under  the  terms  and  conditions of the End User
+License Agreement supplied with  the software. The use of the software
+on a stand-alone basis  or for any purpose other  than to operate with
+the specified  microcontroller is prohibited and subject to a separate
+license agreement.
+
+Full source code is available at: www.segger.com
+
+We appreciate your understanding and fairness.
+----------------------------------------------------------------------
+File        : GUIDRV_stm32f429i_discovery.h
+Purpose     : Interface of the display driver extensions
+---------------------------END-OF-HEADER------------------------------
+*/
+
+/**
+  ******************************************************************************
+  * @attention
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+#ifndef GUIDRV_STM32F429I_DISCOVERY_H
+#define GUIDRV_STM32F429I_DISCOVERY_H
+
+#include "GUI.h"
+
+/*********************************************************************
+*
+*       Bitmaps of DMA2D input formats
+*
+*   Bitmaps using these methods are drawn by the DMA2D into the layers:
+*
+*   GUI_DRAW_DMA2D_A4, GUI_DRAW_DMA2D_A8:
+*     Alpha maps (anti-aliased glyphs, icon masks) blended in the current
+*     color. BitsPerPixel: 4 or 8, pPal: NULL.
+*   GUI_DRAW_DMA2D_L4:
+*     4 bpp palettized pictures, the palette is loaded into the CLUT. An
+*     index 0 is transparent if the palette has transparency.
+*   GUI_DRAW_DMA2D_ARGB4444:
+*     Sprites with 4 bit alpha, 2 bytes per pixel, little endian.
+*
+*   Rows start on a byte (BytesPerLine = (XSize * BitsPerPixel + 7) / 8).
+*   Unlike emWin 4 bpp bitmaps the first pixel of a byte is in its low
+*   nibble. Use an even XSize for the 4 bpp formats: the DMA2D draws
+*   4 bpp areas starting and ending on a byte only.
+*/
+extern const GUI_BITMAP_METHODS GUI_BitmapMethodsDMA2D_A4;
+extern const GUI_BITMAP_METHODS GUI_BitmapMethodsDMA2D_A8;
+extern const GUI_BITMAP_METHODS GUI_BitmapMethodsDMA2D_L4;
+extern const GUI_BITMAP_METHODS GUI_BitmapMethodsDMA2D_ARGB4444;
+
+#define GUI_DRAW_DMA2D_A4        &GUI_BitmapMethodsDMA2D_A4
+#define GUI_DRAW_DMA2D_A8        &GUI_BitmapMethodsDMA2D_A8
+#define GUI_DRAW_DMA2D_L4        &GUI_BitmapMethodsDMA2D_L4
+#define GUI_DRAW_DMA2D_ARGB4444  &GUI_BitmapMethodsDMA2D_ARGB4444
+
+#endif /* GUIDRV_STM32F429I_DISCOVERY_H */
+
+/*************************** End of file ****************************/
@@ -0,0 +1,379 @@
+/*********************************************************************
+*          Portions COPYRIGHT 2013 STMicroelectronics                *
+*          Portions SEGGER Microcontroller GmbH & Co. KG             *
+*        Solutions for real time microcontroller applications        *
+**********************************************************************
+*                                                                    *
+*        (c) 1996 - 2012  SEGGER Microcontroller GmbH & Co. KG       *
+*                                                                    *
+*        Internet: www.segger.com    Support:  support@segger.com    *
+*                                                                    *
+**********************************************************************
+
+** emWin V5.22 - Graphical user interface for embedded applications **
+All  Intellectual Property rights  in the Software belongs to  SEGGER.
+emWin is protected by  international copyright laws.  Knowledge of the
+source code may not be used to write a similar product.  This file may
+only be used in accordance with the following terms:
+
+The software  has been  licensed to  STMicroelectronics  International
+N.V. whose  registered office  is situated at Plan-les-Ouates, Geneva,
+39 Chemin du Champ des Filles,  Switzerland solely for the purposes of
+creating libraries for  STMicroelectronics  ARM Cortex-M-based 32-bit
+microcontroller    products,    sublicensed    and    distributed   by
+STMicroelectronics  under  the  terms  and  conditions of the End User
+License Agreement supplied with  the software. The use of the software
+on a stand-alone basis  or for any purpose other  than to operate with
+the specified  microcontroller is prohibited and subject to a separate
+license agreement.
+
+Full source code is available at: www.segger.com
+
+We appreciate your understanding and fairness.
+----------------------------------------------------------------------
+File        : GUI_MemdevCache.c
+Purpose     : Cache of static window content in memory devices
+---------------------------END-OF-HEADER------------------------------
+*/
+
+/**
+  ******************************************************************************
+  * @attention
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/*
+*   Static content of a window (maze walls, dialog frames, graph grids) is
+*   drawn once into a memory device and written to the display on each
+*   repaint. The memory devices are allocated from the emWin heap, placed
+*   in the SDRAM (GUIConf.c): writing them uses the DMA2D copy (opaque
+*   devices) or the DMA2D alpha blending (transparent devices) of the
+*   display driver.
+*
+*   An entry is found by window and state: a widget keeps one device for
+*   each look (pressed, released, ...). The device is only reused if the
+*   drawn rectangle and the window origin are the same as when it was
+*   filled: a window moved or resized redraws its content into a new
+*   device. The least recently used devices are deleted when the cache
+*   exceeds its budget or the heap is full.
+*/
+
+#include <stddef.h>
+
+#include "GUI_MemdevCache.h"
+
+/*********************************************************************
+*
+*       Defines, configurable
+*
+**********************************************************************
+*/
+//
+// Maximum number of cached devices
+//
+#ifndef   GUI_MEMCACHE_NUM_ENTRIES
+  #define GUI_MEMCACHE_NUM_ENTRIES  16
+#endif
+
+//
+// Bytes of the emWin heap the cached devices may use
+//
+#ifndef   GUI_MEMCACHE_NUMBYTES
+  #define GUI_MEMCACHE_NUMBYTES     (1024 * 1024)
+#endif
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  WM_HWIN           hWin;
+  U32               State;
+  GUI_RECT          Rect;      // Area drawn by pfDraw
+  int               xOrg;      // Window origin when the device was filled
+  int               yOrg;
+  GUI_MEMDEV_Handle hMem;      // 0 if the entry is free
+  U32               NumBytes;
+  U32               LastUse;
+} CACHE_ENTRY;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static CACHE_ENTRY _aEntry[GUI_MEMCACHE_NUM_ENTRIES];
+static U32         _NumBytes;
+static U32         _NumBytesBudget = GUI_MEMCACHE_NUMBYTES;
+static U32         _UseCount;
+static U32         _NumHits;
+static U32         _NumMisses;
+static U32         _NumEvictions;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+/*********************************************************************
+*
+*       _Delete
+*/
+static void _Delete(CACHE_ENTRY * pEntry) {
+  GUI_MEMDEV_Delete(pEntry->hMem);
+  _NumBytes    -= pEntry->NumBytes;
+  pEntry->hMem  = 0;
+}
+
+/*********************************************************************
+*
+*       _EvictOne
+*
+* Purpose:
+*   Deletes the least recently used device, except pKeep.
+*   Returns 0 if there is no device to delete.
+*/
+static int _EvictOne(CACHE_ENTRY * pKeep) {
+  CACHE_ENTRY * pLRU;
+  int i;
+
+  pLRU = NULL;
+  for (i = 0; i < GUI_MEMCACHE_NUM_ENTRIES; i++) {
+    if ((_aEntry[i].hMem) && (&_aEntry[i] != pKeep)) {
+      if ((pLRU == NULL) || (_aEntry[i].LastUse < pLRU->LastUse)) {
+        pLRU = &_aEntry[i];
+      }
+    }
+  }
+  if (pLRU == NULL) {
+    return 0;
+  }
+  _Delete(pLRU);
+  _NumEvictions++;
+  return 1;
+}
+
+/*********************************************************************
+*
+*       _Create
+*
+* Purpose:
+*   Creates the device, deleting cached devices while the heap is full.
+*/
+static GUI_MEMDEV_Handle _Create(const GUI_RECT * pRect, int Flags) {
+  GUI_MEMDEV_Handle hMem;
+  int xSize, ySize;
+
+  xSize = pRect->x1 - pRect->x0 + 1;
+  ySize = pRect->y1 - pRect->y0 + 1;
+  do {
+    if (Flags & GUI_MEMCACHE_TRANS) {
+      hMem = GUI_MEMDEV_CreateFixed(pRect->x0, pRect->y0, xSize, ySize, GUI_MEMDEV_HASTRANS, GUI_MEMDEV_APILIST_32, GUICC_8888);
+    } else {
+      hMem = GUI_MEMDEV_CreateEx(pRect->x0, pRect->y0, xSize, ySize, GUI_MEMDEV_NOTRANS);
+    }
+  } while ((hMem == 0) && _EvictOne(NULL));
+  return hMem;
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+/*********************************************************************
+*
+*       GUI_MEMCACHE_Draw
+*
+* Purpose:
+*   Draws the content of the window hWin for the given state. The first
+*   call draws it with pfDraw into a new memory device, the following
+*   calls with the same window and state only write the device.
+*   pRect is the area drawn by pfDraw, in the coordinates used by
+*   pfDraw (window coordinates when called from WM_PAINT).
+*   A device filled with another rectangle or at another window
+*   position (WM_MOVE, WM_SIZE) is deleted and counts as a miss.
+*   Returns 1 on a cache hit. If no device can be created, the content
+*   is drawn directly and 0 is returned.
+*/
+int GUI_MEMCACHE_Draw(WM_HWIN hWin, U32 State, const GUI_RECT * pRect, int Flags, GUI_CALLBACK_VOID_P * pfDraw, void * pData) {
+  GUI_MEMDEV_Handle hMem;
+  GUI_MEMDEV_Handle hMemPrev;
+  CACHE_ENTRY     * pEntry;
+  CACHE_ENTRY     * pFree;
+  int xOrg, yOrg;
+  int i;
+
+  _UseCount++;
+  xOrg  = WM_GetWindowOrgX(hWin);
+  yOrg  = WM_GetWindowOrgY(hWin);
+  pFree = NULL;
+  for (i = 0; i < GUI_MEMCACHE_NUM_ENTRIES; i++) {
+    pEntry = &_aEntry[i];
+    if (pEntry->hMem == 0) {
+      if (pFree == NULL) {
+        pFree = pEntry;
+      }
+    } else if ((pEntry->hWin == hWin) && (pEntry->State == State)) {
+      if ((pEntry->xOrg == xOrg)        && (pEntry->yOrg == yOrg)        &&
+          (pEntry->Rect.x0 == pRect->x0) && (pEntry->Rect.y0 == pRect->y0) &&
+          (pEntry->Rect.x1 == pRect->x1) && (pEntry->Rect.y1 == pRect->y1)) {
+        pEntry->LastUse = _UseCount;
+        GUI_MEMDEV_Write(pEntry->hMem);
+        _NumHits++;
+        return 1;
+      }
+      //
+      // Window moved or resized: the device is stale
+      //
+      _Delete(pEntry);
+      if (pFree == NULL) {
+        pFree = pEntry;
+      }
+    }
+  }
+  _NumMisses++;
+  //
+  // Table full: reuse the entry of the least recently used device
+  //
+  if (pFree == NULL) {
+    _EvictOne(NULL);
+    for (i = 0; (i < GUI_MEMCACHE_NUM_ENTRIES) && (pFree == NULL); i++) {
+      if (_aEntry[i].hMem == 0) {
+        pFree = &_aEntry[i];
+      }
+    }
+  }
+  hMem = _Create(pRect, Flags);
+  if (hMem == 0) {
+    pfDraw(pData);
+    return 0;
+  }
+  pFree->hWin     = hWin;
+  pFree->State    = State;
+  pFree->Rect     = *pRect;
+  pFree->xOrg     = xOrg;
+  pFree->yOrg     = yOrg;
+  pFree->hMem     = hMem;
+  pFree->NumBytes = (U32)GUI_MEMDEV_GetXSize(hMem) * GUI_MEMDEV_GetYSize(hMem) * ((GUI_MEMDEV_GetBitsPerPixel(hMem) + 7) >> 3);
+  pFree->LastUse  = _UseCount;
+  _NumBytes      += pFree->NumBytes;
+  while ((_NumBytes > _NumBytesBudget) && _EvictOne(pFree));
+  //
+  // Draw the content into the device, then to the display
+  //
+  if (Flags & GUI_MEMCACHE_TRANS) {
+    GUI_MEMDEV_Clear(hMem);
+  }
+  hMemPrev = GUI_MEMDEV_Select(hMem);
+  pfDraw(pData);
+  GUI_MEMDEV_Select(hMemPrev);
+  GUI_MEMDEV_Write(hMem);
+  return 0;
+}
+
+/*********************************************************************
+*
+*       GUI_MEMCACHE_Invalidate
+*
+* Purpose:
+*   Deletes the devices of the window in all states. To be called when
+*   the static content changes and on WM_DELETE.
+*/
+void GUI_MEMCACHE_Invalidate(WM_HWIN hWin) {
+  int i;
+
+  for (i = 0; i < GUI_MEMCACHE_NUM_ENTRIES; i++) {
+    if ((_aEntry[i].hMem) && (_aEntry[i].hWin == hWin)) {
+      _Delete(&_aEntry[i]);
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       GUI_MEMCACHE_InvalidateState
+*/
+void GUI_MEMCACHE_InvalidateState(WM_HWIN hWin, U32 State) {
+  int i;
+
+  for (i = 0; i < GUI_MEMCACHE_NUM_ENTRIES; i++) {
+    if ((_aEntry[i].hMem) && (_aEntry[i].hWin == hWin) && (_aEntry[i].State == State)) {
+      _Delete(&_aEntry[i]);
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       GUI_MEMCACHE_Clear
+*/
+void GUI_MEMCACHE_Clear(void) {
+  int i;
+
+  for (i = 0; i < GUI_MEMCACHE_NUM_ENTRIES; i++) {
+    if (_aEntry[i].hMem) {
+      _Delete(&_aEntry[i]);
+    }
+  }
+}
+
+/*********************************************************************
+*
+*       GUI_MEMCACHE_SetBudget
+*
+* Purpose:
+*   Sets the bytes the cached devices may use. Devices are deleted until
+*   the cache fits.
+*/
+void GUI_MEMCACHE_SetBudget(U32 NumBytes) {
+  _NumBytesBudget = NumBytes;
+  while ((_NumBytes > _NumBytesBudget) && _EvictOne(NULL));
+}
+
+/*********************************************************************
+*
+*       GUI_MEMCACHE_GetStats
+*
+* Purpose:
+*   Returns the use of the cache. The hit, miss and eviction counters are
+*   reset.
+*/
+void GUI_MEMCACHE_GetStats(GUI_MEMCACHE_STATS * pStats) {
+  int i;
+
+  pStats->NumHits        = _NumHits;
+  pStats->NumMisses      = _NumMisses;
+  pStats->NumEvictions   = _NumEvictions;
+  pStats->NumBytes       = _NumBytes;
+  pStats->NumBytesBudget = _NumBytesBudget;
+  pStats->NumEntries     = 0;
+  for (i = 0; i < GUI_MEMCACHE_NUM_ENTRIES; i++) {
+    if (_aEntry[i].hMem) {
+      pStats->NumEntries++;
+    }
+  }
+  _NumHits      = 0;
+  _NumMisses    = 0;
+  _NumEvictions = 0;
+}
+
+/*************************** End of file ****************************/
@@ -0,0 +1,106 @@
+/*********************************************************************
+*          Portions COPYRIGHT 2013 STMicroelectronics                *
+*          Portions SEGGER Microcontroller GmbH & Co. KG             *
+*        Solutions for real time microcontroller applications        *
+**********************************************************************
+*                                                                    *
+*        (c) 1996 - 2012  SEGGER Microcontroller GmbH & Co. KG       *
+*                                                                    *
+*        Internet: www.segger.com    Support:  support@segger.com    *
+*                                                                    *
+**********************************************************************
+
+** emWin V5.22 - Graphical user interface for embedded applications **
+All  Intellectual Property rights  in the Software belongs to  SEGGER.
+emWin is protected by  international copyright laws.  Knowledge of the
+source code may not be used to write a similar product.  This file may
+only be used in accordance with the following terms:
+
+The software  has been  licensed to  STMicroelectronics  International
+N.V. whose  registered office  is situated at Plan-les-Ouates, Geneva,
+39 Chemin du Champ des Filles,  Switzerland solely for the purposes of
+creating libraries for  STMicroelectronics  ARM Cortex-M-based 32-bit
+microcontroller    products,    sublicensed    and    distributed   by
+STMicroelectronics  under  the  terms  and  conditions of the End User
+License Agreement supplied with  the software. The use of the software
+on a stand-alone basis  or for any purpose other  than to operate with
+the specified  microcontroller is prohibited and subject to a separate
+license agreement.
+
+Full source code is available at: www.segger.com
+
+We appreciate your understanding and fairness.
+----------------------------------------------------------------------
+File        : GUI_MemdevCache.h
+Purpose     : Cache of static window content in memory devices
+---------------------------END-OF-HEADER------------------------------
+*/
+
+/**
+  ******************************************************************************
+  * @attention
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+#ifndef GUI_MEMDEVCACHE_H
+#define GUI_MEMDEVCACHE_H
+
+#include "GUI.h"
+#include "WM.h"
+
+/*********************************************************************
+*
+*       Defines
+*
+**********************************************************************
+*/
+//
+// Flags of GUI_MEMCACHE_Draw()
+//
+#define GUI_MEMCACHE_NOTRANS  0      // Opaque content: device of the layer format, written with DMA2D copies
+#define GUI_MEMCACHE_TRANS    (1<<0) // Content with transparent pixels: 32 bpp device, blended with the DMA2D
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+typedef struct {
+  U32 NumHits;
+  U32 NumMisses;       // Content drawn into a new device
+  U32 NumEvictions;    // Devices deleted to stay within the budget
+  U32 NumEntries;
+  U32 NumBytes;        // Bytes of the cached devices
+  U32 NumBytesBudget;
+} GUI_MEMCACHE_STATS;
+
+/*********************************************************************
+*
+*       Prototypes
+*
+**********************************************************************
+*/
+int  GUI_MEMCACHE_Draw           (WM_HWIN hWin, U32 State, const GUI_RECT * pRect, int Flags, GUI_CALLBACK_VOID_P * pfDraw, void * pData);
+void GUI_MEMCACHE_Invalidate     (WM_HWIN hWin);
+void GUI_MEMCACHE_InvalidateState(WM_HWIN hWin, U32 State);
+void GUI_MEMCACHE_Clear          (void);
+void GUI_MEMCACHE_SetBudget      (U32 NumBytes);
+void GUI_MEMCACHE_GetStats       (GUI_MEMCACHE_STATS * pStats);
+
+#endif /* GUI_MEMDEVCACHE_H */
+
+/*************************** End of file ****************************/
@@ -54,6 +54,36 @@ Purpose     : Display driver configuration file
 #ifndef LCDCONF_H
 #define LCDCONF_H
 
+#include "Global.h"
+
+/*********************************************************************
+*
+*       DMA2D completion statistics (GUIDRV_stm32f429i_discovery.c)
+*/
+void LCD_X_DMA2D_GetStats(U32 * pNumOperations, U32 * pWaitCycles);
+void LCD_X_DMA2D_GetCLUTStats(U32 * pNumLoads, U32 * pNumAvoided);
+
+/*********************************************************************
+*
+*       Multiple buffering statistics (GUIDRV_stm32f429i_discovery.c)
+*/
+void LCD_X_MULTIBUF_GetStats(U32 * pNumFrames, U32 * pNumFlips, U32 * pNumTears);
+
+/*********************************************************************
+*
+*       Layer window shrinking (GUIDRV_stm32f429i_discovery.c)
+*/
+U32  LCD_X_ShrinkLayer      (int LayerIndex, int OnOff);
+U32  LCD_X_GetScanSavedBytes(void);
+
+/*********************************************************************
+*
+*       Landscape mode, LCD_LANDSCAPE 1 (GUIDRV_stm32f429i_discovery.c)
+*/
+void LCD_X_LANDSCAPE_Invalidate(int LayerIndex, int x0, int y0, int x1, int y1);
+void LCD_X_LANDSCAPE_Update    (int LayerIndex);
+void LCD_X_LANDSCAPE_GetStats  (U32 * pNumRotations, U32 * pNumPixels, U32 * pCycles);
+
 #endif /* LCDCONF_H */
 
 /*************************** End of file ****************************/
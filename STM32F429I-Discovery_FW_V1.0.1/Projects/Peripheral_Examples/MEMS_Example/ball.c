@@ -48,7 +48,7 @@ Ball ball = {.x_position = X_MIDDLE, .y_position = Y_MIDDLE};
  *                                 Prototypes                               *
  ****************************************************************************/
 
-unsigned int LCD_SetCursor(unsigned short int Xpos, unsigned short int Ypos);
+unsigned short int LCD_GetPixel(unsigned short int Xpos, unsigned short int Ypos);
 
 /****************************************************************************
  *                           Code: private functions
@@ -178,7 +178,7 @@ void Ball_Adjust_aVS(unsigned int orientation)
 
 unsigned int Ball_closeToWall(bool horizontal)
 {
-    unsigned int Xaddress;
+    unsigned int x, y;
     int offset;
     int x_offset, y_offset; 
     unsigned int close = false;
@@ -211,12 +211,13 @@ unsigned int Ball_closeToWall(bool horizontal)
         // Proximity loop
         while (offset <= BALL_RADIUS)
         {
-            // Get pixel address
-            Xaddress = LCD_SetCursor(ball.x_position + x_offset, ball.y_position + offset);
+            // Get pixel position
+            x = ball.x_position + x_offset;
+            y = ball.y_position + offset;
             
-            // Check pixel content
-            if ((*(unsigned short int *)Xaddress == LCD_COLOR_BLACK) || 
-                (fast && (*(unsigned short int *)(Xaddress+2) == LCD_COLOR_BLACK)))
+            // Check pixel content (the board layer may be RGB565 or L8)
+            if ((LCD_GetPixel(x, y) == LCD_COLOR_BLACK) || 
+                (fast && (LCD_GetPixel(x+1, y) == LCD_COLOR_BLACK)))
             {
                 // Set close found and quit the loop
                 close = true;
@@ -254,12 +255,13 @@ unsigned int Ball_closeToWall(bool horizontal)
         // Proximity loop
         while (offset <= BALL_RADIUS)
         {
-            // Get pixel address
-            Xaddress = LCD_SetCursor(ball.x_position + offset, ball.y_position + y_offset);
+            // Get pixel position
+            x = ball.x_position + offset;
+            y = ball.y_position + y_offset;
             
-            // Check pixel content
-            if ((*(unsigned short int *)Xaddress == LCD_COLOR_BLACK)  || 
-                (fast && (*(unsigned short int *)(Xaddress+2*X_SIZE) == LCD_COLOR_BLACK)))
+            // Check pixel content (the board layer may be RGB565 or L8)
+            if ((LCD_GetPixel(x, y) == LCD_COLOR_BLACK)  || 
+                (fast && (LCD_GetPixel(x, y+1) == LCD_COLOR_BLACK)))
             {
                 // Set close found
                 close = true;
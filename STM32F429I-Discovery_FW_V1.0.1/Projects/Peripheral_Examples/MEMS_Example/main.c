@@ -30,6 +30,8 @@
 #include "main.h"
 #include "maze.h"
 #include "ball.h"
+#include "sdram_bench.h"
+#include <string.h>
 
 /** @addtogroup STM32F429I_DISCOVERY_Examples
   * @{
@@ -46,6 +48,19 @@
 #define L3G_Sensitivity_250dps     (float)114.285f        /*!< gyroscope sensitivity with 250 dps full scale [LSB/dps]  */
 #define L3G_Sensitivity_500dps     (float)57.1429f        /*!< gyroscope sensitivity with 500 dps full scale [LSB/dps]  */
 #define L3G_Sensitivity_2000dps    (float)14.285f         /*!< gyroscope sensitivity with 2000 dps full scale [LSB/dps] */
+
+/* Uncomment the line below to measure the LCD line drawing speed at start-up */
+/* #define LCD_LINE_BENCHMARK */
+#define LINE_BENCH_COUNT           100                    /*!< lines drawn per measurement */
+
+/* Uncomment the line below to measure the LCD bitmap drawing speed at start-up */
+/* #define LCD_BMP_BENCHMARK */
+#define BMP_BENCH_ADDRESS          (LCD_FRAME_BUFFER + 2*BUFFER_OFFSET) /*!< test picture, after the two layers */
+#define BMP_BENCH_SIZE             (66 + LCD_PIXEL_WIDTH*LCD_PIXEL_HEIGHT*3) /*!< largest picture, 24 bit/pixel */
+
+/* Uncomment the line below to send the SDRAM benchmark results over USART1 at
+   start-up (see sdram_bench.c) */
+/* #define SDRAM_BENCHMARK */
   
 /* Private variables ---------------------------------------------------------*/
 float Buffer[6];
@@ -66,12 +81,41 @@ unsigned int x_omega_index = 0;
 int x_omega_raw[OMEGA_BUFFER_SIZE];	// raw data diagnostics
 unsigned int x_omega_raw_index = 0;	
 
+// LTDC frame fetch diagnostics [bytes/frame]
+unsigned int scanout_bytes = 0;
+
+#ifdef LCD_LINE_BENCHMARK
+// Line drawing diagnostics [lines/s]
+unsigned int lines_per_s_direct = 0;   // LCD_DrawUniLine, both ends visible
+unsigned int lines_per_s_clipped = 0;  // LCD_DrawUniLine, one end clipped
+unsigned int lines_per_s_points = 0;   // LCD_DrawPoints, same pixels
+#endif
+
+#ifdef LCD_BMP_BENCHMARK
+// Bitmap drawing diagnostics [MB/s of picture data]
+float bmp_mb_s_byteloop = 0;  // Demo_BMPByteLoop, R5G6B5 full screen picture
+float bmp_mb_s_rowcopy = 0;   // LCD_WriteBMP, same picture copied row by row
+float bmp_mb_s_dma2d = 0;     // LCD_DrawBMP, same picture
+float bmp_mb_s_stream = 0;    // LCD_DrawBMPFromSource, same picture copied row by row
+float bmp_mb_s_rgb888 = 0;    // LCD_DrawBMP, 24 bit/pixel picture converted to RGB565
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 static void Demo_MEMS(void);
 static void Demo_GyroConfig(void);
 static void Demo_GyroReadAngRate (float* pfData);
 static void Gyro_SimpleCalibration(float* GyroData);
+#ifdef LCD_LINE_BENCHMARK
+static void Demo_LineBenchmark(void);
+#endif
+#ifdef LCD_BMP_BENCHMARK
+static void Demo_BMPBenchmark(void);
+static void Demo_BMPBuild(uint32_t BitPixel);
+static void Demo_BMPByteLoop(uint32_t BmpAddress);
+static void Demo_BMPPut32(uint8_t *pField, uint32_t Value);
+static uint32_t Demo_BMPRead(void *pSource, uint32_t Offset, uint8_t *pBuffer, uint32_t Size);
+#endif
 
 
 RCC_ClocksTypeDef RCC_Clocks;
@@ -103,11 +147,27 @@ int main(void)
   /* Enable the LTDC */
   LTDC_Cmd(ENABLE);
   
-  /* Set LCD Background Layer  */
-  LCD_SetLayer(LCD_FOREGROUND_LAYER);
+#ifdef LCD_BMP_BENCHMARK
+  /* Bitmap drawing speed, measured before the layers are set up for the maze */
+  Demo_BMPBenchmark();
+#endif
+  
+#ifdef SDRAM_BENCHMARK
+  /* SDRAM bandwidth and latency, with 0, 1 and 2 layers scanned out */
+  SDRAM_Benchmark();
+#endif
   
-  /* Clear the Background Layer */ 
+  /* Experis: ball on the Foreground Layer, board on the Background Layer */
+  Maze_InitLayers();
+  
+  /* Experis diagnostics: SDRAM bytes fetched by the LTDC per frame */
+  scanout_bytes = LCD_GetScanoutBytes();
+
+#ifdef LCD_LINE_BENCHMARK
+  /* Line drawing speed, measured on the board layer then erased */
+  Demo_LineBenchmark();
   LCD_Clear(LCD_COLOR_WHITE);
+#endif
 
   /* Gyroscope configuration */
   Demo_GyroConfig();
@@ -121,6 +181,9 @@ int main(void)
 	/* Draw the inner maze */
 	Maze_DrawInner();
 
+	/* Draw the hole */
+	Maze_DrawHole();
+
   /* Infinite loop */
   while (1)
   {
@@ -173,14 +236,265 @@ static void Demo_MEMS(void)
 	/* Manage walls & barriers */
 	Ball_checkProxymity();
 
+#if (MAZE_BALL_SPRITE == false)
 	/* Draws the hole */
 	Maze_DrawHole();
+#endif
 	
 	/* Draws the ball, and clears the previous one */
 	Maze_DrawTheBall(ball.x_position, ball.y_position );
 	
 }
 
+#ifdef LCD_LINE_BENCHMARK
+/**
+* @brief  Measure the LCD line drawing speed with the DWT cycle counter.
+* @param  None
+* @retval None
+*/
+static void Demo_LineBenchmark(void)
+{
+  static Point points[LCD_PIXEL_HEIGHT];
+  uint32_t cycles = 0;
+  int i = 0;
+  
+  /* Enable the cycle counter */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  
+  LCD_SetTextColor(LCD_COLOR_BLACK);
+  
+  /* Screen diagonal, one pixel per line */
+  for(i=0; i<LCD_PIXEL_HEIGHT; i++)
+  {
+    points[i].X = (i * (LCD_PIXEL_WIDTH - 1)) / (LCD_PIXEL_HEIGHT - 1);
+    points[i].Y = i;
+  }
+  
+  /* Incremental address Bresenham */
+  cycles = DWT->CYCCNT;
+  for(i=0; i<LINE_BENCH_COUNT; i++)
+  {
+    LCD_DrawUniLine(0, 0, LCD_PIXEL_WIDTH - 1, LCD_PIXEL_HEIGHT - 1);
+  }
+  cycles = DWT->CYCCNT - cycles;
+  lines_per_s_direct = ((uint64_t)SystemCoreClock * LINE_BENCH_COUNT) / cycles;
+  
+  /* Per pixel clipping: the last line is outside the clip rectangle */
+  LCD_PushClipRect(0, 0, LCD_PIXEL_WIDTH, LCD_PIXEL_HEIGHT - 1);
+  cycles = DWT->CYCCNT;
+  for(i=0; i<LINE_BENCH_COUNT; i++)
+  {
+    LCD_DrawUniLine(0, 0, LCD_PIXEL_WIDTH - 1, LCD_PIXEL_HEIGHT - 1);
+  }
+  cycles = DWT->CYCCNT - cycles;
+  LCD_PopClipRect();
+  lines_per_s_clipped = ((uint64_t)SystemCoreClock * LINE_BENCH_COUNT) / cycles;
+  
+  /* Batched points, sorted by address before the stores */
+  cycles = DWT->CYCCNT;
+  for(i=0; i<LINE_BENCH_COUNT; i++)
+  {
+    LCD_DrawPoints(points, LCD_PIXEL_HEIGHT);
+  }
+  cycles = DWT->CYCCNT - cycles;
+  lines_per_s_points = ((uint64_t)SystemCoreClock * LINE_BENCH_COUNT) / cycles;
+}
+#endif
+
+#ifdef LCD_BMP_BENCHMARK
+/**
+* @brief  Measure the LCD bitmap drawing speed with the DWT cycle counter.
+* @param  None
+* @retval None
+*/
+static void Demo_BMPBenchmark(void)
+{
+  uint32_t cycles = 0;
+  uint32_t size = 0;
+  
+  /* The test picture must not overwrite another SDRAM buffer */
+  if (SDRAM_RegionReserve("BMP benchmark", SDRAM_REGION_BUFFER, BMP_BENCH_ADDRESS, BMP_BENCH_SIZE) == 0)
+  {
+    return;
+  }
+  
+  /* Enable the cycle counter */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  
+  /* R5G6B5 picture: same size and format as the layer, so LCD_WriteBMP
+     leaves the layer configuration unchanged */
+  LCD_SetLayer(LCD_BACKGROUND_LAYER);
+  Demo_BMPBuild(16);
+  size = LCD_PIXEL_WIDTH * LCD_PIXEL_HEIGHT * 2;
+  
+  /* Byte loop, reference for the CPU copies */
+  cycles = DWT->CYCCNT;
+  Demo_BMPByteLoop(BMP_BENCH_ADDRESS);
+  cycles = DWT->CYCCNT - cycles;
+  bmp_mb_s_byteloop = ((float)size * SystemCoreClock) / cycles / 1000000.0f;
+  
+  /* CPU, one memcpy per row */
+  cycles = DWT->CYCCNT;
+  LCD_WriteBMP(BMP_BENCH_ADDRESS);
+  cycles = DWT->CYCCNT - cycles;
+  bmp_mb_s_rowcopy = ((float)size * SystemCoreClock) / cycles / 1000000.0f;
+  
+  /* DMA2D, one job per row of the bottom-up picture */
+  cycles = DWT->CYCCNT;
+  LCD_DrawBMP(BMP_BENCH_ADDRESS, 0, 0);
+  cycles = DWT->CYCCNT - cycles;
+  bmp_mb_s_dma2d = ((float)size * SystemCoreClock) / cycles / 1000000.0f;
+  
+  /* DMA2D, rows read through a block source */
+  cycles = DWT->CYCCNT;
+  LCD_DrawBMPFromSource(Demo_BMPRead, (void *)BMP_BENCH_ADDRESS, 0, 0);
+  cycles = DWT->CYCCNT - cycles;
+  bmp_mb_s_stream = ((float)size * SystemCoreClock) / cycles / 1000000.0f;
+  
+  /* DMA2D with RGB888 to RGB565 conversion */
+  Demo_BMPBuild(24);
+  size = LCD_PIXEL_WIDTH * LCD_PIXEL_HEIGHT * 3;
+  cycles = DWT->CYCCNT;
+  LCD_DrawBMP(BMP_BENCH_ADDRESS, 0, 0);
+  cycles = DWT->CYCCNT - cycles;
+  bmp_mb_s_rgb888 = ((float)size * SystemCoreClock) / cycles / 1000000.0f;
+}
+
+/**
+* @brief  Build a full screen bottom-up BMP test picture (color bars).
+* @param  BitPixel: 16 (R5G6B5 bit fields) or 24 bit/pixel.
+* @retval None
+*/
+static void Demo_BMPBuild(uint32_t BitPixel)
+{
+  static const uint32_t bars[8] = {0xFFFFFF, 0xFFFF00, 0x00FFFF, 0x00FF00,
+                                   0xFF00FF, 0xFF0000, 0x0000FF, 0x000000};
+  uint8_t *bmp = (uint8_t *)BMP_BENCH_ADDRESS;
+  uint8_t *pixel;
+  uint32_t offset = (BitPixel == 16) ? 66 : 54;
+  uint32_t stride = LCD_PIXEL_WIDTH * (BitPixel / 8);
+  uint32_t size = offset + stride * LCD_PIXEL_HEIGHT;
+  uint32_t x, y, rgb;
+  
+  /* File header, info header and R5G6B5 bit fields (little endian) */
+  memset(bmp, 0, offset);
+  bmp[0] = 'B';
+  bmp[1] = 'M';
+  Demo_BMPPut32(bmp + 2, size);
+  Demo_BMPPut32(bmp + 10, offset);
+  Demo_BMPPut32(bmp + 14, 40);
+  Demo_BMPPut32(bmp + 18, LCD_PIXEL_WIDTH);
+  Demo_BMPPut32(bmp + 22, LCD_PIXEL_HEIGHT);
+  Demo_BMPPut32(bmp + 26, 1 | (BitPixel << 16));
+  if (BitPixel == 16)
+  {
+    Demo_BMPPut32(bmp + 30, 3);
+    Demo_BMPPut32(bmp + 54, 0xF800);
+    Demo_BMPPut32(bmp + 58, 0x07E0);
+    Demo_BMPPut32(bmp + 62, 0x001F);
+  }
+  
+  for (y = 0; y < LCD_PIXEL_HEIGHT; y++)
+  {
+    /* First row of the file is the bottom one */
+    pixel = bmp + offset + (LCD_PIXEL_HEIGHT - 1 - y) * stride;
+    for (x = 0; x < LCD_PIXEL_WIDTH; x++)
+    {
+      rgb = bars[(x * 8) / LCD_PIXEL_WIDTH];
+      if (BitPixel == 16)
+      {
+        *(uint16_t *)pixel = ASSEMBLE_RGB(rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF);
+        pixel += 2;
+      }
+      else
+      {
+        pixel[0] = rgb & 0xFF;
+        pixel[1] = (rgb >> 8) & 0xFF;
+        pixel[2] = rgb >> 16;
+        pixel += 3;
+      }
+    }
+  }
+}
+
+/**
+* @brief  Copy a bottom-up BMP picture byte per byte to the background layer.
+* @note   Reference for the benchmark only: this is the copy loop LCD_WriteBMP
+*         used before it moved to one memcpy per row. The picture must have the
+*         size and the pixel format of the layer.
+* @param  BmpAddress: BMP picture address.
+* @retval None
+*/
+static void Demo_BMPByteLoop(uint32_t BmpAddress)
+{
+  uint32_t index = 0, size = 0, width = 0, height = 0, bit_pixel = 0;
+  uint32_t Address = LCD_FRAME_BUFFER;
+  uint32_t currentline = 0;
+  
+  size = *(__IO uint16_t *) (BmpAddress + 2);
+  size |= (*(__IO uint16_t *) (BmpAddress + 4)) << 16;
+  index = *(__IO uint16_t *) (BmpAddress + 10);
+  index |= (*(__IO uint16_t *) (BmpAddress + 12)) << 16;
+  width = *(__IO uint16_t *) (BmpAddress + 18);
+  width |= (*(__IO uint16_t *) (BmpAddress + 20)) << 16;
+  height = *(__IO uint16_t *) (BmpAddress + 22);
+  height |= (*(__IO uint16_t *) (BmpAddress + 24)) << 16;
+  bit_pixel = *(__IO uint16_t *) (BmpAddress + 28);
+  
+  /* Pixel data only, first row of the file is the bottom one */
+  size -= index;
+  BmpAddress += index;
+  Address += width * (height - 1) * (bit_pixel / 8);
+  
+  for (index = 0; index < size; index++)
+  {
+    *(__IO uint8_t *) (Address) = *(__IO uint8_t *) BmpAddress;
+    BmpAddress++;
+    Address++;
+    currentline++;
+    
+    if ((currentline / (bit_pixel / 8)) == width)
+    {
+      /* Back to the start of the row above */
+      Address -= 2 * width * (bit_pixel / 8);
+      currentline = 0;
+    }
+  }
+}
+
+/**
+* @brief  Store a 32 bit little endian BMP header field.
+* @param  pField: field address.
+* @param  Value: field value.
+* @retval None
+*/
+static void Demo_BMPPut32(uint8_t *pField, uint32_t Value)
+{
+  pField[0] = Value & 0xFF;
+  pField[1] = (Value >> 8) & 0xFF;
+  pField[2] = (Value >> 16) & 0xFF;
+  pField[3] = Value >> 24;
+}
+
+/**
+* @brief  Block source read function of the test picture.
+* @param  pSource: picture address.
+* @param  Offset: first byte to copy.
+* @param  pBuffer: destination buffer.
+* @param  Size: bytes to copy.
+* @retval Bytes copied
+*/
+static uint32_t Demo_BMPRead(void *pSource, uint32_t Offset, uint8_t *pBuffer, uint32_t Size)
+{
+  memcpy(pBuffer, (uint8_t *)pSource + Offset, Size);
+  return Size;
+}
+#endif
+
 /**
 * @brief  Configure the Mems to gyroscope application.
 * @param  None
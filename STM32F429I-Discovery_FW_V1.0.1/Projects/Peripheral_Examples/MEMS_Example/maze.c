@@ -29,6 +29,12 @@
 
 #define HOLE_RADIUS							 12
 
+// Ball sprite side (the ball is drawn centred in it) [pixels]
+#define BALL_SPRITE_SIZE   (2*BALL_RADIUS+1)
+
+// Color key of the ball sprite background (RGB888)
+#define BALL_SPRITE_KEY    0xFFFFFF
+
 /****************************************************************************
  *                         Types declaration section                        *
  ****************************************************************************/
@@ -43,6 +49,16 @@
 // Maze
 Maze maze;
 
+/****************************************************************************
+ *                            Constants definition                          *
+ ****************************************************************************/
+
+// Board palette: the only colors drawn in the background layer
+static const unsigned short mazePalette[MAZE_NUM_COLORS] = {
+    LCD_COLOR_WHITE, LCD_COLOR_BLACK, LCD_COLOR_RED, 
+    LCD_COLOR_BLUE2, LCD_COLOR_GREY, LCD_COLOR_GREEN
+};
+
 /****************************************************************************
  *                                 Prototypes                               *
  ****************************************************************************/
@@ -52,6 +68,13 @@ void LCD_SetTextColor(unsigned short Color);
 void LCD_DrawLine(unsigned short Xpos, unsigned short Ypos, unsigned short Length, unsigned char Direction);
 void LCD_FillTriangle(unsigned short x1, unsigned short x2, unsigned short x3, unsigned short y1, unsigned short y2, unsigned short y3);
 void LCD_DrawFullCircle(unsigned short Xpos, unsigned short Ypos, unsigned short Radius);
+void LCD_SetLayer(unsigned int Layerx);
+void LCD_Clear(unsigned short Color);
+void LCD_SetTransparency(unsigned char transparency);
+void LCD_SetColorKeying(unsigned int RGBValue);
+void LCD_SetLayerWindow(unsigned int Layerx, unsigned short Width, unsigned short Height);
+void LCD_SetLayerPosition(unsigned int Layerx, short Xpos, short Ypos);
+void LCD_SetPalette(const unsigned short *Palette, unsigned short NumColors);
 
 /****************************************************************************
  *                           Code: private functions
@@ -63,6 +86,45 @@ void LCD_DrawFullCircle(unsigned short Xpos, unsigned short Ypos, unsigned short
  *                            Code: public functions
  ****************************************************************************/
 
+/****************************************************************************
+ * @brief  Prepares the LCD layers
+ * @note   Walls, border and hole live in the background layer, which is 
+ *         also the one Ball_closeToWall() probes. With MAZE_BALL_SPRITE the
+ *         ball is rendered once in a small foreground window, then moved by
+ *         the LTDC only: no frame buffer writes per frame.
+ * @retval None
+ ****************************************************************************/
+
+void Maze_InitLayers(void)
+{
+    /* Foreground layer: ball sprite or nothing */ 
+    LCD_SetLayer(LCD_FOREGROUND_LAYER);
+    
+#if (MAZE_BALL_SPRITE == true)
+    // Render the ball in the sprite corner, key out its white background 
+    LCD_Clear(LCD_COLOR_WHITE);
+    LCD_SetTextColor(LCD_COLOR_RED);
+    LCD_DrawFullCircle(BALL_RADIUS, BALL_RADIUS, BALL_RADIUS);
+    LCD_SetColorKeying(BALL_SPRITE_KEY);
+    LCD_SetLayerWindow(LCD_FOREGROUND_LAYER, BALL_SPRITE_SIZE, BALL_SPRITE_SIZE);
+#else
+    // Let the background layer show through 
+    LCD_SetTransparency(0);
+#endif
+
+    /* Background layer: the board, drawn from now on */ 
+    LCD_SetLayer(LCD_BACKGROUND_LAYER);
+    
+#if (MAZE_L8_BOARD == true)
+    // One byte per pixel: halves the board scanout and drawing traffic
+    LCD_SetPalette(mazePalette, MAZE_NUM_COLORS);
+#endif
+
+    LCD_Clear(LCD_COLOR_WHITE);
+    
+} // end Maze_InitLayers
+
+
 /****************************************************************************
  * @brief  Draws the maze's outer border 
  * @retval None
@@ -212,6 +274,17 @@ void Maze_DrawTheBall(unsigned int x, unsigned int y)
     static unsigned int _y = 0;
 	  static bool _1stTime = true;
 
+#if (MAZE_BALL_SPRITE == true)
+
+    /* Move the sprite window only when the ball has moved */
+    if (_1stTime || (x != _x) || (y != _y))
+    {
+        LCD_SetLayerPosition(LCD_FOREGROUND_LAYER, x - BALL_RADIUS, y - BALL_RADIUS);
+        _1stTime = false;
+    }
+
+#else
+
 		/* Clear old ball (except on the 1st call) */
 		if (!_1stTime)
 		{
@@ -224,6 +297,8 @@ void Maze_DrawTheBall(unsigned int x, unsigned int y)
     /* Set color to draw */
     LCD_SetTextColor(LCD_COLOR_RED);
     LCD_DrawFullCircle(x, y, BALL_RADIUS);
+
+#endif
     
     /* Adjust coordinates for next draw operation */ 
     _x = x; 
@@ -45,6 +45,18 @@
 #define MAZE_LEAST_X (X_MIDDLE+MAZE_SIZE/2)
 #define MAZE_LEAST_Y (Y_MIDDLE+MAZE_SIZE/2)
 
+// Ball drawing: true = hardware sprite on the foreground layer,
+// false = redraw the ball in the background layer at every move
+#define MAZE_BALL_SPRITE  true
+
+// Board layer format: true = L8 with the maze palette (1 byte/pixel), 
+// false = RGB565 (2 bytes/pixel)
+#define MAZE_L8_BOARD     true
+
+// LCD layers
+#define LCD_BACKGROUND_LAYER     0x0000
+#define LCD_FOREGROUND_LAYER     0x0001
+
 // LCD colors
 #define LCD_COLOR_WHITE 0xFFFF
 #define LCD_COLOR_BLACK 0x0000
@@ -53,6 +65,9 @@
 #define LCD_COLOR_GREY  0xF7DE
 #define LCD_COLOR_GREEN 0x07E0
 
+// Number of maze colors (board palette size)
+#define MAZE_NUM_COLORS 6
+
 /****************************************************************************
  *                              Global Constants                            *
  ****************************************************************************/
@@ -90,6 +105,9 @@ extern Maze maze;
  *                        Function exported by this module                  *
  ****************************************************************************/
 
+// Prepares the LCD layers (board in the background, ball in the foreground)
+void Maze_InitLayers(void);
+
 // Calculates Maze orientation
 bool Maze_GetNewOrientation(float XSpeed, float YSpeed);
 
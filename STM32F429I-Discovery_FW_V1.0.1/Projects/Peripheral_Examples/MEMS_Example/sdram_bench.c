@@ -0,0 +1,687 @@
+/**
+  ******************************************************************************
+  * @file    MEMS_Example/sdram_bench.c
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    11-November-2013
+  * @brief   SDRAM bandwidth and latency benchmark, the results are sent over
+  *          USART1 next to the values predicted by a cost model of the FMC
+  *          SDRAM timings.
+  *
+  *          The tests measure with the DWT cycle counter, interrupts masked:
+  *           - sequential writes of 32, 16 and 8-bit data and sequential
+  *             32-bit reads, with the FMC read burst disabled and enabled,
+  *           - random 32-bit reads in the same row (row hits) and in 1 MB of
+  *             the same internal bank (row misses), random 32-bit writes,
+  *           - two interleaved sequential read streams placed in the same
+  *             internal bank or in two different internal banks,
+  *           - the sequential and random reads again with the LTDC scanning
+  *             out no layer, one layer or two layers,
+  *           - the frame buffer placements of LCD_FB_PLACEMENT: CPU drawing
+  *             while the LTDC scans out two layers, all the buffers in one
+  *             internal bank or the layers in two banks, with the number of
+  *             LTDC FIFO underruns.
+  *
+  *          The model only uses the timings programmed by SDRAM_Init() and the
+  *          LTDC frame size, it predicts the effect of a layout change (bank
+  *          placement, access width, number of layers) before trying it.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sdram_bench.h"
+
+/** @addtogroup STM32F429I_DISCOVERY_Examples
+  * @{
+  */
+
+/** @addtogroup MEMS_Example
+  * @{
+  */
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* FMC SDRAM timings programmed by SDRAM_Init(), in SDCLK cycles */
+#define MODEL_SDCLK_DIV            2     /*!< SDCLOCK_PERIOD: SDCLK = HCLK/2 */
+#define MODEL_CAS                  3     /*!< SDRAM_CAS_LATENCY */
+#define MODEL_RPIPE                1     /*!< FMC_ReadPipe_Delay_1 */
+#define MODEL_TRP                  2
+#define MODEL_TRCD                 2
+#define MODEL_TWR                  2
+#define MODEL_CMD                  1     /*!< command cycle of each access */
+#define MODEL_BEATS_WORD           2     /*!< 32-bit data on the 16-bit bus */
+/* In HCLK cycles */
+#define MODEL_AHB                  2     /*!< bus matrix and FMC input stage, estimated */
+#define MODEL_SRAM_LOAD            2     /*!< load from the internal SRAM */
+#define MODEL_LTDC_BURST           64    /*!< bytes read by each LTDC AHB burst */
+
+#define BENCH_NONE                 0xFFFFFFFF  /*!< no model value */
+
+/* Placement test: layers and draw target of BUFFER_OFFSET bytes in the test
+   area, drawn BENCH_DRAW_PASSES times */
+#define BENCH_DRAW_PASSES          8
+
+/* Private macro -------------------------------------------------------------*/
+#define BENCH_XORSHIFT(SEED)       do { (SEED) ^= (SEED) << 13; (SEED) ^= (SEED) >> 17; (SEED) ^= (SEED) << 5; } while (0)
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t BenchSram[4096];         /* same tests in the internal SRAM: loop cost */
+static __IO uint32_t BenchSink = 0;      /* keeps the read results alive */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t Bench_SeqWrite32(void);
+static uint32_t Bench_SeqWrite16(void);
+static uint32_t Bench_SeqWrite8(void);
+static uint32_t Bench_SeqRead32(void);
+static uint32_t Bench_RandomRead(uint32_t Base, uint32_t Mask);
+static uint32_t Bench_RandomWrite(uint32_t Base, uint32_t Mask);
+static uint32_t Bench_TwoStreams(uint32_t Base, uint32_t Distance);
+static void     Bench_SetLayers(uint32_t Layers);
+static uint32_t Bench_Placement(uint32_t Layer2, uint32_t Target, uint32_t *pUnderruns);
+static uint32_t Bench_FrameRate(void);
+static uint32_t Bench_MBs(uint32_t Bytes, uint32_t Cycles);
+static uint32_t Model_Read(uint32_t Miss);
+static uint32_t Model_Write(uint32_t Beats, uint32_t Miss);
+static void     Bench_USARTInit(void);
+static void     Bench_PutString(const char *pString, uint32_t Width);
+static void     Bench_PutMapString(const char *pString);
+static void     Bench_PutValue(uint32_t Value10, uint32_t Width);
+static void     Bench_PrintRow(const char *pName, const char *pUnit, uint32_t Measured10, uint32_t Model10);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Runs the SDRAM tests and sends the results over USART1.
+  * @note   The LTDC must be initialized: its state is restored at the end.
+  *         The tests overwrite the SDRAM test area.
+  * @param  None
+  * @retval None
+  */
+void SDRAM_Benchmark(void)
+{
+  uint32_t gcr = LTDC->GCR, cr1 = LTDC_Layer1->CR, cr2 = LTDC_Layer2->CR;
+  uint32_t sram_random = 0, sram_streams = 0, idle_seq = 0, idle_miss = 0;
+  uint32_t cycles = 0, load = 0, layers = 0, burst_cycles = 0, underruns = 0;
+  uint32_t cfbar1 = LTDC_Layer1->CFBAR, cfbar2 = LTDC_Layer2->CFBAR;
+  char name[] = "seq read 32, 0 layer(s)";
+  char load_name[] = "LTDC load, 0 layer(s)";
+
+  Bench_USARTInit();
+
+  /* The tests overwrite the whole test area: it must be free */
+  if (SDRAM_RegionReserve("SDRAM benchmark", SDRAM_REGION_BUFFER, SDRAM_BENCH_ADDRESS, SDRAM_BENCH_SPAN) == 0)
+  {
+    Bench_PutString("\r\nSDRAM benchmark: test area already in use\r\n", 0);
+    SDRAM_RegionPrintMap(Bench_PutMapString);
+    return;
+  }
+
+  /* Enable the cycle counter */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  /* The LTDC competes with the CPU for the SDRAM: stopped for the first tests */
+  Bench_SetLayers(0);
+
+  Bench_PutString("\r\nSDRAM benchmark, HCLK ", 0);
+  Bench_PutValue(SystemCoreClock / 100000, 0);
+  Bench_PutString(" MHz, SDCLK ", 0);
+  Bench_PutValue(SystemCoreClock / MODEL_SDCLK_DIV / 100000, 0);
+  Bench_PutString(" MHz\r\n", 0);
+  SDRAM_RegionPrintMap(Bench_PutMapString);
+  Bench_PutString("test", 26);
+  Bench_PutString("unit", 6);
+  Bench_PutString("  measured     model\r\n", 0);
+
+  /* Sequential accesses ------------------------------------------------------*/
+  Bench_PrintRow("seq write 32", "MB/s", Bench_MBs(SDRAM_BENCH_SIZE, Bench_SeqWrite32()),
+                 Bench_MBs(4, Model_Write(MODEL_BEATS_WORD, 0)));
+  Bench_PrintRow("seq write 16", "MB/s", Bench_MBs(SDRAM_BENCH_SIZE, Bench_SeqWrite16()),
+                 Bench_MBs(2, Model_Write(1, 0)));
+  Bench_PrintRow("seq write 8", "MB/s", Bench_MBs(SDRAM_BENCH_SIZE, Bench_SeqWrite8()),
+                 Bench_MBs(1, Model_Write(1, 0)));
+
+  idle_seq = Bench_SeqRead32();
+  Bench_PrintRow("seq read 32", "MB/s", Bench_MBs(SDRAM_BENCH_SIZE, idle_seq),
+                 Bench_MBs(4, Model_Read(0)));
+
+  /* Read burst: the FMC reads ahead of the CPU, no model */
+  FMC_Bank5_6->SDCR[0] |= FMC_SDCR1_RBURST;
+  Bench_PrintRow("seq read 32, read burst", "MB/s", Bench_MBs(SDRAM_BENCH_SIZE, Bench_SeqRead32()),
+                 BENCH_NONE);
+  FMC_Bank5_6->SDCR[0] &= ~FMC_SDCR1_RBURST;
+
+  /* Random accesses: the model adds the SDRAM access to the loop cost
+     measured in the internal SRAM --------------------------------------------*/
+  sram_random = Bench_RandomRead((uint32_t)BenchSram, sizeof(BenchSram) - 4) / SDRAM_BENCH_ACCESSES;
+
+  cycles = Bench_RandomRead(SDRAM_BENCH_ADDRESS, SDRAM_BENCH_ROW_SIZE - 4);
+  Bench_PrintRow("random read, row hit", "cyc", (cycles * 10) / SDRAM_BENCH_ACCESSES,
+                 (sram_random + Model_Read(0) - MODEL_SRAM_LOAD) * 10);
+
+  idle_miss = Bench_RandomRead(SDRAM_BENCH_ADDRESS, SDRAM_BENCH_SIZE - 4);
+  Bench_PrintRow("random read, row miss", "cyc", (idle_miss * 10) / SDRAM_BENCH_ACCESSES,
+                 (sram_random + Model_Read(1) - MODEL_SRAM_LOAD) * 10);
+
+  /* Writes are posted: the slowest of the loop and the SDRAM sets the pace */
+  cycles = Bench_RandomWrite((uint32_t)BenchSram, sizeof(BenchSram) - 4) / SDRAM_BENCH_ACCESSES;
+  if (cycles < Model_Write(MODEL_BEATS_WORD, 1))
+  {
+    cycles = Model_Write(MODEL_BEATS_WORD, 1);
+  }
+  Bench_PrintRow("random write, row miss", "cyc",
+                 (Bench_RandomWrite(SDRAM_BENCH_ADDRESS, SDRAM_BENCH_SIZE - 4) * 10) / SDRAM_BENCH_ACCESSES,
+                 cycles * 10);
+
+  /* Placement of two streams: each internal bank keeps one row open --------*/
+  sram_streams = Bench_TwoStreams((uint32_t)BenchSram, 0) / SDRAM_BENCH_ACCESSES;
+
+  cycles = Bench_TwoStreams(SDRAM_BENCH_ADDRESS, SDRAM_BENCH_BANK_SIZE / 2);
+  Bench_PrintRow("2 streams, same bank", "cyc", (cycles * 10) / SDRAM_BENCH_ACCESSES,
+                 (sram_streams + Model_Read(1) - MODEL_SRAM_LOAD) * 10);
+
+  cycles = Bench_TwoStreams(SDRAM_BENCH_ADDRESS, SDRAM_BENCH_BANK_SIZE);
+  Bench_PrintRow("2 streams, other bank", "cyc", (cycles * 10) / SDRAM_BENCH_ACCESSES,
+                 (sram_streams + Model_Read(0) - MODEL_SRAM_LOAD) * 10);
+
+  /* LTDC contention: the model scales the idle results by the SDRAM time
+     left by the LTDC bursts --------------------------------------------------*/
+  burst_cycles = (MODEL_CAS + MODEL_RPIPE + (MODEL_LTDC_BURST / 2)) * MODEL_SDCLK_DIV;
+  for (layers = 1; layers <= 2; layers++)
+  {
+    Bench_SetLayers(layers);
+
+    /* SDRAM load in 1/1000 */
+    load = (uint32_t)(((uint64_t)LCD_GetScanoutBytes() * Bench_FrameRate() / MODEL_LTDC_BURST)
+                      * burst_cycles * 1000 / SystemCoreClock);
+    if (load > 999)
+    {
+      load = 999;
+    }
+
+    name[13] = (char)('0' + layers);
+    load_name[11] = (char)('0' + layers);
+    Bench_PrintRow(load_name, "%", BENCH_NONE, load);
+    Bench_PrintRow(name, "MB/s", Bench_MBs(SDRAM_BENCH_SIZE, Bench_SeqRead32()),
+                   (Bench_MBs(SDRAM_BENCH_SIZE, idle_seq) * (1000 - load)) / 1000);
+    Bench_PrintRow("  random read, row miss", "cyc",
+                   (Bench_RandomRead(SDRAM_BENCH_ADDRESS, SDRAM_BENCH_SIZE - 4) * 10) / SDRAM_BENCH_ACCESSES,
+                   (idle_miss * 10000) / SDRAM_BENCH_ACCESSES / (1000 - load));
+  }
+
+  /* Frame buffer placement: CPU drawing with two layers scanned out. The test
+     area covers two internal banks: in the interleaved case the draw target
+     shares bank 3 with layer 2, but no longer the layers between them ------*/
+  cycles = Bench_Placement(SDRAM_BENCH_ADDRESS + BUFFER_OFFSET, SDRAM_BENCH_ADDRESS + 2 * BUFFER_OFFSET,
+                           &underruns);
+  Bench_PrintRow("draw, contiguous layers", "MB/s", Bench_MBs(BUFFER_OFFSET * BENCH_DRAW_PASSES, cycles),
+                 BENCH_NONE);
+  Bench_PrintRow("  LTDC FIFO underruns", "", underruns * 10, BENCH_NONE);
+
+  cycles = Bench_Placement(SDRAM_BENCH_ADDRESS + SDRAM_BENCH_BANK_SIZE,
+                           SDRAM_BENCH_ADDRESS + SDRAM_BENCH_BANK_SIZE + BUFFER_OFFSET, &underruns);
+  Bench_PrintRow("draw, interleaved layers", "MB/s", Bench_MBs(BUFFER_OFFSET * BENCH_DRAW_PASSES, cycles),
+                 BENCH_NONE);
+  Bench_PrintRow("  LTDC FIFO underruns", "", underruns * 10, BENCH_NONE);
+
+  /* Restore the LTDC */
+  LTDC_Layer1->CFBAR = cfbar1;
+  LTDC_Layer2->CFBAR = cfbar2;
+  LTDC_Layer1->CR = cr1;
+  LTDC_Layer2->CR = cr2;
+  LTDC_ReloadConfig(LTDC_IMReload);
+  LTDC->GCR = gcr;
+}
+
+/**
+  * @brief  Sequential 32-bit writes of the test area.
+  * @param  None
+  * @retval Cycles.
+  */
+static uint32_t Bench_SeqWrite32(void)
+{
+  __IO uint32_t *p = (__IO uint32_t *)SDRAM_BENCH_ADDRESS;
+  uint32_t n = SDRAM_BENCH_SIZE / 16, cycles = 0;
+
+  __disable_irq();
+  cycles = DWT->CYCCNT;
+  while (n--)
+  {
+    p[0] = n;
+    p[1] = n;
+    p[2] = n;
+    p[3] = n;
+    p += 4;
+  }
+  cycles = DWT->CYCCNT - cycles;
+  __enable_irq();
+
+  return cycles;
+}
+
+/**
+  * @brief  Sequential 16-bit writes of the test area.
+  * @param  None
+  * @retval Cycles.
+  */
+static uint32_t Bench_SeqWrite16(void)
+{
+  __IO uint16_t *p = (__IO uint16_t *)SDRAM_BENCH_ADDRESS;
+  uint32_t n = SDRAM_BENCH_SIZE / 8, cycles = 0;
+
+  __disable_irq();
+  cycles = DWT->CYCCNT;
+  while (n--)
+  {
+    p[0] = (uint16_t)n;
+    p[1] = (uint16_t)n;
+    p[2] = (uint16_t)n;
+    p[3] = (uint16_t)n;
+    p += 4;
+  }
+  cycles = DWT->CYCCNT - cycles;
+  __enable_irq();
+
+  return cycles;
+}
+
+/**
+  * @brief  Sequential 8-bit writes of the test area.
+  * @param  None
+  * @retval Cycles.
+  */
+static uint32_t Bench_SeqWrite8(void)
+{
+  __IO uint8_t *p = (__IO uint8_t *)SDRAM_BENCH_ADDRESS;
+  uint32_t n = SDRAM_BENCH_SIZE / 4, cycles = 0;
+
+  __disable_irq();
+  cycles = DWT->CYCCNT;
+  while (n--)
+  {
+    p[0] = (uint8_t)n;
+    p[1] = (uint8_t)n;
+    p[2] = (uint8_t)n;
+    p[3] = (uint8_t)n;
+    p += 4;
+  }
+  cycles = DWT->CYCCNT - cycles;
+  __enable_irq();
+
+  return cycles;
+}
+
+/**
+  * @brief  Sequential 32-bit reads of the test area.
+  * @param  None
+  * @retval Cycles.
+  */
+static uint32_t Bench_SeqRead32(void)
+{
+  __IO uint32_t *p = (__IO uint32_t *)SDRAM_BENCH_ADDRESS;
+  uint32_t n = SDRAM_BENCH_SIZE / 16, sum = 0, cycles = 0;
+
+  __disable_irq();
+  cycles = DWT->CYCCNT;
+  while (n--)
+  {
+    sum += p[0];
+    sum += p[1];
+    sum += p[2];
+    sum += p[3];
+    p += 4;
+  }
+  cycles = DWT->CYCCNT - cycles;
+  __enable_irq();
+
+  BenchSink = sum;
+  return cycles;
+}
+
+/**
+  * @brief  Random 32-bit reads.
+  * @param  Base: first address of the area.
+  * @param  Mask: offset mask, area size - 4.
+  * @retval Cycles of SDRAM_BENCH_ACCESSES reads.
+  */
+static uint32_t Bench_RandomRead(uint32_t Base, uint32_t Mask)
+{
+  uint32_t seed = 0x2545F491, n = SDRAM_BENCH_ACCESSES, sum = 0, cycles = 0;
+
+  Mask &= ~3;
+  __disable_irq();
+  cycles = DWT->CYCCNT;
+  while (n--)
+  {
+    BENCH_XORSHIFT(seed);
+    sum += *(__IO uint32_t *)(Base + (seed & Mask));
+  }
+  cycles = DWT->CYCCNT - cycles;
+  __enable_irq();
+
+  BenchSink = sum;
+  return cycles;
+}
+
+/**
+  * @brief  Random 32-bit writes.
+  * @param  Base: first address of the area.
+  * @param  Mask: offset mask, area size - 4.
+  * @retval Cycles of SDRAM_BENCH_ACCESSES writes.
+  */
+static uint32_t Bench_RandomWrite(uint32_t Base, uint32_t Mask)
+{
+  uint32_t seed = 0x2545F491, n = SDRAM_BENCH_ACCESSES, cycles = 0;
+
+  Mask &= ~3;
+  __disable_irq();
+  cycles = DWT->CYCCNT;
+  while (n--)
+  {
+    BENCH_XORSHIFT(seed);
+    *(__IO uint32_t *)(Base + (seed & Mask)) = n;
+  }
+  cycles = DWT->CYCCNT - cycles;
+  __enable_irq();
+
+  return cycles;
+}
+
+/**
+  * @brief  Two interleaved sequential 32-bit read streams.
+  * @param  Base: first address of the first stream.
+  * @param  Distance: offset of the second stream.
+  * @retval Cycles of SDRAM_BENCH_ACCESSES reads.
+  */
+static uint32_t Bench_TwoStreams(uint32_t Base, uint32_t Distance)
+{
+  __IO uint32_t *a = (__IO uint32_t *)Base;
+  __IO uint32_t *b = (__IO uint32_t *)(Base + Distance);
+  uint32_t n = SDRAM_BENCH_ACCESSES / 2, sum = 0, cycles = 0;
+
+  __disable_irq();
+  cycles = DWT->CYCCNT;
+  while (n--)
+  {
+    sum += *a++;
+    sum += *b++;
+  }
+  cycles = DWT->CYCCNT - cycles;
+  __enable_irq();
+
+  BenchSink = sum;
+  return cycles;
+}
+
+/**
+  * @brief  Enables the first layers, the LTDC is stopped without layer.
+  * @param  Layers: 0, 1 or 2.
+  * @retval None
+  */
+static void Bench_SetLayers(uint32_t Layers)
+{
+  LTDC_LayerCmd(LTDC_Layer1, (Layers >= 1) ? ENABLE : DISABLE);
+  LTDC_LayerCmd(LTDC_Layer2, (Layers >= 2) ? ENABLE : DISABLE);
+  LTDC_ReloadConfig(LTDC_IMReload);
+  LTDC_Cmd((Layers != 0) ? ENABLE : DISABLE);
+}
+
+/**
+  * @brief  Sequential 32-bit writes of a draw target while the LTDC scans out
+  *         the two layers: layer 1 at the start of the test area, layer 2 at
+  *         the given address.
+  * @param  Layer2: frame buffer of layer 2.
+  * @param  Target: draw target, BUFFER_OFFSET bytes.
+  * @param  pUnderruns: receives the number of passes with a FIFO underrun.
+  * @retval Cycles of BENCH_DRAW_PASSES passes.
+  */
+static uint32_t Bench_Placement(uint32_t Layer2, uint32_t Target, uint32_t *pUnderruns)
+{
+  __IO uint32_t *p = 0;
+  uint32_t pass = 0, n = 0, cycles = 0, start = 0;
+
+  LTDC_Layer1->CFBAR = SDRAM_BENCH_ADDRESS;
+  LTDC_Layer2->CFBAR = Layer2;
+  Bench_SetLayers(2);
+  LTDC_ClearFlag(LTDC_FLAG_FU);
+  *pUnderruns = 0;
+
+  for (pass = 0; pass < BENCH_DRAW_PASSES; pass++)
+  {
+    p = (__IO uint32_t *)Target;
+    n = BUFFER_OFFSET / 16;
+
+    __disable_irq();
+    start = DWT->CYCCNT;
+    while (n--)
+    {
+      *p++ = n;
+      *p++ = n;
+      *p++ = n;
+      *p++ = n;
+    }
+    cycles += DWT->CYCCNT - start;
+    __enable_irq();
+
+    if (LTDC_GetFlagStatus(LTDC_FLAG_FU) != RESET)
+    {
+      LTDC_ClearFlag(LTDC_FLAG_FU);
+      (*pUnderruns)++;
+    }
+  }
+
+  return cycles;
+}
+
+/**
+  * @brief  Computes the LTDC frame rate from the PLLSAI and LTDC settings.
+  * @param  None
+  * @retval Frames per second.
+  */
+static uint32_t Bench_FrameRate(void)
+{
+  uint32_t input = 0, pixel_clock = 0, total = 0;
+
+  input = ((RCC->PLLCFGR & RCC_PLLCFGR_PLLSRC) != 0) ? HSE_VALUE : HSI_VALUE;
+  input /= (RCC->PLLCFGR & RCC_PLLCFGR_PLLM);
+  /* The PLLSAICFGR masks are named PLLI2Sx in the device header */
+  pixel_clock = input * ((RCC->PLLSAICFGR & RCC_PLLSAICFGR_PLLI2SN) >> 6);
+  pixel_clock /= (RCC->PLLSAICFGR & RCC_PLLSAICFGR_PLLI2SR) >> 28;
+  pixel_clock /= 2 << ((RCC->DCKCFGR & RCC_DCKCFGR_PLLSAIDIVR) >> 16);
+
+  total = (((LTDC->TWCR & LTDC_TWCR_TOTALW) >> 16) + 1) * ((LTDC->TWCR & LTDC_TWCR_TOTALH) + 1);
+
+  return pixel_clock / total;
+}
+
+/**
+  * @brief  Converts a measure to MB/s.
+  * @param  Bytes: bytes transferred.
+  * @param  Cycles: HCLK cycles.
+  * @retval MB/s x 10.
+  */
+static uint32_t Bench_MBs(uint32_t Bytes, uint32_t Cycles)
+{
+  return (uint32_t)(((uint64_t)Bytes * SystemCoreClock * 10) / Cycles / 1000000);
+}
+
+/**
+  * @brief  Model of a 32-bit read: the CPU waits for the data.
+  * @param  Miss: 1 if another row is open in the bank.
+  * @retval HCLK cycles.
+  */
+static uint32_t Model_Read(uint32_t Miss)
+{
+  uint32_t sdclk = MODEL_CAS + MODEL_BEATS_WORD + MODEL_RPIPE;
+
+  if (Miss)
+  {
+    sdclk += MODEL_TRP + MODEL_TRCD;
+  }
+
+  return (sdclk * MODEL_SDCLK_DIV) + MODEL_AHB;
+}
+
+/**
+  * @brief  Model of a write: SDRAM time used by the posted write.
+  * @param  Beats: data beats on the 16-bit bus.
+  * @param  Miss: 1 if another row is open in the bank.
+  * @retval HCLK cycles.
+  */
+static uint32_t Model_Write(uint32_t Beats, uint32_t Miss)
+{
+  uint32_t sdclk = MODEL_CMD + Beats;
+
+  if (Miss)
+  {
+    sdclk += MODEL_TWR + MODEL_TRP + MODEL_TRCD;
+  }
+
+  return sdclk * MODEL_SDCLK_DIV;
+}
+
+/**
+  * @brief  Configures USART1 for the results, transmitter only.
+  * @param  None
+  * @retval None
+  */
+static void Bench_USARTInit(void)
+{
+  GPIO_InitTypeDef GPIO_InitStructure;
+  USART_InitTypeDef USART_InitStructure;
+
+  RCC_AHB1PeriphClockCmd(SDRAM_BENCH_GPIO_CLK, ENABLE);
+  RCC_APB2PeriphClockCmd(SDRAM_BENCH_USART_CLK, ENABLE);
+
+  GPIO_PinAFConfig(SDRAM_BENCH_GPIO_PORT, SDRAM_BENCH_TX_SOURCE, SDRAM_BENCH_GPIO_AF);
+  GPIO_PinAFConfig(SDRAM_BENCH_GPIO_PORT, SDRAM_BENCH_RX_SOURCE, SDRAM_BENCH_GPIO_AF);
+
+  GPIO_InitStructure.GPIO_Pin = SDRAM_BENCH_TX_PIN | SDRAM_BENCH_RX_PIN;
+  GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+  GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+  GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+  GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+  GPIO_Init(SDRAM_BENCH_GPIO_PORT, &GPIO_InitStructure);
+
+  USART_InitStructure.USART_BaudRate = SDRAM_BENCH_USART_BAUDRATE;
+  USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+  USART_InitStructure.USART_StopBits = USART_StopBits_1;
+  USART_InitStructure.USART_Parity = USART_Parity_No;
+  USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+  USART_InitStructure.USART_Mode = USART_Mode_Tx;
+  USART_Init(SDRAM_BENCH_USART, &USART_InitStructure);
+
+  USART_Cmd(SDRAM_BENCH_USART, ENABLE);
+}
+
+/**
+  * @brief  Sends a string, padded with spaces.
+  * @param  pString: string.
+  * @param  Width: minimum number of characters.
+  * @retval None
+  */
+static void Bench_PutString(const char *pString, uint32_t Width)
+{
+  while ((*pString != 0) || (Width > 0))
+  {
+    while (USART_GetFlagStatus(SDRAM_BENCH_USART, USART_FLAG_TXE) == RESET)
+    {
+    }
+    USART_SendData(SDRAM_BENCH_USART, (*pString != 0) ? *pString++ : ' ');
+    if (Width > 0)
+    {
+      Width--;
+    }
+  }
+}
+
+/**
+  * @brief  Sends a line of the SDRAM memory map.
+  * @param  pString: string to send.
+  * @retval None
+  */
+static void Bench_PutMapString(const char *pString)
+{
+  Bench_PutString(pString, 0);
+}
+
+/**
+  * @brief  Sends a value with one decimal, right aligned.
+  * @param  Value10: value x 10, BENCH_NONE for "-".
+  * @param  Width: minimum number of characters.
+  * @retval None
+  */
+static void Bench_PutValue(uint32_t Value10, uint32_t Width)
+{
+  char text[14];
+  uint32_t index = sizeof(text) - 1;
+
+  text[index] = 0;
+  if (Value10 == BENCH_NONE)
+  {
+    text[--index] = '-';
+  }
+  else
+  {
+    text[--index] = (char)('0' + (Value10 % 10));
+    text[--index] = '.';
+    Value10 /= 10;
+    do
+    {
+      text[--index] = (char)('0' + (Value10 % 10));
+      Value10 /= 10;
+    } while (Value10 != 0);
+  }
+
+  while ((sizeof(text) - 1 - index) < Width)
+  {
+    text[--index] = ' ';
+  }
+
+  Bench_PutString(&text[index], 0);
+}
+
+/**
+  * @brief  Sends a results row: name, unit, measured and model values.
+  * @param  pName: test name.
+  * @param  pUnit: unit.
+  * @param  Measured10: measured value x 10, BENCH_NONE if not measured.
+  * @param  Model10: model value x 10, BENCH_NONE if not modelled.
+  * @retval None
+  */
+static void Bench_PrintRow(const char *pName, const char *pUnit, uint32_t Measured10, uint32_t Model10)
+{
+  Bench_PutString(pName, 26);
+  Bench_PutString(pUnit, 6);
+  Bench_PutValue(Measured10, 10);
+  Bench_PutValue(Model10, 10);
+  Bench_PutString("\r\n", 0);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    MEMS_Example/sdram_bench.h
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    11-November-2013
+  * @brief   Header for sdram_bench.c module
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SDRAM_BENCH_H
+#define __SDRAM_BENCH_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+
+/* Test area: 3 MB in the upper half of the SDRAM, after the LCD layers and
+   the bitmap benchmark picture. It covers the internal banks 2 and 3 so that
+   the bank placement of two streams can be compared */
+#define SDRAM_BENCH_ADDRESS        ((uint32_t)0xD0400000)
+#define SDRAM_BENCH_SIZE           ((uint32_t)0x00100000)   /*!< sequential tests, 1 MB */
+#define SDRAM_BENCH_BANK_SIZE      ((uint32_t)0x00200000)   /*!< 4096 rows of 512 bytes */
+#define SDRAM_BENCH_ROW_SIZE       ((uint32_t)0x00000200)
+#define SDRAM_BENCH_SPAN           (SDRAM_BENCH_BANK_SIZE + SDRAM_BENCH_SIZE) /*!< area reserved in the SDRAM map */
+#define SDRAM_BENCH_ACCESSES       8192                     /*!< random accesses per test */
+
+/* Results output: USART1 on PA9 (TX) / PA10 (RX), 115200 8N1 */
+#define SDRAM_BENCH_USART          USART1
+#define SDRAM_BENCH_USART_CLK      RCC_APB2Periph_USART1
+#define SDRAM_BENCH_USART_BAUDRATE 115200
+#define SDRAM_BENCH_TX_PIN         GPIO_Pin_9
+#define SDRAM_BENCH_TX_SOURCE      GPIO_PinSource9
+#define SDRAM_BENCH_RX_PIN         GPIO_Pin_10
+#define SDRAM_BENCH_RX_SOURCE      GPIO_PinSource10
+#define SDRAM_BENCH_GPIO_PORT      GPIOA
+#define SDRAM_BENCH_GPIO_CLK       RCC_AHB1Periph_GPIOA
+#define SDRAM_BENCH_GPIO_AF        GPIO_AF_USART1
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void SDRAM_Benchmark(void);
+
+#endif /* __SDRAM_BENCH_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -15,6 +15,12 @@
   *          cache for display. This feature allows to dump message sequentially
   *          on the display even if the number of displayed lines is bigger than
   *          the total number of line allowed by the display.
+  *
+  *          The text zone is kept as a grid of character cells: only the cells
+  *          whose character or color changed are drawn. With LCD_LOG_HW_SCROLL
+  *          the displayed lines are moved by the LCD driver (LCD_MoveLines(),
+  *          DMA2D) when the text zone scrolls. With LCD_LOG_STATS the output
+  *          is measured, see LCD_LOG_GetStats().
   *      
   ******************************************************************************
   * @attention
@@ -38,6 +44,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include  "lcd_log.h"
+#include  <string.h>
 
 /** @addtogroup Utilities
   * @{
@@ -100,6 +107,18 @@ FunctionalState LCD_Lock;
 FunctionalState LCD_Scrolled;
 uint16_t LCD_ScrollBackStep;
 
+/* Character cells shown in the text zone */
+uint8_t  LCD_ScreenLine[YWINDOW_SIZE][XWINDOW_MAX];
+uint16_t LCD_ScreenColor[YWINDOW_SIZE];
+uint16_t LCD_ScreenFirst;         /* cache line shown on the first row */
+
+#ifdef LCD_LOG_STATS
+/* Statistics, see LCD_LOG_GetStats() */
+uint32_t LCD_LOG_NumChars;
+uint32_t LCD_LOG_NumCells;
+uint32_t LCD_LOG_Cycles;
+#endif
+
 /**
 * @}
 */ 
@@ -109,6 +128,7 @@ uint16_t LCD_ScrollBackStep;
 * @{
 */ 
 static void LCD_LOG_UpdateDisplay (void);
+static void LCD_LOG_ResetScreen (void);
 /**
 * @}
 */ 
@@ -131,6 +151,11 @@ void LCD_LOG_Init ( void)
   LCD_LOG_DeInit();
   /* Clear the LCD */
   LCD_Clear(Black);  
+#ifdef LCD_LOG_STATS
+  /* Enable the cycle counter used by LCD_LOG_GetStats() */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
 }
 
 /**
@@ -153,6 +178,8 @@ void LCD_LOG_DeInit(void)
   LCD_Lock = DISABLE;
   LCD_Scrolled = DISABLE;
   LCD_ScrollBackStep = 0;
+  
+  LCD_LOG_ResetScreen();
 }
 
 /**
@@ -188,6 +215,7 @@ void LCD_LOG_SetHeader (uint8_t *Title)
   
   /* Clear the LCD */
   LCD_Clear(Black);
+  LCD_LOG_ResetScreen();
     
   /* Set the LCD Font */
   LCD_SetFont (&Font12x12);
@@ -256,9 +284,16 @@ PUTCHAR_PROTOTYPE
   
   sFONT *cFont = LCD_GetFont();
   uint32_t idx;
+#ifdef LCD_LOG_STATS
+  uint32_t start = DWT->CYCCNT;
+#endif
   
   if(LCD_Lock == DISABLE)
   {
+#ifdef LCD_LOG_STATS
+    LCD_LOG_NumChars++;
+#endif
+    
     if((LCD_ScrollActive == ENABLE)||(LCD_ScrollActive == ENABLE))
     {
       LCD_CacheBuffer_yptr_bottom = LCD_CacheBuffer_yptr_bottom_bak;
@@ -318,29 +353,53 @@ PUTCHAR_PROTOTYPE
       }
       
     }
+#ifdef LCD_LOG_STATS
+    LCD_LOG_Cycles += DWT->CYCCNT - start;
+#endif
   }
   return ch;
 }
   
 /**
-* @brief  Update the text area display
+* @brief  Forget the text zone content: it has been cleared
+* @param  None
+* @retval None
+*/
+static void LCD_LOG_ResetScreen (void)
+{
+  uint16_t row;
+  
+  memset(LCD_ScreenLine, ' ', sizeof(LCD_ScreenLine));
+  for (row = 0; row < YWINDOW_SIZE; row++)
+  {
+    LCD_ScreenColor[row] = LCD_LOG_DEFAULT_COLOR;
+  }
+  LCD_ScreenFirst = 0;
+}
+
+/**
+* @brief  Update the text area display: draw the cells which differ from the
+*         displayed ones
 * @param  None
 * @retval None
 */
 static void LCD_LOG_UpdateDisplay (void)
 {
-  uint8_t cnt = 0 ;
-  uint16_t length = 0 ;
-  uint16_t ptr = 0, index = 0;
+  uint16_t length = 0, first = 0, rows = 0;
+  uint16_t row = 0, col = 0, cols = 0, index = 0;
+  uint8_t  ch;
+#ifdef LCD_LOG_HW_SCROLL
+  uint16_t shift = 0;
+#endif
   
   sFONT *cFont = LCD_GetFont();
   
   if((LCD_CacheBuffer_yptr_bottom  < (YWINDOW_SIZE -1)) && 
      (LCD_CacheBuffer_yptr_bottom  >= LCD_CacheBuffer_yptr_top))
   {
-    LCD_SetTextColor(LCD_CacheBuffer[cnt + LCD_CacheBuffer_yptr_bottom].color);
-    LCD_DisplayStringLine ((YWINDOW_MIN + LCD_CacheBuffer_yptr_bottom) * cFont->Height,
-                           (uint8_t *)(LCD_CacheBuffer[cnt + LCD_CacheBuffer_yptr_bottom].line));
+    /* Text zone not full yet: cache line n is on row n */
+    first = 0;
+    rows = LCD_CacheBuffer_yptr_bottom + 1;
   }
   else
   {
@@ -355,22 +414,88 @@ static void LCD_LOG_UpdateDisplay (void)
       length = LCD_CacheBuffer_yptr_bottom;
     }
     
-    ptr = length - YWINDOW_SIZE + 1;
+    first = (length - YWINDOW_SIZE + 1) % LCD_CACHE_DEPTH;
+    rows = YWINDOW_SIZE;
+  }
+  
+#ifdef LCD_LOG_HW_SCROLL
+  /* Move the displayed lines still in the text zone to their new row, the
+     cells then differ only where the lines moved in */
+  shift = (first + LCD_CACHE_DEPTH - LCD_ScreenFirst) % LCD_CACHE_DEPTH;
+  if ((shift != 0) && (shift < YWINDOW_SIZE))
+  {
+    LCD_MoveLines((YWINDOW_MIN + shift) * cFont->Height, YWINDOW_MIN * cFont->Height,
+                  (YWINDOW_SIZE - shift) * cFont->Height);
+    memmove(LCD_ScreenLine[0], LCD_ScreenLine[shift], (YWINDOW_SIZE - shift) * XWINDOW_MAX);
+    memmove(&LCD_ScreenColor[0], &LCD_ScreenColor[shift], (YWINDOW_SIZE - shift) * sizeof(uint16_t));
+  }
+  else if ((shift != 0) && ((LCD_CACHE_DEPTH - shift) < YWINDOW_SIZE))
+  {
+    shift = LCD_CACHE_DEPTH - shift;
+    LCD_MoveLines(YWINDOW_MIN * cFont->Height, (YWINDOW_MIN + shift) * cFont->Height,
+                  (YWINDOW_SIZE - shift) * cFont->Height);
+    memmove(LCD_ScreenLine[shift], LCD_ScreenLine[0], (YWINDOW_SIZE - shift) * XWINDOW_MAX);
+    memmove(&LCD_ScreenColor[shift], &LCD_ScreenColor[0], (YWINDOW_SIZE - shift) * sizeof(uint16_t));
+  }
+#endif
+  LCD_ScreenFirst = first;
+  
+  cols = LCD_PIXEL_WIDTH / cFont->Width;
+  if (cols > XWINDOW_MAX)
+  {
+    cols = XWINDOW_MAX;
+  }
+  
+  for (row = 0 ; row < rows ; row ++)
+  {
+    index = (first + row) % LCD_CACHE_DEPTH;
     
-    for  (cnt = 0 ; cnt < YWINDOW_SIZE ; cnt ++)
+    for (col = 0 ; col < cols ; col ++)
     {
+      ch = LCD_CacheBuffer[index].line[col];
+      /* The fonts only have the printable ASCII characters */
+      if ((ch < ' ') || (ch > '~'))
+      {
+        ch = ' ';
+      }
       
-      index = (cnt + ptr )% LCD_CACHE_DEPTH ;
-      
-      LCD_SetTextColor(LCD_CacheBuffer[index].color);
-      LCD_DisplayStringLine ((cnt + YWINDOW_MIN) * cFont->Height, 
-                             (uint8_t *)(LCD_CacheBuffer[index].line));
-      
+      /* A space does not depend on the text color */
+      if ((ch != LCD_ScreenLine[row][col]) ||
+          ((ch != ' ') && (LCD_CacheBuffer[index].color != LCD_ScreenColor[row])))
+      {
+        LCD_SetTextColor(LCD_CacheBuffer[index].color);
+        LCD_DisplayChar((row + YWINDOW_MIN) * cFont->Height, col * cFont->Width, ch);
+        LCD_ScreenLine[row][col] = ch;
+#ifdef LCD_LOG_STATS
+        LCD_LOG_NumCells++;
+#endif
+      }
     }
+    LCD_ScreenColor[row] = LCD_CacheBuffer[index].color;
   }
-  
 }
 
+#ifdef LCD_LOG_STATS
+/**
+* @brief  Gets the statistics of the log output since the last call, then
+*         resets them.
+* @note   Characters per second: NumChars * SystemCoreClock / Cycles.
+* @param  pNumChars: characters written (printf)
+* @param  pNumCells: character cells drawn on the LCD
+* @param  pCycles: CPU cycles spent in the character output
+* @retval None
+*/
+void LCD_LOG_GetStats(uint32_t *pNumChars, uint32_t *pNumCells, uint32_t *pCycles)
+{
+  *pNumChars = LCD_LOG_NumChars;
+  *pNumCells = LCD_LOG_NumCells;
+  *pCycles   = LCD_LOG_Cycles;
+  LCD_LOG_NumChars = 0;
+  LCD_LOG_NumCells = 0;
+  LCD_LOG_Cycles   = 0;
+}
+#endif /* LCD_LOG_STATS */
+
 #ifdef LCD_SCROLL_ENABLED
 /**
 * @brief  Display previous text frame
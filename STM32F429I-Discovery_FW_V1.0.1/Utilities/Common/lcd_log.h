@@ -126,6 +126,9 @@ void LCD_LOG_DeInit(void);
 void LCD_LOG_SetHeader(uint8_t *Title);
 void LCD_LOG_SetFooter(uint8_t *Status);
 void LCD_LOG_ClearTextZone(void);
+#ifdef LCD_LOG_STATS
+ void LCD_LOG_GetStats(uint32_t *pNumChars, uint32_t *pNumCells, uint32_t *pCycles);
+#endif
 #ifdef LCD_SCROLL_ENABLED
  ErrorStatus LCD_LOG_ScrollBack(void);
  ErrorStatus LCD_LOG_ScrollForward(void);
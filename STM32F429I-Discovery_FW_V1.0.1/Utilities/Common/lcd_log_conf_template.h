@@ -54,6 +54,16 @@
 /* Comment the line below to disable the scroll back and forward features */
 #define LCD_SCROLL_ENABLED
 
+/* Uncomment the line below to scroll the text zone by moving its lines with
+   the LCD_MoveLines() function of the LCD driver (DMA2D boards, ex:
+   stm32f429i_discovery_lcd.c) instead of drawing them again */
+/* #define LCD_LOG_HW_SCROLL */
+
+/* Uncomment the line below to count the written characters, the drawn cells
+   and the CPU cycles of the output (LCD_LOG_GetStats()). The cycles are
+   counted by the DWT cycle counter (Cortex-M3/M4 only) */
+/* #define LCD_LOG_STATS */
+
 /* Define the LCD default text color */
 #define LCD_LOG_DEFAULT_COLOR    LCD_COLOR_WHITE
 
@@ -0,0 +1,953 @@
+/**
+  ******************************************************************************
+  * @file    stm32f429i_discovery_i2c.c
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    28-October-2013
+  * @brief   This file provides an interrupt driven transfer engine for the I2C
+  *          bus shared by the IO Expander (stm32f429i_discovery_ioe.c) and the
+  *          I2C EEPROM (stm32f429i_discovery_i2c_ee.c) drivers.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - The transfers are queued and run one after the other from the
+  *             I2C event and error interrupts: the application never waits
+  *             on the I2C flags. Reads of 2 bytes or more, and writes of
+  *             I2CBUS_DMA_THRESHOLD bytes or more, use the sEE_I2C DMA
+  *             streams.
+  *           - Transfers with the I2CBUS_FLAG_URGENT flag (touch panel) are
+  *             started before the other ones.
+  *           - A transfer with the I2CBUS_FLAG_RETRY_NACK flag whose address
+  *             is not acknowledged goes back to the end of its queue: an
+  *             EEPROM busy with its write cycle is polled between the other
+  *             transfers instead of blocking the bus, or every
+  *             I2CBUS_RETRY_DELAY us when it is alone.
+  *           - A transfer is never started while the STOP condition of the
+  *             previous one is pending: the start is delayed by the
+  *             I2CBUS_TIM timer instead of waiting in interrupt context.
+  *           - The completion callback is called from interrupt context and
+  *             may submit the next transfer.
+  *           - This driver handles the DMA1 Stream2 and Stream4 interrupts
+  *             (sEE_I2C_DMA_RX/TX_IRQHandler), the I2C3 event and error
+  *             interrupts and the TIM7 interrupt.
+  *          ===================================================================
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f429i_discovery_i2c.h"
+
+/** @addtogroup Utilities
+  * @{
+  */
+
+/** @addtogroup STM32F4_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY_I2C
+  * @brief      This file includes the I2C bus transfer engine of STM32F429I Discovery Kit.
+  * @{
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Private_Types
+  * @{
+  */
+/* Transfer phases, each one waits for an I2C event or a DMA interrupt */
+typedef enum
+{
+  I2CBUS_STATE_IDLE = 0,
+  I2CBUS_STATE_START,        /* waiting SB */
+  I2CBUS_STATE_ADDR_TX,      /* waiting ADDR, transmitter */
+  I2CBUS_STATE_TX,           /* register and data bytes on TXE */
+  I2CBUS_STATE_TX_DMA,       /* data bytes by DMA */
+  I2CBUS_STATE_TX_LAST,      /* waiting BTF of the last byte */
+  I2CBUS_STATE_RESTART,      /* waiting SB of the repeated start */
+  I2CBUS_STATE_ADDR_RX,      /* waiting ADDR, receiver */
+  I2CBUS_STATE_RX,           /* single byte on RXNE */
+  I2CBUS_STATE_RX_DMA        /* data bytes by DMA */
+}I2CBus_State_TypeDef;
+
+/* Transfers queue */
+typedef struct
+{
+  I2CBus_Transfer_TypeDef *pHead;
+  I2CBus_Transfer_TypeDef *pTail;
+}I2CBus_Queue_TypeDef;
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Private_Defines
+  * @{
+  */
+/* Delay in us before checking again a pending STOP condition: one SCL period */
+#define I2CBUS_STOP_DELAY     ((1000000 / I2C_SPEED) + 1)
+
+#define I2CBUS_ERROR_FLAGS    (I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR | \
+                               I2C_SR1_PECERR | I2C_SR1_TIMEOUT | I2C_SR1_SMBALERT)
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Private_Macros
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Private_Variables
+  * @{
+  */
+static I2CBus_Queue_TypeDef I2CBus_UrgentQueue = {0, 0};
+static I2CBus_Queue_TypeDef I2CBus_NormalQueue = {0, 0};
+static I2CBus_Transfer_TypeDef * volatile I2CBus_Current = 0;
+static __IO I2CBus_State_TypeDef I2CBus_State = I2CBUS_STATE_IDLE;
+static uint32_t I2CBus_Index = 0;    /* register and data bytes sent */
+static uint8_t  I2CBus_Ready = 0;
+static __IO uint8_t I2CBus_Delayed = 0; /* I2CBUS_TIM running, no start before it expires */
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Private_Function_Prototypes
+  * @{
+  */
+static void I2CBus_Config(void);
+static void I2CBus_TimerConfig(void);
+static void I2CBus_Delay(uint32_t Delay);
+static void I2CBus_Enqueue(I2CBus_Transfer_TypeDef *pTransfer);
+static void I2CBus_StartNext(void);
+static void I2CBus_Finish(I2CBus_Status_TypeDef Status);
+static void I2CBus_Transmit(I2CBus_Transfer_TypeDef *pTransfer);
+static void I2CBus_StopDMA(void);
+static void I2CBus_Cancel(I2CBus_Transfer_TypeDef *pTransfer);
+static uint8_t I2CBus_Unlink(I2CBus_Queue_TypeDef *pQueue, I2CBus_Transfer_TypeDef *pTransfer);
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Initializes the I2C bus: GPIO, DMA streams (sEE_LowLevel_Init()),
+  *         I2C peripheral and interrupts.
+  * @note   Both the IO Expander and the I2C EEPROM drivers call this function,
+  *         only the first call configures the hardware.
+  * @param  None
+  * @retval None
+  */
+void I2CBus_Init(void)
+{
+  NVIC_InitTypeDef NVIC_InitStructure;
+
+  if (I2CBus_Ready != 0)
+  {
+    return;
+  }
+
+  sEE_LowLevel_Init();
+  I2CBus_Config();
+  I2CBus_TimerConfig();
+
+  /* Configure and enable the I2C event and error interrupts, same priority as
+     the DMA streams ones so that the transfer phases never preempt each other */
+  NVIC_InitStructure.NVIC_IRQChannel = I2CBUS_EV_IRQn;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = I2CBUS_PREPRIO;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = I2CBUS_SUBPRIO;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&NVIC_InitStructure);
+
+  NVIC_InitStructure.NVIC_IRQChannel = I2CBUS_ER_IRQn;
+  NVIC_Init(&NVIC_InitStructure);
+
+  NVIC_InitStructure.NVIC_IRQChannel = I2CBUS_TIM_IRQn;
+  NVIC_Init(&NVIC_InitStructure);
+
+  I2CBus_Ready = 1;
+}
+
+/**
+  * @brief  DeInitializes the I2C bus. Pending transfers are completed with
+  *         the I2CBUS_ERROR status.
+  * @param  None
+  * @retval None
+  */
+void I2CBus_DeInit(void)
+{
+  NVIC_InitTypeDef NVIC_InitStructure;
+
+  I2CBus_Reset();
+
+  NVIC_InitStructure.NVIC_IRQChannel = I2CBUS_EV_IRQn;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = I2CBUS_PREPRIO;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = I2CBUS_SUBPRIO;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = DISABLE;
+  NVIC_Init(&NVIC_InitStructure);
+
+  NVIC_InitStructure.NVIC_IRQChannel = I2CBUS_ER_IRQn;
+  NVIC_Init(&NVIC_InitStructure);
+
+  NVIC_InitStructure.NVIC_IRQChannel = I2CBUS_TIM_IRQn;
+  NVIC_Init(&NVIC_InitStructure);
+
+  I2CBUS_TIM->DIER = 0;
+  RCC_APB1PeriphClockCmd(I2CBUS_TIM_CLK, DISABLE);
+
+  sEE_LowLevel_DeInit();
+  I2CBus_Ready = 0;
+}
+
+/**
+  * @brief  Fills each I2CBus_Transfer_TypeDef member with its default value.
+  * @param  pTransfer: pointer to the transfer to initialize.
+  * @retval None
+  */
+void I2CBus_TransferStructInit(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  pTransfer->Address = 0;
+  pTransfer->Flags = 0;
+  pTransfer->RegisterSize = 0;
+  pTransfer->Register = 0;
+  pTransfer->pBuffer = 0;
+  pTransfer->Size = 0;
+  pTransfer->Callback = 0;
+  pTransfer->pContext = 0;
+  pTransfer->Status = I2CBUS_DONE;
+  pTransfer->Retries = 0;
+  pTransfer->pNext = 0;
+}
+
+/**
+  * @brief  Queues a transfer, it is started as soon as the bus is free.
+  * @note   The transfer structure and its buffer must stay valid until the
+  *         Status member leaves I2CBUS_PENDING (the callback is then called).
+  * @param  pTransfer: pointer to the transfer.
+  * @retval I2CBUS_PENDING if the transfer is queued, I2CBUS_ERROR if it is
+  *         invalid or already queued.
+  */
+I2CBus_Status_TypeDef I2CBus_Submit(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  uint32_t primask = 0;
+
+  if ((pTransfer->RegisterSize > 2) ||
+      ((pTransfer->Size != 0) && (pTransfer->pBuffer == 0)) ||
+      ((pTransfer->Size == 0) && ((pTransfer->Flags & I2CBUS_FLAG_READ) != 0)))
+  {
+    return I2CBUS_ERROR;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (pTransfer->Status == I2CBUS_PENDING)
+  {
+    __set_PRIMASK(primask);
+    return I2CBUS_ERROR;
+  }
+
+  pTransfer->Status = I2CBUS_PENDING;
+  pTransfer->Retries = 0;
+  I2CBus_Enqueue(pTransfer);
+  I2CBus_StartNext();
+
+  __set_PRIMASK(primask);
+
+  return I2CBUS_PENDING;
+}
+
+/**
+  * @brief  Waits for the end of a transfer.
+  * @note   If the transfer does not end within I2CBUS_TIMEOUT loops, it is
+  *         aborted with I2CBus_Abort(): the other queued transfers go on.
+  * @param  pTransfer: pointer to the transfer.
+  * @retval Status of the transfer, I2CBUS_TIMEOUT if it was aborted.
+  */
+I2CBus_Status_TypeDef I2CBus_Wait(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  uint32_t timeout = I2CBUS_TIMEOUT;
+
+  while (pTransfer->Status == I2CBUS_PENDING)
+  {
+    if (timeout-- == 0)
+    {
+      I2CBus_Abort(pTransfer);
+      return I2CBUS_TIMEOUT;
+    }
+  }
+
+  return pTransfer->Status;
+}
+
+/**
+  * @brief  Queues a transfer and waits for its end.
+  * @param  pTransfer: pointer to the transfer.
+  * @retval Status of the transfer, I2CBUS_TIMEOUT if it was aborted.
+  */
+I2CBus_Status_TypeDef I2CBus_Execute(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  if (I2CBus_Submit(pTransfer) != I2CBUS_PENDING)
+  {
+    return I2CBUS_ERROR;
+  }
+
+  return I2CBus_Wait(pTransfer);
+}
+
+/**
+  * @brief  Completes a pending transfer with the I2CBUS_ERROR status.
+  * @note   A queued transfer is only removed from its queue. If the transfer
+  *         is in progress, the I2C peripheral is reset and the next queued
+  *         transfer is started: the transfers of the other drivers are kept.
+  * @param  pTransfer: pointer to the transfer.
+  * @retval None
+  */
+void I2CBus_Abort(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  uint32_t primask = 0;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (pTransfer->Status != I2CBUS_PENDING)
+  {
+    /* Already completed */
+    __set_PRIMASK(primask);
+    return;
+  }
+
+  if (pTransfer == I2CBus_Current)
+  {
+    I2CBus_StopDMA();
+    I2C_GenerateSTOP(I2CBUS_I2C, ENABLE);
+    I2C_SoftwareResetCmd(I2CBUS_I2C, ENABLE);
+    I2C_SoftwareResetCmd(I2CBUS_I2C, DISABLE);
+    I2CBus_Config();
+    I2CBus_Current = 0;
+    I2CBus_State = I2CBUS_STATE_IDLE;
+  }
+  else if (I2CBus_Unlink(&I2CBus_UrgentQueue, pTransfer) == 0)
+  {
+    (void)I2CBus_Unlink(&I2CBus_NormalQueue, pTransfer);
+  }
+
+  pTransfer->pNext = 0;
+  I2CBus_Cancel(pTransfer);
+  I2CBus_StartNext();
+
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Checks if the bus has no transfer in progress or queued.
+  * @param  None
+  * @retval 1 if the bus is idle, 0 otherwise.
+  */
+uint8_t I2CBus_IsIdle(void)
+{
+  return ((I2CBus_Current == 0) && (I2CBus_UrgentQueue.pHead == 0) &&
+          (I2CBus_NormalQueue.pHead == 0)) ? 1 : 0;
+}
+
+/**
+  * @brief  Resets the I2C peripheral and completes the current and queued
+  *         transfers with the I2CBUS_ERROR status.
+  * @param  None
+  * @retval None
+  */
+void I2CBus_Reset(void)
+{
+  I2CBus_Transfer_TypeDef *pCurrent = 0, *pUrgent = 0, *pNormal = 0;
+  uint32_t primask = 0;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  I2CBus_StopDMA();
+  I2C_GenerateSTOP(I2CBUS_I2C, ENABLE);
+  I2C_SoftwareResetCmd(I2CBUS_I2C, ENABLE);
+  I2C_SoftwareResetCmd(I2CBUS_I2C, DISABLE);
+  I2CBus_Config();
+  I2CBUS_TIM->CR1 &= (uint16_t)~TIM_CR1_CEN;
+  I2CBUS_TIM->SR = 0;
+  I2CBus_Delayed = 0;
+
+  /* Detach the transfers first: the callbacks may submit new ones */
+  pCurrent = I2CBus_Current;
+  pUrgent = I2CBus_UrgentQueue.pHead;
+  pNormal = I2CBus_NormalQueue.pHead;
+  I2CBus_Current = 0;
+  I2CBus_State = I2CBUS_STATE_IDLE;
+  I2CBus_UrgentQueue.pHead = I2CBus_UrgentQueue.pTail = 0;
+  I2CBus_NormalQueue.pHead = I2CBus_NormalQueue.pTail = 0;
+
+  I2CBus_Cancel(pCurrent);
+  I2CBus_Cancel(pUrgent);
+  I2CBus_Cancel(pNormal);
+
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  This function handles the I2C event interrupt: each call runs the
+  *         next phase of the current transfer.
+  * @param  None
+  * @retval None
+  */
+void I2CBus_EV_IRQHandler(void)
+{
+  I2CBus_Transfer_TypeDef *pTransfer = I2CBus_Current;
+  uint16_t sr1 = I2CBUS_I2C->SR1;
+
+  if (pTransfer == 0)
+  {
+    /* No transfer in progress */
+    I2CBUS_I2C->CR2 &= (uint16_t)~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN);
+    return;
+  }
+
+  switch (I2CBus_State)
+  {
+  case I2CBUS_STATE_START:
+  case I2CBUS_STATE_RESTART:
+    if ((sr1 & I2C_SR1_SB) != 0)
+    {
+      /* Reads without register address are addressed in receiver mode
+         directly, the other transfers start with a write */
+      if ((I2CBus_State == I2CBUS_STATE_RESTART) ||
+          ((pTransfer->RegisterSize == 0) && ((pTransfer->Flags & I2CBUS_FLAG_READ) != 0)))
+      {
+        I2C_Send7bitAddress(I2CBUS_I2C, pTransfer->Address, I2C_Direction_Receiver);
+        I2CBus_State = I2CBUS_STATE_ADDR_RX;
+      }
+      else
+      {
+        I2C_Send7bitAddress(I2CBUS_I2C, pTransfer->Address, I2C_Direction_Transmitter);
+        I2CBus_State = I2CBUS_STATE_ADDR_TX;
+      }
+    }
+    break;
+
+  case I2CBUS_STATE_ADDR_TX:
+    if ((sr1 & I2C_SR1_ADDR) != 0)
+    {
+      /* Clear ADDR by reading SR1 then SR2 (SR1 has already been read) */
+      (void)I2CBUS_I2C->SR2;
+
+      if ((pTransfer->RegisterSize == 0) && (pTransfer->Size == 0))
+      {
+        /* Address probe: the slave acknowledged */
+        I2C_GenerateSTOP(I2CBUS_I2C, ENABLE);
+        I2CBus_Finish(I2CBUS_DONE);
+      }
+      else
+      {
+        I2CBus_State = I2CBUS_STATE_TX;
+        I2CBus_Index = 0;
+        I2CBUS_I2C->CR2 |= I2C_CR2_ITBUFEN;
+      }
+    }
+    break;
+
+  case I2CBUS_STATE_ADDR_RX:
+    if ((sr1 & I2C_SR1_ADDR) != 0)
+    {
+      if (pTransfer->Size == 1)
+      {
+        /* Single byte: NACK and STOP programmed before ADDR is cleared */
+        I2C_AcknowledgeConfig(I2CBUS_I2C, DISABLE);
+        (void)I2CBUS_I2C->SR2;
+        I2C_GenerateSTOP(I2CBUS_I2C, ENABLE);
+        I2CBus_State = I2CBUS_STATE_RX;
+        I2CBUS_I2C->CR2 |= I2C_CR2_ITBUFEN;
+      }
+      else
+      {
+        /* The DMA NACKs the last byte, STOP is sent on transfer complete */
+        sEE_LowLevel_DMAConfig((uint32_t)pTransfer->pBuffer, pTransfer->Size, sEE_DIRECTION_RX);
+        DMA_Cmd(sEE_I2C_DMA_STREAM_RX, ENABLE);
+        I2CBUS_I2C->CR2 |= I2C_CR2_DMAEN | I2C_CR2_LAST;
+        I2CBus_State = I2CBUS_STATE_RX_DMA;
+        (void)I2CBUS_I2C->SR2;
+      }
+    }
+    break;
+
+  case I2CBUS_STATE_TX:
+    if ((sr1 & I2C_SR1_TXE) != 0)
+    {
+      I2CBus_Transmit(pTransfer);
+    }
+    break;
+
+  case I2CBUS_STATE_TX_LAST:
+    if ((sr1 & I2C_SR1_BTF) != 0)
+    {
+      if ((pTransfer->Flags & I2CBUS_FLAG_READ) != 0)
+      {
+        /* Register address sent: restart in receiver mode */
+        I2C_GenerateSTART(I2CBUS_I2C, ENABLE);
+        I2CBus_State = I2CBUS_STATE_RESTART;
+      }
+      else
+      {
+        I2C_GenerateSTOP(I2CBUS_I2C, ENABLE);
+        I2CBus_Finish(I2CBUS_DONE);
+      }
+    }
+    break;
+
+  case I2CBUS_STATE_RX:
+    if ((sr1 & I2C_SR1_RXNE) != 0)
+    {
+      pTransfer->pBuffer[0] = I2C_ReceiveData(I2CBUS_I2C);
+      I2CBus_Finish(I2CBUS_DONE);
+    }
+    break;
+
+  default:
+    /* DMA phases: ended by the DMA interrupts */
+    break;
+  }
+}
+
+/**
+  * @brief  This function handles the I2C error interrupt.
+  * @param  None
+  * @retval None
+  */
+void I2CBus_ER_IRQHandler(void)
+{
+  uint16_t sr1 = I2CBUS_I2C->SR1 & I2CBUS_ERROR_FLAGS;
+
+  /* Clear the error flags (rc_w0 bits) */
+  I2CBUS_I2C->SR1 = (uint16_t)~sr1;
+
+  if (I2CBus_Current == 0)
+  {
+    return;
+  }
+
+  I2CBus_StopDMA();
+
+  if ((sr1 & (I2C_SR1_BERR | I2C_SR1_ARLO)) != 0)
+  {
+    /* Misplaced START/STOP or lost bus: restart the peripheral */
+    I2C_SoftwareResetCmd(I2CBUS_I2C, ENABLE);
+    I2C_SoftwareResetCmd(I2CBUS_I2C, DISABLE);
+    I2CBus_Config();
+    I2CBus_Finish(I2CBUS_ERROR);
+  }
+  else if ((sr1 & I2C_SR1_AF) != 0)
+  {
+    I2C_GenerateSTOP(I2CBUS_I2C, ENABLE);
+    I2CBus_Finish(I2CBUS_NACK);
+  }
+  else
+  {
+    I2C_GenerateSTOP(I2CBUS_I2C, ENABLE);
+    I2CBus_Finish(I2CBUS_ERROR);
+  }
+}
+
+/**
+  * @brief  This function handles the DMA Tx Stream interrupt: the STOP
+  *         condition is generated once the last byte is on the bus (BTF).
+  * @param  None
+  * @retval None
+  */
+void I2CBus_DMA_TX_IRQHandler(void)
+{
+  if (DMA_GetFlagStatus(sEE_I2C_DMA_STREAM_TX, sEE_TX_DMA_FLAG_TCIF) != RESET)
+  {
+    DMA_Cmd(sEE_I2C_DMA_STREAM_TX, DISABLE);
+    DMA_ClearFlag(sEE_I2C_DMA_STREAM_TX, sEE_TX_DMA_FLAG_TCIF);
+    I2CBUS_I2C->CR2 &= (uint16_t)~I2C_CR2_DMAEN;
+
+    if (I2CBus_State == I2CBUS_STATE_TX_DMA)
+    {
+      I2CBus_State = I2CBUS_STATE_TX_LAST;
+    }
+  }
+}
+
+/**
+  * @brief  This function handles the DMA Rx Stream interrupt.
+  * @param  None
+  * @retval None
+  */
+void I2CBus_DMA_RX_IRQHandler(void)
+{
+  if (DMA_GetFlagStatus(sEE_I2C_DMA_STREAM_RX, sEE_RX_DMA_FLAG_TCIF) != RESET)
+  {
+    I2C_GenerateSTOP(I2CBUS_I2C, ENABLE);
+
+    DMA_Cmd(sEE_I2C_DMA_STREAM_RX, DISABLE);
+    DMA_ClearFlag(sEE_I2C_DMA_STREAM_RX, sEE_RX_DMA_FLAG_TCIF);
+
+    if (I2CBus_State == I2CBUS_STATE_RX_DMA)
+    {
+      I2CBus_Finish(I2CBUS_DONE);
+    }
+  }
+}
+
+/**
+  * @brief  This function handles the I2CBUS_TIM interrupt: the delayed
+  *         transfer start is tried again.
+  * @param  None
+  * @retval None
+  */
+void I2CBus_TIM_IRQHandler(void)
+{
+  I2CBUS_TIM->SR = 0;
+  I2CBus_Delayed = 0;
+  I2CBus_StartNext();
+}
+
+/**
+  * @brief  Configures the I2C peripheral, interrupts disabled.
+  * @param  None
+  * @retval None
+  */
+static void I2CBus_Config(void)
+{
+  I2C_InitTypeDef I2C_InitStructure;
+
+  I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
+  I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
+  I2C_InitStructure.I2C_OwnAddress1 = 0x00;
+  I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
+  I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+  I2C_InitStructure.I2C_ClockSpeed = I2C_SPEED;
+  I2C_Init(I2CBUS_I2C, &I2C_InitStructure);
+
+  I2CBUS_I2C->CR2 &= (uint16_t)~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN |
+                                 I2C_CR2_DMAEN | I2C_CR2_LAST);
+  I2C_Cmd(I2CBUS_I2C, ENABLE);
+}
+
+/**
+  * @brief  Configures I2CBUS_TIM as a one pulse timer counting microseconds.
+  * @param  None
+  * @retval None
+  */
+static void I2CBus_TimerConfig(void)
+{
+  RCC_ClocksTypeDef RCC_Clocks;
+  uint32_t clock = 0;
+
+  RCC_APB1PeriphClockCmd(I2CBUS_TIM_CLK, ENABLE);
+
+  /* The APB1 timers run at twice PCLK1 when APB1 is divided */
+  RCC_GetClocksFreq(&RCC_Clocks);
+  clock = RCC_Clocks.PCLK1_Frequency;
+  if (clock != RCC_Clocks.HCLK_Frequency)
+  {
+    clock *= 2;
+  }
+
+  /* Only the counter overflow sets the update flag, not UG */
+  I2CBUS_TIM->CR1 = TIM_CR1_OPM | TIM_CR1_URS;
+  I2CBUS_TIM->PSC = (uint16_t)((clock / 1000000) - 1);
+  I2CBUS_TIM->EGR = TIM_EGR_UG;
+  I2CBUS_TIM->SR = 0;
+  I2CBUS_TIM->DIER = TIM_DIER_UIE;
+}
+
+/**
+  * @brief  Delays the next transfer start.
+  * @note   Called with the I2C interrupts masked.
+  * @param  Delay: delay in us, from 1 to 65535.
+  * @retval None
+  */
+static void I2CBus_Delay(uint32_t Delay)
+{
+  I2CBus_Delayed = 1;
+  I2CBUS_TIM->ARR = (uint16_t)Delay;
+  I2CBUS_TIM->CNT = 0;
+  I2CBUS_TIM->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+  * @brief  Adds a transfer at the end of its queue.
+  * @param  pTransfer: pointer to the transfer.
+  * @retval None
+  */
+static void I2CBus_Enqueue(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  I2CBus_Queue_TypeDef *pQueue = &I2CBus_NormalQueue;
+
+  if ((pTransfer->Flags & I2CBUS_FLAG_URGENT) != 0)
+  {
+    pQueue = &I2CBus_UrgentQueue;
+  }
+
+  pTransfer->pNext = 0;
+  if (pQueue->pTail != 0)
+  {
+    pQueue->pTail->pNext = pTransfer;
+  }
+  else
+  {
+    pQueue->pHead = pTransfer;
+  }
+  pQueue->pTail = pTransfer;
+}
+
+/**
+  * @brief  Starts the first queued transfer if the bus is free.
+  * @note   Called with the I2C interrupts masked (interrupt context or
+  *         critical section). If the STOP condition of the previous transfer
+  *         is still pending, the start is delayed by I2CBUS_STOP_DELAY.
+  * @param  None
+  * @retval None
+  */
+static void I2CBus_StartNext(void)
+{
+  I2CBus_Queue_TypeDef *pQueue = &I2CBus_UrgentQueue;
+  I2CBus_Transfer_TypeDef *pTransfer = 0;
+
+  if ((I2CBus_Current != 0) || (I2CBus_Delayed != 0))
+  {
+    return;
+  }
+
+  if (pQueue->pHead == 0)
+  {
+    pQueue = &I2CBus_NormalQueue;
+  }
+  pTransfer = pQueue->pHead;
+  if (pTransfer == 0)
+  {
+    return;
+  }
+
+  /* No write access to CR1 before the STOP bit is cleared */
+  if ((I2CBUS_I2C->CR1 & I2C_CR1_STOP) != 0)
+  {
+    I2CBus_Delay(I2CBUS_STOP_DELAY);
+    return;
+  }
+
+  pQueue->pHead = pTransfer->pNext;
+  if (pQueue->pHead == 0)
+  {
+    pQueue->pTail = 0;
+  }
+  pTransfer->pNext = 0;
+
+  I2CBus_Current = pTransfer;
+  I2CBus_State = I2CBUS_STATE_START;
+  I2CBus_Index = 0;
+
+  I2C_AcknowledgeConfig(I2CBUS_I2C, ENABLE);
+  I2CBUS_I2C->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+  I2C_GenerateSTART(I2CBUS_I2C, ENABLE);
+}
+
+/**
+  * @brief  Ends the current transfer and starts the next one.
+  * @param  Status: status of the transfer.
+  * @retval None
+  */
+static void I2CBus_Finish(I2CBus_Status_TypeDef Status)
+{
+  I2CBus_Transfer_TypeDef *pTransfer = I2CBus_Current;
+
+  I2CBUS_I2C->CR2 &= (uint16_t)~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN |
+                                 I2C_CR2_DMAEN | I2C_CR2_LAST);
+  I2C_AcknowledgeConfig(I2CBUS_I2C, ENABLE);
+  I2CBus_Current = 0;
+  I2CBus_State = I2CBUS_STATE_IDLE;
+
+  /* A slave busy on the address phase (no byte sent yet) is polled again
+     after the other transfers, or after I2CBUS_RETRY_DELAY if there are none */
+  if ((Status == I2CBUS_NACK) && ((pTransfer->Flags & I2CBUS_FLAG_RETRY_NACK) != 0) &&
+      (I2CBus_Index == 0) && (pTransfer->Retries < I2CBUS_MAX_RETRIES))
+  {
+    pTransfer->Retries++;
+    I2CBus_Enqueue(pTransfer);
+    if ((I2CBus_UrgentQueue.pHead == pTransfer) ||
+        ((I2CBus_UrgentQueue.pHead == 0) && (I2CBus_NormalQueue.pHead == pTransfer)))
+    {
+      I2CBus_Delay(I2CBUS_RETRY_DELAY);
+    }
+  }
+  else
+  {
+    pTransfer->Status = Status;
+    if (pTransfer->Callback != 0)
+    {
+      pTransfer->Callback(pTransfer);
+    }
+  }
+
+  I2CBus_StartNext();
+}
+
+/**
+  * @brief  Sends the next register or data byte of the current transfer.
+  * @param  pTransfer: pointer to the current transfer.
+  * @retval None
+  */
+static void I2CBus_Transmit(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  uint32_t data = 0;
+
+  if (I2CBus_Index < pTransfer->RegisterSize)
+  {
+    /* Register address, MSB first */
+    I2C_SendData(I2CBUS_I2C, (uint8_t)(pTransfer->Register >> (8 * (pTransfer->RegisterSize - 1 - I2CBus_Index))));
+    I2CBus_Index++;
+    return;
+  }
+
+  data = I2CBus_Index - pTransfer->RegisterSize;
+
+  if (((pTransfer->Flags & I2CBUS_FLAG_READ) != 0) || (data == pTransfer->Size))
+  {
+    /* Last byte written in DR: wait for BTF */
+    I2CBUS_I2C->CR2 &= (uint16_t)~I2C_CR2_ITBUFEN;
+    I2CBus_State = I2CBUS_STATE_TX_LAST;
+  }
+  else if ((data == 0) && (pTransfer->Size >= I2CBUS_DMA_THRESHOLD))
+  {
+    I2CBUS_I2C->CR2 &= (uint16_t)~I2C_CR2_ITBUFEN;
+    sEE_LowLevel_DMAConfig((uint32_t)pTransfer->pBuffer, pTransfer->Size, sEE_DIRECTION_TX);
+    I2CBus_State = I2CBUS_STATE_TX_DMA;
+    DMA_Cmd(sEE_I2C_DMA_STREAM_TX, ENABLE);
+    I2CBUS_I2C->CR2 |= I2C_CR2_DMAEN;
+  }
+  else
+  {
+    I2C_SendData(I2CBUS_I2C, pTransfer->pBuffer[data]);
+    I2CBus_Index++;
+  }
+}
+
+/**
+  * @brief  Stops the DMA streams and clears their flags.
+  * @param  None
+  * @retval None
+  */
+static void I2CBus_StopDMA(void)
+{
+  I2CBUS_I2C->CR2 &= (uint16_t)~(I2C_CR2_DMAEN | I2C_CR2_LAST);
+
+  DMA_Cmd(sEE_I2C_DMA_STREAM_TX, DISABLE);
+  DMA_Cmd(sEE_I2C_DMA_STREAM_RX, DISABLE);
+  DMA_ClearFlag(sEE_I2C_DMA_STREAM_TX, sEE_TX_DMA_FLAG_FEIF | sEE_TX_DMA_FLAG_DMEIF | sEE_TX_DMA_FLAG_TEIF |
+                                       sEE_TX_DMA_FLAG_HTIF | sEE_TX_DMA_FLAG_TCIF);
+  DMA_ClearFlag(sEE_I2C_DMA_STREAM_RX, sEE_RX_DMA_FLAG_FEIF | sEE_RX_DMA_FLAG_DMEIF | sEE_RX_DMA_FLAG_TEIF |
+                                       sEE_RX_DMA_FLAG_HTIF | sEE_RX_DMA_FLAG_TCIF);
+}
+
+/**
+  * @brief  Removes a transfer from a queue.
+  * @param  pQueue: pointer to the queue.
+  * @param  pTransfer: pointer to the transfer.
+  * @retval 1 if the transfer was in the queue, 0 otherwise.
+  */
+static uint8_t I2CBus_Unlink(I2CBus_Queue_TypeDef *pQueue, I2CBus_Transfer_TypeDef *pTransfer)
+{
+  I2CBus_Transfer_TypeDef *pPrevious = 0, *pItem = pQueue->pHead;
+
+  while ((pItem != 0) && (pItem != pTransfer))
+  {
+    pPrevious = pItem;
+    pItem = pItem->pNext;
+  }
+  if (pItem == 0)
+  {
+    return 0;
+  }
+
+  if (pPrevious != 0)
+  {
+    pPrevious->pNext = pTransfer->pNext;
+  }
+  else
+  {
+    pQueue->pHead = pTransfer->pNext;
+  }
+  if (pQueue->pTail == pTransfer)
+  {
+    pQueue->pTail = pPrevious;
+  }
+  return 1;
+}
+
+/**
+  * @brief  Completes a list of transfers with the I2CBUS_ERROR status.
+  * @param  pTransfer: first transfer of the list, may be 0.
+  * @retval None
+  */
+static void I2CBus_Cancel(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  I2CBus_Transfer_TypeDef *pNext = 0;
+
+  while (pTransfer != 0)
+  {
+    pNext = pTransfer->pNext;
+    pTransfer->pNext = 0;
+    pTransfer->Status = I2CBUS_ERROR;
+    if (pTransfer->Callback != 0)
+    {
+      pTransfer->Callback(pTransfer);
+    }
+    pTransfer = pNext;
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
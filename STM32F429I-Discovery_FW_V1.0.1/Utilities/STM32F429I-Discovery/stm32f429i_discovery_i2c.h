@@ -0,0 +1,212 @@
+/**
+  ******************************************************************************
+  * @file    stm32f429i_discovery_i2c.h
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    28-October-2013
+  * @brief   This file contains all the functions prototypes for
+  *          the stm32f429i_discovery_i2c.c firmware driver.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F429I_DISCOVERY_I2C_H
+#define __STM32F429I_DISCOVERY_I2C_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f429i_discovery.h"
+
+/** @addtogroup Utilities
+  * @{
+  */
+
+/** @addtogroup STM32F4_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY_I2C
+  * @{
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Exported_Types
+  * @{
+  */
+
+/**
+  * @brief  I2C transfer status
+  */
+typedef enum
+{
+  I2CBUS_DONE = 0,
+  I2CBUS_PENDING,
+  I2CBUS_NACK,               /* address or data not acknowledged */
+  I2CBUS_ERROR,              /* bus error, arbitration lost or bus reset */
+  I2CBUS_TIMEOUT             /* returned by I2CBus_Wait() only */
+}I2CBus_Status_TypeDef;
+
+typedef struct I2CBus_TransferStruct I2CBus_Transfer_TypeDef;
+
+/**
+  * @brief  I2C transfer completion callback, called from interrupt context
+  */
+typedef void (*I2CBus_Callback_TypeDef)(I2CBus_Transfer_TypeDef *pTransfer);
+
+/**
+  * @brief  I2C transfer: owned by the caller until its Status leaves I2CBUS_PENDING
+  */
+struct I2CBus_TransferStruct
+{
+  uint8_t  Address;          /* 8-bit slave address, R/W bit cleared */
+  uint8_t  Flags;            /* combination of I2CBUS_FLAG_xxx */
+  uint8_t  RegisterSize;     /* register address bytes sent first: 0, 1 or 2 */
+  uint16_t Register;         /* register address, sent MSB first */
+  uint8_t  *pBuffer;
+  uint16_t Size;             /* data bytes, 0 for an address probe */
+  I2CBus_Callback_TypeDef Callback; /* may be 0 */
+  void     *pContext;        /* free for the caller */
+  __IO I2CBus_Status_TypeDef Status;
+  uint16_t Retries;          /* private */
+  I2CBus_Transfer_TypeDef *pNext; /* private */
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Exported_Constants
+  * @{
+  */
+
+/**
+  * @brief  I2C transfer flags
+  */
+#define I2CBUS_FLAG_READ          0x01   /* read Size bytes, after the register address if any */
+#define I2CBUS_FLAG_URGENT        0x02   /* queued ahead of the other transfers */
+#define I2CBUS_FLAG_RETRY_NACK    0x04   /* address NACK: retried at the end of the queue,
+                                            I2CBUS_RETRY_DELAY later if it is alone */
+
+/**
+  * @brief  I2C bus interrupts, the DMA streams are the sEE_I2C ones
+  */
+#define I2CBUS_I2C                I2C3
+#define I2CBUS_EV_IRQn            I2C3_EV_IRQn
+#define I2CBUS_ER_IRQn            I2C3_ER_IRQn
+#define I2CBus_EV_IRQHandler      I2C3_EV_IRQHandler
+#define I2CBus_ER_IRQHandler      I2C3_ER_IRQHandler
+#define I2CBus_DMA_TX_IRQHandler  sEE_I2C_DMA_TX_IRQHandler
+#define I2CBus_DMA_RX_IRQHandler  sEE_I2C_DMA_RX_IRQHandler
+#define I2CBUS_PREPRIO            sEE_I2C_DMA_PREPRIO
+#define I2CBUS_SUBPRIO            sEE_I2C_DMA_SUBPRIO
+
+/**
+  * @brief  Basic timer delaying the transfer starts (STOP condition still
+  *         pending, address NACK retries), same interrupt priority
+  */
+#define I2CBUS_TIM                TIM7
+#define I2CBUS_TIM_CLK            RCC_APB1Periph_TIM7
+#define I2CBUS_TIM_IRQn           TIM7_IRQn
+#define I2CBus_TIM_IRQHandler     TIM7_IRQHandler
+
+/* Data bytes from which a write uses the DMA (reads of 2 bytes or more
+   always do) */
+#ifndef I2CBUS_DMA_THRESHOLD
+ #define I2CBUS_DMA_THRESHOLD     4
+#endif /* I2CBUS_DMA_THRESHOLD */
+
+/* Delay in us before an address NACK retry when no other transfer is queued */
+#ifndef I2CBUS_RETRY_DELAY
+ #define I2CBUS_RETRY_DELAY       100
+#endif /* I2CBUS_RETRY_DELAY */
+
+/* Maximum number of address NACK retries (EEPROM write cycle polling) */
+#ifndef I2CBUS_MAX_RETRIES
+ #define I2CBUS_MAX_RETRIES       300
+#endif /* I2CBUS_MAX_RETRIES */
+
+/* Waiting loop of I2CBus_Wait(), the transfer is aborted when it expires. Like the
+   drivers timeouts it is not accurate, it only guarantees that the
+   application will not remain stuck on a corrupted communication */
+#ifndef I2CBUS_TIMEOUT
+ #define I2CBUS_TIMEOUT           ((uint32_t)0x400000)
+#endif /* I2CBUS_TIMEOUT */
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Exported_Macros
+  * @{
+  */
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_Exported_Functions
+  * @{
+  */
+void                  I2CBus_Init(void);
+void                  I2CBus_DeInit(void);
+void                  I2CBus_TransferStructInit(I2CBus_Transfer_TypeDef *pTransfer);
+I2CBus_Status_TypeDef I2CBus_Submit(I2CBus_Transfer_TypeDef *pTransfer);
+I2CBus_Status_TypeDef I2CBus_Wait(I2CBus_Transfer_TypeDef *pTransfer);
+I2CBus_Status_TypeDef I2CBus_Execute(I2CBus_Transfer_TypeDef *pTransfer);
+void                  I2CBus_Abort(I2CBus_Transfer_TypeDef *pTransfer);
+uint8_t               I2CBus_IsIdle(void);
+void                  I2CBus_Reset(void);
+void                  I2CBus_EV_IRQHandler(void);
+void                  I2CBus_ER_IRQHandler(void);
+void                  I2CBus_DMA_TX_IRQHandler(void);
+void                  I2CBus_DMA_RX_IRQHandler(void);
+void                  I2CBus_TIM_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F429I_DISCOVERY_I2C_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
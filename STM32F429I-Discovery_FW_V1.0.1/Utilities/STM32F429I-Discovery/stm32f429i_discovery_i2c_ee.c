@@ -26,9 +26,15 @@
   *          by just adapting the defines for hardware resources and 
   *          sEE_LowLevel_Init() function. 
   *        
-  *          @note In this driver, basic read and write functions (sEE_ReadBuffer() 
-  *                and sEE_WritePage()) use Polling mode to perform the data transfer 
-  *                to/from EEPROM memory.
+  *          @note In this driver, the read and write functions queue transfers
+  *                on the I2C bus engine (stm32f429i_discovery_i2c.c) shared with
+  *                the IO Expander driver: sEE_ReadBuffer(), sEE_WritePage() and
+  *                sEE_WriteBufferAsync() return immediately and the transfers
+  *                run from the I2C and DMA interrupts. While the EEPROM is busy
+  *                with its write cycle it is polled between the other transfers.
+  *                sEE_WaitRead() and sEE_WaitWrite() wait for the end of the
+  *                transfers and abort them on timeout, so that a buffer on the
+  *                stack is never written after the caller returned.
   *             
   *     +-----------------------------------------------------------------+
   *     |               Pin assignment for M24LR64 EEPROM                 |
@@ -113,10 +119,17 @@
   * @{
   */
 __IO uint16_t  sEEAddress = 0;   
-__IO uint32_t  sEETimeout = sEE_LONG_TIMEOUT;   
 __IO uint16_t* sEEDataReadPointer;   
 __IO uint8_t*  sEEDataWritePointer;  
-__IO uint8_t   sEEDataNum;
+
+static I2CBus_Transfer_TypeDef sEEReadTransfer;
+static I2CBus_Transfer_TypeDef sEEWriteTransfer;
+
+/* sEE_WriteBufferAsync() progress */
+static uint8_t*       sEEWriteBufferPointer;
+static uint16_t       sEEWriteAddress;
+static __IO uint16_t  sEEWriteRemaining;
+static __IO uint16_t* sEEWriteCountPointer;
 /**
   * @}
   */ 
@@ -125,6 +138,10 @@ __IO uint8_t   sEEDataNum;
 /** @defgroup STM32F429I_DISCOVERY_I2C_EE_Private_Function_Prototypes
   * @{
   */ 
+static uint32_t sEE_WriteNextPage(void);
+static void     sEE_ReadCallback(I2CBus_Transfer_TypeDef *pTransfer);
+static void     sEE_WritePageCallback(I2CBus_Transfer_TypeDef *pTransfer);
+static void     sEE_WriteBufferCallback(I2CBus_Transfer_TypeDef *pTransfer);
 /**
   * @}
   */ 
@@ -141,7 +158,7 @@ __IO uint8_t   sEEDataNum;
   */
 void sEE_DeInit(void)
 {
-  sEE_LowLevel_DeInit(); 
+  I2CBus_DeInit(); 
 }
 
 /**
@@ -151,31 +168,11 @@ void sEE_DeInit(void)
   */
 void sEE_Init(void)
 { 
-  I2C_InitTypeDef  I2C_InitStructure;
-  
-  sEE_LowLevel_Init();
-
-  /* If the I2C peripheral is already enabled, don't reconfigure it */
-  if ((sEE_I2C->CR1 & I2C_CR1_PE) == 0)
-  {     
-    /*!< I2C configuration */
-    /* sEE_I2C configuration */
-    I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
-    I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
-    I2C_InitStructure.I2C_OwnAddress1 = 0x00;
-    I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
-    I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
-    I2C_InitStructure.I2C_ClockSpeed = I2C_SPEED;
-    
-    /* Apply sEE_I2C configuration after enabling it */
-    I2C_Init(sEE_I2C, &I2C_InitStructure);
-  
-    /* sEE_I2C Peripheral Enable */
-    I2C_Cmd(sEE_I2C, ENABLE);
-  }  
+  /* The I2C bus may already be configured by the IO Expander driver */
+  I2CBus_Init();
 
-  /* Enable the sEE_I2C peripheral DMA requests */
-  I2C_DMACmd(sEE_I2C, ENABLE);  
+  I2CBus_TransferStructInit(&sEEReadTransfer);
+  I2CBus_TransferStructInit(&sEEWriteTransfer);
 
   /*!< Select the EEPROM address */
   sEEAddress = sEE_HW_ADDRESS;   
@@ -193,147 +190,84 @@ void sEE_Init(void)
   *              data are read from the EEPROM. Application should monitor this 
   *              variable in order know when the transfer is complete.
   * 
-  * @note When number of data to be read is higher than 1, this function just 
-  *       configures the communication and enable the DMA channel to transfer data.
-  *       Meanwhile, the user application may perform other tasks.
-  *       When number of data to be read is 1, then the DMA is not used. The byte
-  *       is read in polling mode.
+  * @note This function just queues the transfer on the I2C bus, meanwhile the
+  *       user application may perform other tasks. If the EEPROM is still busy
+  *       with a write cycle, the read starts when it acknowledges its address.
   * 
-  * @retval sEE_OK (0) if operation is correctly performed, else return value 
-  *         different from sEE_OK (0) or the timeout user callback.
+  * @retval sEE_OK (0) if the transfer is queued, sEE_FAIL if the previous read
+  *         is still in progress.
   */
 uint32_t sEE_ReadBuffer(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t* NumByteToRead)
 {  
-  /* Set the pointer to the Number of data to be read. This pointer will be used 
-      by the DMA Transfer Completer interrupt Handler in order to reset the 
-      variable to 0. User should check on this variable in order to know if the 
-      DMA transfer has been complete or not. */
-  sEEDataReadPointer = NumByteToRead;
-  
-  /*!< While the bus is busy */
-  sEETimeout = sEE_LONG_TIMEOUT;
-  while(I2C_GetFlagStatus(sEE_I2C, I2C_FLAG_BUSY))
+  if (sEEReadTransfer.Status == I2CBUS_PENDING)
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+    return sEE_FAIL;
   }
   
-  /*!< Send START condition */
-  I2C_GenerateSTART(sEE_I2C, ENABLE);
+  /* Set the pointer to the Number of data to be read. This pointer will be used 
+      by the transfer completion callback in order to reset the variable to 0.
+      User should check on this variable in order to know if the transfer has
+      been complete or not. */
+  sEEDataReadPointer = NumByteToRead;
+  
+  sEEReadTransfer.Address = (uint8_t)sEEAddress;
+  sEEReadTransfer.Flags = I2CBUS_FLAG_READ | I2CBUS_FLAG_RETRY_NACK;
+  sEEReadTransfer.RegisterSize = 2;
+  sEEReadTransfer.Register = ReadAddr;
+  sEEReadTransfer.pBuffer = pBuffer;
+  sEEReadTransfer.Size = *NumByteToRead;
+  sEEReadTransfer.Callback = sEE_ReadCallback;
   
-  /*!< Test on EV5 and clear it (cleared by reading SR1 then writing to DR) */
-  sEETimeout = sEE_FLAG_TIMEOUT;
-  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_MODE_SELECT))
+  if (I2CBus_Submit(&sEEReadTransfer) != I2CBUS_PENDING)
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+    return sEE_FAIL;
   }
   
-  /*!< Send EEPROM address for write */
-  I2C_Send7bitAddress(sEE_I2C, sEEAddress, I2C_Direction_Transmitter);
-
-  /*!< Test on EV6 and clear it */
-  sEETimeout = sEE_FLAG_TIMEOUT;
-  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED))
-  {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-  } 
-
-  /*!< Send the EEPROM's internal address to read from: MSB of the address first */
-  I2C_SendData(sEE_I2C, (uint8_t)((ReadAddr & 0xFF00) >> 8));    
+  /* If all operations OK, return sEE_OK (0) */
+  return sEE_OK;
+}
 
-  /*!< Test on EV8 and clear it */
-  sEETimeout = sEE_FLAG_TIMEOUT;
-  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_BYTE_TRANSMITTING))
+/**
+  * @brief  Returns the state of the sEE_ReadBuffer() transfer.
+  * @param  None
+  * @retval sEE_BUSY while reading, sEE_OK if the last read succeeded, 
+  *         sEE_FAIL otherwise.
+  */
+uint32_t sEE_GetReadStatus(void)
+{
+  switch (sEEReadTransfer.Status)
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+  case I2CBUS_PENDING:
+    return sEE_BUSY;
+  case I2CBUS_DONE:
+    return sEE_OK;
+  default:
+    return sEE_FAIL;
   }
+}
 
-  /*!< Send the EEPROM's internal address to read from: LSB of the address */
-  I2C_SendData(sEE_I2C, (uint8_t)(ReadAddr & 0x00FF));    
-
-  /*!< Test on EV8 and clear it */
-  sEETimeout = sEE_FLAG_TIMEOUT;
-  while(I2C_GetFlagStatus(sEE_I2C, I2C_FLAG_BTF) == RESET)
-  {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-  }
-  
-  /*!< Send STRAT condition a second time */  
-  I2C_GenerateSTART(sEE_I2C, ENABLE);
-  
-  /*!< Test on EV5 and clear it (cleared by reading SR1 then writing to DR) */
-  sEETimeout = sEE_FLAG_TIMEOUT;
-  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_MODE_SELECT))
-  {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-  } 
-  
-  /*!< Send EEPROM address for read */
-  I2C_Send7bitAddress(sEE_I2C, sEEAddress, I2C_Direction_Receiver);  
+/**
+  * @brief  Waits for the end of the sEE_ReadBuffer() transfer.
+  * @note   The function returns as soon as the read ends, with an error or
+  *         not. When the I2CBUS_TIMEOUT loop expires the read is aborted: the
+  *         buffer is no longer written once this function returned.
+  * @param  None
+  * @retval sEE_OK if the read succeeded, sEE_FAIL otherwise.
+  */
+uint32_t sEE_WaitRead(void)
+{
+  uint32_t timeout = I2CBUS_TIMEOUT;
   
-  /* If number of data to be read is 1, then DMA couldn't be used */
-  /* One Byte Master Reception procedure (POLLING) ---------------------------*/
-  if ((uint16_t)(*NumByteToRead) < 2)
+  while (sEEReadTransfer.Status == I2CBUS_PENDING)
   {
-    /* Wait on ADDR flag to be set (ADDR is still not cleared at this level */
-    sEETimeout = sEE_FLAG_TIMEOUT;
-    while(I2C_GetFlagStatus(sEE_I2C, I2C_FLAG_ADDR) == RESET)
-    {
-      if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-    }     
-    
-    /*!< Disable Acknowledgement */
-    I2C_AcknowledgeConfig(sEE_I2C, DISABLE);   
-    
-    /* Clear ADDR register by reading SR1 then SR2 register (SR1 has already been read) */
-    (void)sEE_I2C->SR2;
-    
-    /*!< Send STOP Condition */
-    I2C_GenerateSTOP(sEE_I2C, ENABLE);
-    
-    /* Wait for the byte to be received */
-    sEETimeout = sEE_FLAG_TIMEOUT;
-    while(I2C_GetFlagStatus(sEE_I2C, I2C_FLAG_RXNE) == RESET)
+    if (timeout-- == 0)
     {
-      if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+      I2CBus_Abort(&sEEReadTransfer);
+      break;
     }
-    
-    /*!< Read the byte received from the EEPROM */
-    *pBuffer = I2C_ReceiveData(sEE_I2C);
-    
-    /*!< Decrement the read bytes counter */
-    (uint16_t)(*NumByteToRead)--;        
-    
-    /* Wait to make sure that STOP control bit has been cleared */
-    sEETimeout = sEE_FLAG_TIMEOUT;
-    while(sEE_I2C->CR1 & I2C_CR1_STOP)
-    {
-      if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-    }  
-    
-    /*!< Re-Enable Acknowledgement to be ready for another reception */
-    I2C_AcknowledgeConfig(sEE_I2C, ENABLE);    
-  }
-  else/* More than one Byte Master Reception procedure (DMA) -----------------*/
-  {
-    /*!< Test on EV6 and clear it */
-    sEETimeout = sEE_FLAG_TIMEOUT;
-    while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED))
-    {
-      if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-    }  
-    
-    /* Configure the DMA Rx Channel with the buffer address and the buffer size */
-    sEE_LowLevel_DMAConfig((uint32_t)pBuffer, (uint16_t)(*NumByteToRead), sEE_DIRECTION_RX);
-    
-    /* Inform the DMA that the next End Of Transfer Signal will be the last one */
-    I2C_DMALastTransferCmd(sEE_I2C, ENABLE); 
-    
-    /* Enable the DMA Rx Stream */
-    DMA_Cmd(sEE_I2C_DMA_STREAM_RX, ENABLE);    
   }
   
-  /* If all operations OK, return sEE_OK (0) */
-  return sEE_OK;
+  return (sEEReadTransfer.Status == I2CBUS_DONE) ? sEE_OK : sEE_FAIL;
 }
 
 /**
@@ -356,250 +290,165 @@ uint32_t sEE_ReadBuffer(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t* NumByteTo
   *              data are written to the EEPROM. Application should monitor this 
   *              variable in order know when the transfer is complete.
   * 
-  * @note This function just configure the communication and enable the DMA 
-  *       channel to transfer data. Meanwhile, the user application may perform 
-  *       other tasks in parallel.
+  * @note This function just queues the transfer on the I2C bus, meanwhile the
+  *       user application may perform other tasks in parallel. If the EEPROM
+  *       is still busy with a write cycle, the page is written when it
+  *       acknowledges its address.
   * 
-  * @retval sEE_OK (0) if operation is correctly performed, else return value 
-  *         different from sEE_OK (0) or the timeout user callback.
+  * @retval sEE_OK (0) if the transfer is queued, sEE_FAIL if a write is still 
+  *         in progress.
   */
 uint32_t sEE_WritePage(uint8_t* pBuffer, uint16_t WriteAddr, uint8_t* NumByteToWrite)
 { 
+  if (sEEWriteTransfer.Status == I2CBUS_PENDING)
+  {
+    return sEE_FAIL;
+  }
+  
   /* Set the pointer to the Number of data to be written. This pointer will be used 
-      by the DMA Transfer Completer interrupt Handler in order to reset the 
-      variable to 0. User should check on this variable in order to know if the 
-      DMA transfer has been complete or not. */
+      by the transfer completion callback in order to reset the variable to 0.
+      User should check on this variable in order to know if the transfer has
+      been complete or not. */
   sEEDataWritePointer = NumByteToWrite;  
   
-  /*!< While the bus is busy */
-  sEETimeout = sEE_LONG_TIMEOUT;
-  while(I2C_GetFlagStatus(sEE_I2C, I2C_FLAG_BUSY))
+  sEEWriteTransfer.Address = (uint8_t)sEEAddress;
+  sEEWriteTransfer.Flags = I2CBUS_FLAG_RETRY_NACK;
+  sEEWriteTransfer.RegisterSize = 2;
+  sEEWriteTransfer.Register = WriteAddr;
+  sEEWriteTransfer.pBuffer = pBuffer;
+  sEEWriteTransfer.Size = *NumByteToWrite;
+  sEEWriteTransfer.Callback = sEE_WritePageCallback;
+  
+  if (I2CBus_Submit(&sEEWriteTransfer) != I2CBUS_PENDING)
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+    return sEE_FAIL;
   }
   
-  /*!< Send START condition */
-  I2C_GenerateSTART(sEE_I2C, ENABLE);
+  /* If all operations OK, return sEE_OK (0) */
+  return sEE_OK;
+}
+
+/**
+  * @brief  Writes buffer of data to the I2C EEPROM.
+  * @note   This function waits for the end of the transfers: while the EEPROM
+  *         is busy with a page write cycle, the other I2C transfers (touch
+  *         panel) keep going in the background.
+  * @param  pBuffer : pointer to the buffer  containing the data to be written 
+  *         to the EEPROM.
+  * @param  WriteAddr : EEPROM's internal address to write to.
+  * @param  NumByteToWrite : number of bytes to write to the EEPROM.
+  * @retval None
+  */
+void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite)
+{
+  __IO uint16_t NumByteLeft = NumByteToWrite;
   
-  /*!< Test on EV5 and clear it */
-  sEETimeout = sEE_FLAG_TIMEOUT;
-  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_MODE_SELECT))
+  /* End of a background write first */
+  sEE_WaitWrite();
+  
+  if (sEE_WriteBufferAsync(pBuffer, WriteAddr, (uint16_t*)(&NumByteLeft)) != sEE_OK)
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+    sEE_TIMEOUT_UserCallback();
+    return;
   }
   
-  /*!< Send EEPROM address for write */
-  sEETimeout = sEE_FLAG_TIMEOUT;
-  I2C_Send7bitAddress(sEE_I2C, sEEAddress, I2C_Direction_Transmitter);
-
-  /*!< Test on EV6 and clear it */
-  sEETimeout = sEE_FLAG_TIMEOUT;
-  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED))
+  /* Each page completion queues the next page */
+  if ((sEE_WaitWrite() != sEE_OK) || (NumByteLeft > 0))
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+    sEE_TIMEOUT_UserCallback();
+    return;
   }
   
-  /*!< Send the EEPROM's internal address to write to : MSB of the address first */
-  I2C_SendData(sEE_I2C, (uint8_t)((WriteAddr & 0xFF00) >> 8));
+  sEE_WaitEepromStandbyState();
+}
 
-  /*!< Test on EV8 and clear it */
-  sEETimeout = sEE_FLAG_TIMEOUT;  
-  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_BYTE_TRANSMITTING))
+/**
+  * @brief  Writes buffer of data to the I2C EEPROM without waiting.
+  * @note   The buffer is split on the EEPROM page boundaries, each page 
+  *         completion queues the next page. The buffer must stay valid until 
+  *         the end of the transfer.
+  * @param  pBuffer : pointer to the buffer  containing the data to be written 
+  *         to the EEPROM.
+  * @param  WriteAddr : EEPROM's internal address to write to.
+  * @param  NumByteToWrite : pointer to the variable holding number of bytes to 
+  *         be written into the EEPROM. 
+  * 
+  *        @note The variable pointed by NumByteToWrite is updated with the
+  *              number of bytes left after each page, and reaches 0 when all
+  *              the data are written to the EEPROM. It is left unchanged if
+  *              the EEPROM does not answer.
+  * 
+  * @retval sEE_OK (0) if the transfer is queued, sEE_FAIL if a write is still 
+  *         in progress.
+  */
+uint32_t sEE_WriteBufferAsync(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t* NumByteToWrite)
+{
+  if (sEEWriteTransfer.Status == I2CBUS_PENDING)
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-  }  
+    return sEE_FAIL;
+  }
   
-  /*!< Send the EEPROM's internal address to write to : LSB of the address */
-  I2C_SendData(sEE_I2C, (uint8_t)(WriteAddr & 0x00FF));
+  sEEWriteBufferPointer = pBuffer;
+  sEEWriteAddress = WriteAddr;
+  sEEWriteRemaining = *NumByteToWrite;
+  sEEWriteCountPointer = NumByteToWrite;
   
-  /*!< Test on EV8 and clear it */
-  sEETimeout = sEE_FLAG_TIMEOUT; 
-  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_BYTE_TRANSMITTING))
+  if (sEEWriteRemaining == 0)
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-  }  
-  
-  /* Configure the DMA Tx Channel with the buffer address and the buffer size */
-  sEE_LowLevel_DMAConfig((uint32_t)pBuffer, (uint8_t)(*NumByteToWrite), sEE_DIRECTION_TX);
-  
-  /* Enable the DMA Tx Stream */
-  DMA_Cmd(sEE_I2C_DMA_STREAM_TX, ENABLE);
+    return sEE_OK;
+  }
   
-  /* If all operations OK, return sEE_OK (0) */
-  return sEE_OK;
+  return sEE_WriteNextPage();
 }
 
 /**
-  * @brief  Writes buffer of data to the I2C EEPROM.
-  * @param  pBuffer : pointer to the buffer  containing the data to be written 
-  *         to the EEPROM.
-  * @param  WriteAddr : EEPROM's internal address to write to.
-  * @param  NumByteToWrite : number of bytes to write to the EEPROM.
-  * @retval None
+  * @brief  Returns the state of the sEE_WritePage() or sEE_WriteBufferAsync()
+  *         transfers.
+  * @param  None
+  * @retval sEE_BUSY while writing, sEE_OK if the last write succeeded, 
+  *         sEE_FAIL otherwise.
   */
-void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite)
+uint32_t sEE_GetWriteStatus(void)
 {
-  uint16_t NumOfPage = 0, NumOfSingle = 0, count = 0;
-  uint16_t Addr = 0;
-
-  Addr = WriteAddr % sEE_PAGESIZE;
-  count = sEE_PAGESIZE - Addr;
-  NumOfPage =  NumByteToWrite / sEE_PAGESIZE;
-  NumOfSingle = NumByteToWrite % sEE_PAGESIZE;
- 
-  /*!< If WriteAddr is sEE_PAGESIZE aligned  */
-  if(Addr == 0) 
+  switch (sEEWriteTransfer.Status)
   {
-    /*!< If NumByteToWrite < sEE_PAGESIZE */
-    if(NumOfPage == 0) 
-    {
-      /* Store the number of data to be written */
-      sEEDataNum = NumOfSingle;
-      /* Start writing data */
-      sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
-      /* Wait transfer through DMA to be complete */
-      sEETimeout = sEE_LONG_TIMEOUT;
-      while (sEEDataNum > 0)
-      {
-        if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-      }
-      sEE_WaitEepromStandbyState();
-    }
-    /*!< If NumByteToWrite > sEE_PAGESIZE */
-    else  
-    {
-      while(NumOfPage--)
-      {
-        /* Store the number of data to be written */
-        sEEDataNum = sEE_PAGESIZE;        
-        sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum)); 
-        /* Wait transfer through DMA to be complete */
-        sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }      
-        sEE_WaitEepromStandbyState();
-        WriteAddr +=  sEE_PAGESIZE;
-        pBuffer += sEE_PAGESIZE;
-      }
-
-      if(NumOfSingle!=0)
-      {
-        /* Store the number of data to be written */
-        sEEDataNum = NumOfSingle;          
-        sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
-        /* Wait transfer through DMA to be complete */
-        sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }    
-        sEE_WaitEepromStandbyState();
-      }
-    }
+  case I2CBUS_PENDING:
+    return sEE_BUSY;
+  case I2CBUS_DONE:
+    return sEE_OK;
+  default:
+    return sEE_FAIL;
   }
-  /*!< If WriteAddr is not sEE_PAGESIZE aligned  */
-  else 
+}
+
+/**
+  * @brief  Waits for the end of the sEE_WritePage() or sEE_WriteBufferAsync()
+  *         transfers.
+  * @note   The timeout restarts after each page: long buffers are not cut.
+  *         When it expires the write is aborted.
+  * @param  None
+  * @retval sEE_OK if the last write succeeded, sEE_FAIL otherwise.
+  */
+uint32_t sEE_WaitWrite(void)
+{
+  uint32_t timeout = I2CBUS_TIMEOUT;
+  uint16_t remaining = sEEWriteRemaining;
+  
+  while (sEEWriteTransfer.Status == I2CBUS_PENDING)
   {
-    /*!< If NumByteToWrite < sEE_PAGESIZE */
-    if(NumOfPage== 0) 
+    if (remaining != sEEWriteRemaining)
     {
-      /*!< If the number of data to be written is more than the remaining space 
-      in the current page: */
-      if (NumByteToWrite > count)
-      {
-        /* Store the number of data to be written */
-        sEEDataNum = count;        
-        /*!< Write the data contained in same page */
-        sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
-        /* Wait transfer through DMA to be complete */
-        sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }          
-        sEE_WaitEepromStandbyState();      
-        
-        /* Store the number of data to be written */
-        sEEDataNum = (NumByteToWrite - count);          
-        /*!< Write the remaining data in the following page */
-        sEE_WritePage((uint8_t*)(pBuffer + count), (WriteAddr + count), (uint8_t*)(&sEEDataNum));
-        /* Wait transfer through DMA to be complete */
-        sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }     
-        sEE_WaitEepromStandbyState();        
-      }      
-      else      
-      {
-        /* Store the number of data to be written */
-        sEEDataNum = NumOfSingle;         
-        sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
-        /* Wait transfer through DMA to be complete */
-        sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }          
-        sEE_WaitEepromStandbyState();        
-      }     
+      remaining = sEEWriteRemaining;
+      timeout = I2CBUS_TIMEOUT;
     }
-    /*!< If NumByteToWrite > sEE_PAGESIZE */
-    else
+    if (timeout-- == 0)
     {
-      NumByteToWrite -= count;
-      NumOfPage =  NumByteToWrite / sEE_PAGESIZE;
-      NumOfSingle = NumByteToWrite % sEE_PAGESIZE;
-      
-      if(count != 0)
-      {  
-        /* Store the number of data to be written */
-        sEEDataNum = count;         
-        sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
-        /* Wait transfer through DMA to be complete */
-        sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }     
-        sEE_WaitEepromStandbyState();
-        WriteAddr += count;
-        pBuffer += count;
-      } 
-      
-      while(NumOfPage--)
-      {
-        /* Store the number of data to be written */
-        sEEDataNum = sEE_PAGESIZE;          
-        sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
-        /* Wait transfer through DMA to be complete */
-        sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }        
-        sEE_WaitEepromStandbyState();
-        WriteAddr +=  sEE_PAGESIZE;
-        pBuffer += sEE_PAGESIZE;  
-      }
-      if(NumOfSingle != 0)
-      {
-        /* Store the number of data to be written */
-        sEEDataNum = NumOfSingle;           
-        sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum)); 
-        /* Wait transfer through DMA to be complete */
-        sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }         
-        sEE_WaitEepromStandbyState();
-      }
+      I2CBus_Abort(&sEEWriteTransfer);
+      break;
     }
-  }  
+  }
+  
+  return (sEEWriteTransfer.Status == I2CBUS_DONE) ? sEE_OK : sEE_FAIL;
 }
 
 /**
@@ -611,6 +460,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
   *        perform the write operation. During this time, it doesn't answer to
   *        I2C packets addressed to it. Once the write operation is complete
   *        the EEPROM responds to its address.
+  *        The address is polled between the other I2C transfers, at most
+  *        I2CBUS_MAX_RETRIES times.
   * 
   * @param  None
   * @retval sEE_OK (0) if operation is correctly performed, else return value 
@@ -618,124 +469,103 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
   */
 uint32_t sEE_WaitEepromStandbyState(void)      
 {
-  __IO uint16_t tmpSR1 = 0;
-  __IO uint32_t sEETrials = 0;
-
-  /*!< While the bus is busy */
-  sEETimeout = sEE_LONG_TIMEOUT;
-  while(I2C_GetFlagStatus(sEE_I2C, I2C_FLAG_BUSY))
+  I2CBus_Transfer_TypeDef probe;
+  
+  /* Address only write, retried while the EEPROM doesn't acknowledge */
+  I2CBus_TransferStructInit(&probe);
+  probe.Address = (uint8_t)sEEAddress;
+  probe.Flags = I2CBUS_FLAG_RETRY_NACK;
+  
+  if (I2CBus_Execute(&probe) != I2CBUS_DONE)
   {
-    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+    return sEE_TIMEOUT_UserCallback();
   }
+  
+  return sEE_OK;
+}
 
-  /* Keep looping till the slave acknowledge his address or maximum number 
-     of trials is reached (this number is defined by sEE_MAX_TRIALS_NUMBER define
-     in stm32f429i_discovery_i2c_ee.h file) */
-  while (1)
+/**
+  * @brief  Queues the next page of the sEE_WriteBufferAsync() buffer.
+  * @param  None
+  * @retval sEE_OK (0) if the transfer is queued, sEE_FAIL otherwise.
+  */
+static uint32_t sEE_WriteNextPage(void)
+{
+  uint16_t count = 0;
+  
+  /* Up to the end of the current page */
+  count = sEE_PAGESIZE - (sEEWriteAddress % sEE_PAGESIZE);
+  if (count > sEEWriteRemaining)
+  {
+    count = sEEWriteRemaining;
+  }
+  
+  sEEWriteTransfer.Address = (uint8_t)sEEAddress;
+  sEEWriteTransfer.Flags = I2CBUS_FLAG_RETRY_NACK;
+  sEEWriteTransfer.RegisterSize = 2;
+  sEEWriteTransfer.Register = sEEWriteAddress;
+  sEEWriteTransfer.pBuffer = sEEWriteBufferPointer;
+  sEEWriteTransfer.Size = count;
+  sEEWriteTransfer.Callback = sEE_WriteBufferCallback;
+  
+  if (I2CBus_Submit(&sEEWriteTransfer) != I2CBUS_PENDING)
   {
-    /*!< Send START condition */
-    I2C_GenerateSTART(sEE_I2C, ENABLE);
+    return sEE_FAIL;
+  }
+  
+  return sEE_OK;
+}
 
-    /*!< Test on EV5 and clear it */
-    sEETimeout = sEE_FLAG_TIMEOUT;
-    while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_MODE_SELECT))
-    {
-      if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-    }    
-
-    /*!< Send EEPROM address for write */
-    I2C_Send7bitAddress(sEE_I2C, sEEAddress, I2C_Direction_Transmitter);
-    
-    /* Wait for ADDR flag to be set (Slave acknowledged his address) */
-    sEETimeout = sEE_LONG_TIMEOUT;
-    do
-    {     
-      /* Get the current value of the SR1 register */
-      tmpSR1 = sEE_I2C->SR1;
-      
-      /* Update the timeout value and exit if it reach 0 */
-      if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
-    }
-    /* Keep looping till the Address is acknowledged or the AF flag is 
-       set (address not acknowledged at time) */
-    while((tmpSR1 & (I2C_SR1_ADDR | I2C_SR1_AF)) == 0);
-     
-    /* Check if the ADDR flag has been set */
-    if (tmpSR1 & I2C_SR1_ADDR)
-    {
-      /* Clear ADDR Flag by reading SR1 then SR2 registers (SR1 have already 
-         been read) */
-      (void)sEE_I2C->SR2;
-      
-      /*!< STOP condition */    
-      I2C_GenerateSTOP(sEE_I2C, ENABLE);
-        
-      /* Exit the function */
-      return sEE_OK;
-    }
-    else
-    {
-      /*!< Clear AF flag */
-      I2C_ClearFlag(sEE_I2C, I2C_FLAG_AF);                  
-    }
-    
-    /* Check if the maximum allowed number of trials has bee reached */
-    if (sEETrials++ == sEE_MAX_TRIALS_NUMBER)
-    {
-      /* If the maximum number of trials has been reached, exit the function */
-      return sEE_TIMEOUT_UserCallback();
-    }
+/**
+  * @brief  sEE_ReadBuffer() transfer completion, interrupt context.
+  * @param  pTransfer: pointer to the completed transfer.
+  * @retval None
+  */
+static void sEE_ReadCallback(I2CBus_Transfer_TypeDef *pTransfer)
+{
+  if (pTransfer->Status == I2CBUS_DONE)
+  {
+    /* Reset the variable holding the number of data to be read */
+    *sEEDataReadPointer = 0;
   }
 }
 
 /**
-  * @brief  This function handles the DMA Tx Channel interrupt Handler.
-  * @param  None
+  * @brief  sEE_WritePage() transfer completion, interrupt context.
+  * @param  pTransfer: pointer to the completed transfer.
   * @retval None
   */
-void sEE_I2C_DMA_TX_IRQHandler(void)
+static void sEE_WritePageCallback(I2CBus_Transfer_TypeDef *pTransfer)
 {
-  /* Check if the DMA transfer is complete */
-  if(DMA_GetFlagStatus(sEE_I2C_DMA_STREAM_TX, sEE_TX_DMA_FLAG_TCIF) != RESET)
-  {  
-    /* Disable the DMA Tx Stream and Clear TC flag */  
-    DMA_Cmd(sEE_I2C_DMA_STREAM_TX, DISABLE);
-    DMA_ClearFlag(sEE_I2C_DMA_STREAM_TX, sEE_TX_DMA_FLAG_TCIF);
-
-    /*!< Wait till all data have been physically transferred on the bus */
-    sEETimeout = sEE_LONG_TIMEOUT;
-    while(!I2C_GetFlagStatus(sEE_I2C, I2C_FLAG_BTF))
-    {
-      if((sEETimeout--) == 0) sEE_TIMEOUT_UserCallback();
-    }
-    
-    /*!< Send STOP condition */
-    I2C_GenerateSTOP(sEE_I2C, ENABLE);
-    
+  if (pTransfer->Status == I2CBUS_DONE)
+  {
     /* Reset the variable holding the number of data to be written */
-    *sEEDataWritePointer = 0;  
+    *sEEDataWritePointer = 0;
   }
 }
 
 /**
-  * @brief  This function handles the DMA Rx Channel interrupt Handler.
-  * @param  None
+  * @brief  sEE_WriteBufferAsync() page completion, interrupt context: the
+  *         next page is queued, it is retried until the EEPROM ends the write
+  *         cycle of this one.
+  * @param  pTransfer: pointer to the completed transfer.
   * @retval None
   */
-void sEE_I2C_DMA_RX_IRQHandler(void)
+static void sEE_WriteBufferCallback(I2CBus_Transfer_TypeDef *pTransfer)
 {
-  /* Check if the DMA transfer is complete */
-  if(DMA_GetFlagStatus(sEE_I2C_DMA_STREAM_RX, sEE_RX_DMA_FLAG_TCIF) != RESET)
-  {      
-    /*!< Send STOP Condition */
-    I2C_GenerateSTOP(sEE_I2C, ENABLE);    
-    
-    /* Disable the DMA Rx Stream and Clear TC Flag */  
-    DMA_Cmd(sEE_I2C_DMA_STREAM_RX, DISABLE);
-    DMA_ClearFlag(sEE_I2C_DMA_STREAM_RX, sEE_RX_DMA_FLAG_TCIF);
-    
-    /* Reset the variable holding the number of data to be read */
-    *sEEDataReadPointer = 0;
+  if (pTransfer->Status != I2CBUS_DONE)
+  {
+    return;
+  }
+  
+  sEEWriteBufferPointer += pTransfer->Size;
+  sEEWriteAddress += pTransfer->Size;
+  sEEWriteRemaining -= pTransfer->Size;
+  *sEEWriteCountPointer = sEEWriteRemaining;
+  
+  if (sEEWriteRemaining != 0)
+  {
+    sEE_WriteNextPage();
   }
 }
 
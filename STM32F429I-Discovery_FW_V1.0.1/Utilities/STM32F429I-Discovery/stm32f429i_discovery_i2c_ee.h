@@ -36,6 +36,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery.h"
+#include "stm32f429i_discovery_i2c.h"
 
 /** @addtogroup Utilities
   * @{
@@ -76,19 +77,13 @@
 #define sEE_HW_ADDRESS         0xA0
 #define sEE_PAGESIZE           4
                                 
-/* Maximum Timeout values for flags and events waiting loops. These timeouts are
-   not based on accurate values, they just guarantee that the application will 
-   not remain stuck if the I2C communication is corrupted.
-   You may modify these timeout values depending on CPU frequency and application
-   conditions (interrupts routines ...). */   
-#define sEE_FLAG_TIMEOUT         ((uint32_t)0x1000)
-#define sEE_LONG_TIMEOUT         ((uint32_t)(10 * sEE_FLAG_TIMEOUT))
-
-/* Maximum number of trials for sEE_WaitEepromStandbyState() function */
-#define sEE_MAX_TRIALS_NUMBER     300
+/* The waiting loops timeout and the maximum number of trials while the EEPROM 
+   is busy are the I2C bus ones (I2CBUS_TIMEOUT and I2CBUS_MAX_RETRIES in 
+   stm32f429i_discovery_i2c.h file) */
       
 #define sEE_OK                    0
 #define sEE_FAIL                  1   
+#define sEE_BUSY                  2   
  
 
 /**
@@ -108,11 +103,14 @@
 void     sEE_DeInit(void);
 void     sEE_Init(void);
 uint32_t sEE_ReadBuffer(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t* NumByteToRead);
+uint32_t sEE_GetReadStatus(void);
+uint32_t sEE_WaitRead(void);
 uint32_t sEE_WritePage(uint8_t* pBuffer, uint16_t WriteAddr, uint8_t* NumByteToWrite);
 void     sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite);
+uint32_t sEE_WriteBufferAsync(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t* NumByteToWrite);
+uint32_t sEE_GetWriteStatus(void);
+uint32_t sEE_WaitWrite(void);
 uint32_t sEE_WaitEepromStandbyState(void);
-void     sEE_I2C_DMA_TX_IRQHandler(void);
-void     sEE_I2C_DMA_RX_IRQHandler(void);
 
 /* USER Callbacks: These are functions for which prototypes only are declared in
    EEPROM driver and that should be implemented into user applicaiton. */  
@@ -0,0 +1,543 @@
+/**
+  ******************************************************************************
+  * @file    stm32f429i_discovery_i2c_ee_cache.c
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    28-October-2013
+  * @brief   This file provides a write-back cache over the I2C EEPROM driver
+  *          (stm32f429i_discovery_i2c_ee.c), with wear-leveling.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - The whole cached area (sEE_CACHE_SIZE bytes) is kept in RAM:
+  *             sEE_CacheRead() and sEE_CacheWrite() never access the bus.
+  *           - Written lines are marked dirty. sEE_CacheProcess(), called
+  *             from the main loop, writes one dirty line at a time in the
+  *             background with sEE_WriteBufferAsync(), once the writes have
+  *             stopped for sEE_CACHE_FLUSH_DELAY ms: the writes done in the
+  *             meantime are merged into whole EEPROM pages.
+  *           - A line is never written in place: each flush uses the next
+  *             free record, tagged with the line number and a sequence
+  *             number. The previous record of the line stays valid until the
+  *             new one is complete, so a reset during a flush loses the last
+  *             changes of the line only.
+  *           - sEE_CacheInit() rebuilds the lines from the records with the
+  *             highest sequence number and a valid checksum.
+  *          ===================================================================
+  *
+  *          Record layout (sEE_CACHE_RECORD_SIZE bytes):
+  *
+  *     +--------+--------+------------------+------------------+-----------+
+  *     |  Line  | ~Line  | Fletcher-16 (LE) |  Sequence (LE)   |   Data    |
+  *     +--------+--------+------------------+------------------+-----------+
+  *     | 1 byte | 1 byte |     2 bytes      |     4 bytes      | LINE_SIZE |
+  *     +--------+--------+------------------+------------------+-----------+
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f429i_discovery_i2c_ee_cache.h"
+#include <string.h>
+
+/** @addtogroup Utilities
+  * @{
+  */
+
+/** @addtogroup STM32F4_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY_I2C_EE_CACHE
+  * @brief      This file includes the I2C EEPROM cache of STM32F429I Discovery Kit.
+  * @{
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Private_Types
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Private_Defines
+  * @{
+  */
+#define sEE_CACHE_NONE        0xFF   /* no line, no record */
+
+#if ((sEE_CACHE_LINE_SIZE % sEE_PAGESIZE) != 0) || ((sEE_CACHE_EE_ADDRESS % sEE_PAGESIZE) != 0)
+ #error "sEE cache lines and records must be aligned on the EEPROM pages"
+#endif
+#if (sEE_CACHE_LINES >= sEE_CACHE_NONE) || (sEE_CACHE_RECORDS >= sEE_CACHE_NONE)
+ #error "sEE_CACHE_LINES and sEE_CACHE_RECORDS must be lower than 255"
+#endif
+#if (sEE_CACHE_RECORDS <= sEE_CACHE_LINES)
+ #error "sEE_CACHE_RECORDS must be higher than sEE_CACHE_LINES"
+#endif
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Private_Macros
+  * @{
+  */
+#define sEE_CACHE_ADDRESS(RECORD)   (sEE_CACHE_EE_ADDRESS + (uint16_t)(RECORD) * sEE_CACHE_RECORD_SIZE)
+#define sEE_CACHE_IS_DIRTY(LINE)    ((sEECacheDirty[(LINE) >> 5] & (1UL << ((LINE) & 31))) != 0)
+#define sEE_CACHE_SET_DIRTY(LINE)   (sEECacheDirty[(LINE) >> 5] |= (1UL << ((LINE) & 31)))
+#define sEE_CACHE_CLEAR_DIRTY(LINE) (sEECacheDirty[(LINE) >> 5] &= ~(1UL << ((LINE) & 31)))
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Private_Variables
+  * @{
+  */
+static uint8_t  sEECacheData[sEE_CACHE_SIZE];        /* RAM image of the lines */
+static uint8_t  sEECacheRecord[sEE_CACHE_LINES];     /* record of each line */
+static uint8_t  sEECacheOwner[sEE_CACHE_RECORDS];    /* line of each record */
+static uint32_t sEECacheDirty[(sEE_CACHE_LINES + 31) / 32];
+static uint8_t  sEECacheBuffer[sEE_CACHE_RECORD_SIZE]; /* record being read or written */
+static uint32_t sEECacheSequence = 0;                /* sequence of the next record */
+static uint8_t  sEECacheNextRecord = 0;
+static uint8_t  sEECacheNextLine = 0;
+static uint8_t  sEECacheWritingLine = sEE_CACHE_NONE;
+static uint8_t  sEECacheWritingRecord = sEE_CACHE_NONE;
+static __IO uint16_t sEECacheCount = 0;              /* bytes left in the record write */
+static __IO uint16_t sEECacheReadCount = 0;
+static uint32_t sEECacheWrites = 0;                  /* sEE_CacheWrite() calls */
+static uint32_t sEECacheSeenWrites = 0;
+static uint32_t sEECacheLastWrite = 0;               /* time of the last write */
+static sEE_CacheStats_TypeDef sEECacheStats;
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Private_Function_Prototypes
+  * @{
+  */
+static uint32_t sEE_CacheComplete(void);
+static uint8_t  sEE_CacheStart(void);
+static uint32_t sEE_CacheReadRecord(uint8_t Record);
+static uint16_t sEE_CacheChecksum(const uint8_t* pRecord);
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Initializes the cache: the lines are restored from the EEPROM
+  *         records, the lines never written read as 0xFF.
+  * @note   sEE_Init() must have been called. This function waits for the
+  *         reading of the whole records area.
+  * @param  None
+  * @retval sEE_OK (0) if the records were read, sEE_FAIL otherwise.
+  */
+uint32_t sEE_CacheInit(void)
+{
+  uint32_t sequence[sEE_CACHE_LINES];
+  uint32_t seq = 0, line = 0, record = 0, found = 0;
+
+  memset(sEECacheData, 0xFF, sizeof(sEECacheData));
+  memset(sEECacheRecord, sEE_CACHE_NONE, sizeof(sEECacheRecord));
+  memset(sEECacheOwner, sEE_CACHE_NONE, sizeof(sEECacheOwner));
+  memset(sEECacheDirty, 0, sizeof(sEECacheDirty));
+  memset(&sEECacheStats, 0, sizeof(sEECacheStats));
+  sEECacheWritingLine = sEE_CACHE_NONE;
+  sEECacheNextLine = 0;
+  sEECacheNextRecord = 0;
+  sEECacheSequence = 0;
+
+  for (record = 0; record < sEE_CACHE_RECORDS; record++)
+  {
+    if (sEE_CacheReadRecord((uint8_t)record) != sEE_OK)
+    {
+      return sEE_FAIL;
+    }
+
+    line = sEECacheBuffer[0];
+    if ((line >= sEE_CACHE_LINES) || (sEECacheBuffer[1] != (uint8_t)~line) ||
+        (sEE_CacheChecksum(sEECacheBuffer) != (sEECacheBuffer[2] | ((uint16_t)sEECacheBuffer[3] << 8))))
+    {
+      /* Erased, torn or corrupted record */
+      continue;
+    }
+
+    seq = sEECacheBuffer[4] | ((uint32_t)sEECacheBuffer[5] << 8) |
+          ((uint32_t)sEECacheBuffer[6] << 16) | ((uint32_t)sEECacheBuffer[7] << 24);
+
+    /* Continue the rotation after the last record written */
+    if ((found == 0) || (seq >= sEECacheSequence))
+    {
+      sEECacheSequence = seq + 1;
+      sEECacheNextRecord = (uint8_t)((record + 1) % sEE_CACHE_RECORDS);
+      found = 1;
+    }
+
+    if ((sEECacheRecord[line] != sEE_CACHE_NONE) && (seq <= sequence[line]))
+    {
+      /* Older copy of the line */
+      continue;
+    }
+    if (sEECacheRecord[line] != sEE_CACHE_NONE)
+    {
+      sEECacheOwner[sEECacheRecord[line]] = sEE_CACHE_NONE;
+    }
+    sEECacheRecord[line] = (uint8_t)record;
+    sEECacheOwner[record] = (uint8_t)line;
+    sequence[line] = seq;
+    memcpy(&sEECacheData[line * sEE_CACHE_LINE_SIZE], &sEECacheBuffer[sEE_CACHE_HEADER_SIZE], sEE_CACHE_LINE_SIZE);
+  }
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Reads data from the cache.
+  * @param  Address: first byte, from 0 to sEE_CACHE_SIZE - 1.
+  * @param  pBuffer: pointer to the buffer that receives the data.
+  * @param  NumByteToRead: number of bytes to read.
+  * @retval sEE_OK (0) if the data was read, sEE_FAIL if out of the cache.
+  */
+uint32_t sEE_CacheRead(uint16_t Address, uint8_t* pBuffer, uint16_t NumByteToRead)
+{
+  if (((uint32_t)Address + NumByteToRead) > sEE_CACHE_SIZE)
+  {
+    return sEE_FAIL;
+  }
+
+  memcpy(pBuffer, &sEECacheData[Address], NumByteToRead);
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Writes data to the cache, the changed lines are written to the
+  *         EEPROM later by sEE_CacheProcess() or sEE_CacheFlush().
+  * @param  Address: first byte, from 0 to sEE_CACHE_SIZE - 1.
+  * @param  pBuffer: pointer to the data.
+  * @param  NumByteToWrite: number of bytes to write.
+  * @retval sEE_OK (0) if the data was written, sEE_FAIL if out of the cache.
+  */
+uint32_t sEE_CacheWrite(uint16_t Address, const uint8_t* pBuffer, uint16_t NumByteToWrite)
+{
+  uint32_t index = 0;
+
+  if (((uint32_t)Address + NumByteToWrite) > sEE_CACHE_SIZE)
+  {
+    return sEE_FAIL;
+  }
+
+  /* Only the lines really changed are flushed */
+  for (index = Address; index < ((uint32_t)Address + NumByteToWrite); index++)
+  {
+    if (sEECacheData[index] != *pBuffer)
+    {
+      sEECacheData[index] = *pBuffer;
+      sEE_CACHE_SET_DIRTY(index / sEE_CACHE_LINE_SIZE);
+    }
+    pBuffer++;
+  }
+
+  sEECacheStats.LogicalBytes += NumByteToWrite;
+  sEECacheWrites++;
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Runs the background flush: completes the record being written and
+  *         starts the next dirty line once the writes have stopped for
+  *         sEE_CACHE_FLUSH_DELAY ms. This function never waits for the bus.
+  * @param  Time: current time in ms (SysTick based counter for example).
+  * @retval None
+  */
+void sEE_CacheProcess(uint32_t Time)
+{
+  if (sEECacheWrites != sEECacheSeenWrites)
+  {
+    sEECacheSeenWrites = sEECacheWrites;
+    sEECacheLastWrite = Time;
+  }
+
+  if (sEE_CacheComplete() == sEE_BUSY)
+  {
+    return;
+  }
+
+  if ((Time - sEECacheLastWrite) >= sEE_CACHE_FLUSH_DELAY)
+  {
+    sEE_CacheStart();
+  }
+}
+
+/**
+  * @brief  Writes all the dirty lines to the EEPROM and waits for the end of
+  *         the writes.
+  * @param  None
+  * @retval sEE_OK (0) if the cache is clean, sEE_FAIL if a record was not
+  *         written (its line stays dirty).
+  */
+uint32_t sEE_CacheFlush(void)
+{
+  uint32_t status = sEE_OK;
+
+  while (1)
+  {
+    status = sEE_CacheComplete();
+    if (status == sEE_BUSY)
+    {
+      sEE_WaitWrite();
+    }
+    else if (status == sEE_FAIL)
+    {
+      return sEE_FAIL;
+    }
+    else if (sEE_CacheStart() == 0)
+    {
+      return sEE_CacheIsClean() ? sEE_OK : sEE_FAIL;
+    }
+  }
+}
+
+/**
+  * @brief  Checks if all the changes are written to the EEPROM.
+  * @param  None
+  * @retval 1 if the cache is clean, 0 otherwise.
+  */
+uint8_t sEE_CacheIsClean(void)
+{
+  uint32_t index = 0;
+
+  if (sEECacheWritingLine != sEE_CACHE_NONE)
+  {
+    return 0;
+  }
+
+  for (index = 0; index < (sizeof(sEECacheDirty) / sizeof(sEECacheDirty[0])); index++)
+  {
+    if (sEECacheDirty[index] != 0)
+    {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/**
+  * @brief  Returns the cache counters.
+  * @param  pStats: pointer to the counters to fill.
+  * @retval None
+  */
+void sEE_CacheGetStats(sEE_CacheStats_TypeDef* pStats)
+{
+  *pStats = sEECacheStats;
+}
+
+/**
+  * @brief  Completes the record being written: it becomes the record of its
+  *         line, the previous one is free.
+  * @param  None
+  * @retval sEE_BUSY while writing, sEE_FAIL if the record was not written,
+  *         sEE_OK otherwise.
+  */
+static uint32_t sEE_CacheComplete(void)
+{
+  uint32_t status = sEE_OK;
+  uint8_t line = sEECacheWritingLine;
+
+  if (line == sEE_CACHE_NONE)
+  {
+    return sEE_OK;
+  }
+
+  status = sEE_GetWriteStatus();
+  if (status == sEE_BUSY)
+  {
+    return sEE_BUSY;
+  }
+  sEECacheWritingLine = sEE_CACHE_NONE;
+
+  if ((status != sEE_OK) || (sEECacheCount != 0))
+  {
+    /* Written again later, in another record */
+    sEE_CACHE_SET_DIRTY(line);
+    sEECacheStats.Failures++;
+    return sEE_FAIL;
+  }
+
+  if (sEECacheRecord[line] != sEE_CACHE_NONE)
+  {
+    sEECacheOwner[sEECacheRecord[line]] = sEE_CACHE_NONE;
+  }
+  sEECacheRecord[line] = sEECacheWritingRecord;
+  sEECacheOwner[sEECacheWritingRecord] = line;
+
+  sEECacheStats.Records++;
+  sEECacheStats.PhysicalBytes += sEE_CACHE_RECORD_SIZE;
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Starts writing the next dirty line in the next free record.
+  * @param  None
+  * @retval 1 if a write was started or the EEPROM is busy, 0 if no line is dirty.
+  */
+static uint8_t sEE_CacheStart(void)
+{
+  uint32_t index = 0;
+  uint16_t checksum = 0;
+  uint8_t line = sEE_CACHE_NONE, record = sEE_CACHE_NONE;
+
+  /* Round robin over the dirty lines */
+  for (index = 0; index < sEE_CACHE_LINES; index++)
+  {
+    if (sEE_CACHE_IS_DIRTY(sEECacheNextLine))
+    {
+      line = sEECacheNextLine;
+    }
+    sEECacheNextLine = (uint8_t)((sEECacheNextLine + 1) % sEE_CACHE_LINES);
+    if (line != sEE_CACHE_NONE)
+    {
+      break;
+    }
+  }
+  if (line == sEE_CACHE_NONE)
+  {
+    return 0;
+  }
+
+  /* Rotation over the free records: there is always one as there are more
+     records than lines */
+  for (index = 0; index < sEE_CACHE_RECORDS; index++)
+  {
+    if (sEECacheOwner[sEECacheNextRecord] == sEE_CACHE_NONE)
+    {
+      record = sEECacheNextRecord;
+    }
+    sEECacheNextRecord = (uint8_t)((sEECacheNextRecord + 1) % sEE_CACHE_RECORDS);
+    if (record != sEE_CACHE_NONE)
+    {
+      break;
+    }
+  }
+
+  /* Snapshot of the line: it may be written again during the flush */
+  sEECacheBuffer[0] = line;
+  sEECacheBuffer[1] = (uint8_t)~line;
+  sEECacheBuffer[4] = (uint8_t)sEECacheSequence;
+  sEECacheBuffer[5] = (uint8_t)(sEECacheSequence >> 8);
+  sEECacheBuffer[6] = (uint8_t)(sEECacheSequence >> 16);
+  sEECacheBuffer[7] = (uint8_t)(sEECacheSequence >> 24);
+  memcpy(&sEECacheBuffer[sEE_CACHE_HEADER_SIZE], &sEECacheData[line * sEE_CACHE_LINE_SIZE], sEE_CACHE_LINE_SIZE);
+  checksum = sEE_CacheChecksum(sEECacheBuffer);
+  sEECacheBuffer[2] = (uint8_t)checksum;
+  sEECacheBuffer[3] = (uint8_t)(checksum >> 8);
+
+  sEECacheCount = sEE_CACHE_RECORD_SIZE;
+  if (sEE_WriteBufferAsync(sEECacheBuffer, sEE_CACHE_ADDRESS(record), (uint16_t*)(&sEECacheCount)) != sEE_OK)
+  {
+    /* Another write in progress: the line stays dirty */
+    return 1;
+  }
+
+  sEE_CACHE_CLEAR_DIRTY(line);
+  sEECacheWritingLine = line;
+  sEECacheWritingRecord = record;
+  sEECacheSequence++;
+
+  return 1;
+}
+
+/**
+  * @brief  Reads a record in sEECacheBuffer and waits for the end of the read.
+  * @param  Record: record number.
+  * @retval sEE_OK (0) if the record was read, sEE_FAIL otherwise.
+  */
+static uint32_t sEE_CacheReadRecord(uint8_t Record)
+{
+  sEECacheReadCount = sEE_CACHE_RECORD_SIZE;
+  if (sEE_ReadBuffer(sEECacheBuffer, sEE_CACHE_ADDRESS(Record), (uint16_t*)(&sEECacheReadCount)) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  /* A read aborted on timeout no longer writes sEECacheBuffer */
+  if ((sEE_WaitRead() != sEE_OK) || (sEECacheReadCount > 0))
+  {
+    return sEE_FAIL;
+  }
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Computes the Fletcher-16 checksum of a record: line, sequence and
+  *         data.
+  * @param  pRecord: pointer to the record.
+  * @retval Checksum.
+  */
+static uint16_t sEE_CacheChecksum(const uint8_t* pRecord)
+{
+  uint32_t sum1 = pRecord[0], sum2 = pRecord[0], index = 0;
+
+  for (index = 4; index < sEE_CACHE_RECORD_SIZE; index++)
+  {
+    sum1 = (sum1 + pRecord[index]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+
+  return (uint16_t)((sum2 << 8) | sum1);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
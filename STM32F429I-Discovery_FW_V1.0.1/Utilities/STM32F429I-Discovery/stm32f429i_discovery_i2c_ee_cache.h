@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file    stm32f429i_discovery_i2c_ee_cache.h
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    28-October-2013
+  * @brief   This file contains all the functions prototypes for
+  *          the stm32f429i_discovery_i2c_ee_cache.c firmware driver.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F429I_DISCOVERY_I2C_EE_CACHE_H
+#define __STM32F429I_DISCOVERY_I2C_EE_CACHE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f429i_discovery_i2c_ee.h"
+
+/** @addtogroup Utilities
+  * @{
+  */
+
+/** @addtogroup STM32F4_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY_I2C_EE_CACHE
+  * @{
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Exported_Types
+  * @{
+  */
+
+/**
+  * @brief  EEPROM cache counters, the write amplification is
+  *         PhysicalBytes / LogicalBytes
+  */
+typedef struct
+{
+  uint32_t LogicalBytes;     /* bytes written by sEE_CacheWrite() */
+  uint32_t PhysicalBytes;    /* bytes written to the EEPROM (records and headers) */
+  uint32_t Records;          /* records written */
+  uint32_t Failures;         /* records not acknowledged, written again */
+}sEE_CacheStats_TypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Exported_Constants
+  * @{
+  */
+
+/* The cached area is split in logical lines of sEE_CACHE_LINE_SIZE bytes. Each
+   flush writes a whole line, with an 8 bytes header, in the next free record
+   of the sEE_CACHE_RECORDS records area: the writes rotate over all the free
+   records instead of wearing the same EEPROM pages.
+   The records area (sEE_CACHE_RECORDS * sEE_CACHE_RECORD_SIZE bytes from
+   sEE_CACHE_EE_ADDRESS) must not overlap the other EEPROM users, such as the
+   touch panel calibration (IOE_TP_CAL_EE_ADDRESS). */
+#ifndef sEE_CACHE_EE_ADDRESS
+ #define sEE_CACHE_EE_ADDRESS     0x0000
+#endif /* sEE_CACHE_EE_ADDRESS */
+
+#ifndef sEE_CACHE_LINE_SIZE
+ #define sEE_CACHE_LINE_SIZE      16     /* multiple of sEE_PAGESIZE */
+#endif /* sEE_CACHE_LINE_SIZE */
+
+#ifndef sEE_CACHE_LINES
+ #define sEE_CACHE_LINES          64     /* 1 KB cached, at most 255 lines */
+#endif /* sEE_CACHE_LINES */
+
+#ifndef sEE_CACHE_RECORDS
+ #define sEE_CACHE_RECORDS        80     /* more than sEE_CACHE_LINES */
+#endif /* sEE_CACHE_RECORDS */
+
+/* A line is flushed once no write happened during sEE_CACHE_FLUSH_DELAY ms,
+   so that close writes are merged in the same record */
+#ifndef sEE_CACHE_FLUSH_DELAY
+ #define sEE_CACHE_FLUSH_DELAY    100
+#endif /* sEE_CACHE_FLUSH_DELAY */
+
+#define sEE_CACHE_HEADER_SIZE     8
+#define sEE_CACHE_RECORD_SIZE     (sEE_CACHE_HEADER_SIZE + sEE_CACHE_LINE_SIZE)
+#define sEE_CACHE_SIZE            (sEE_CACHE_LINE_SIZE * sEE_CACHE_LINES)
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Exported_Macros
+  * @{
+  */
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_CACHE_Exported_Functions
+  * @{
+  */
+uint32_t sEE_CacheInit(void);
+uint32_t sEE_CacheRead(uint16_t Address, uint8_t* pBuffer, uint16_t NumByteToRead);
+uint32_t sEE_CacheWrite(uint16_t Address, const uint8_t* pBuffer, uint16_t NumByteToWrite);
+void     sEE_CacheProcess(uint32_t Time);
+uint32_t sEE_CacheFlush(void);
+uint8_t  sEE_CacheIsClean(void);
+void     sEE_CacheGetStats(sEE_CacheStats_TypeDef* pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F429I_DISCOVERY_I2C_EE_CACHE_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
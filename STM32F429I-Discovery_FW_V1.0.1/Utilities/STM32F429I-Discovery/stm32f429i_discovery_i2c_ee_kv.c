@@ -0,0 +1,620 @@
+/**
+  ******************************************************************************
+  * @file    stm32f429i_discovery_i2c_ee_kv.c
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    28-October-2013
+  * @brief   This file provides a log-structured key-value store over the I2C
+  *          EEPROM driver (stm32f429i_discovery_i2c_ee.c), for the settings
+  *          and data to keep across resets.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - The store uses two banks. The active bank starts with a bank
+  *             header holding its generation number, followed by the records
+  *             appended by sEE_KVSet() and sEE_KVDelete(): a value is never
+  *             written in place, a new record replaces the previous one.
+  *           - Each record is protected by a CRC-32 computed by the CRC
+  *             peripheral over the bank generation, the record header and the
+  *             data. A record torn by a reset and the records left by the
+  *             previous generations are invalid, sEE_KVInit() stops the scan
+  *             of the bank at the first invalid record.
+  *           - sEE_KVInit() rebuilds the RAM index (the record offset of each
+  *             key), sEE_KVGet() then reads the record directly.
+  *           - When the active bank is full, sEE_KVCompact() copies the last
+  *             record of each key to the other bank, then writes its header
+  *             with the next generation. Until this header is written the
+  *             previous bank stays the active one, so a reset during the
+  *             compaction loses nothing.
+  *           - The CRC peripheral is reset by each computation, it must not be
+  *             used by an interrupt during the store functions.
+  *          ===================================================================
+  *
+  *          Bank header (sEE_KV_BANK_HEADER_SIZE bytes):
+  *
+  *               +-----------+------------+------------------------+
+  *               |   Magic   | Generation | CRC(Magic, Generation) |
+  *               +-----------+------------+------------------------+
+  *
+  *          Record (8 bytes + data padded to 32-bit words):
+  *
+  *     +------------------------------------+-----------+----------------+
+  *     | Key (16) | Length (8) | Type (8)   |    CRC    | Data (padded)  |
+  *     +------------------------------------+-----------+----------------+
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f429i_discovery_i2c_ee_kv.h"
+#include "stm32f4xx_crc.h"
+#include <string.h>
+
+/** @addtogroup Utilities
+  * @{
+  */
+
+/** @addtogroup STM32F4_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY_I2C_EE_KV
+  * @brief      This file includes the I2C EEPROM key-value store of STM32F429I
+  *             Discovery Kit.
+  * @{
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Private_Types
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Private_Defines
+  * @{
+  */
+#define sEE_KV_MAGIC              ((uint32_t)0x3153564B)   /* "KVS1" */
+#define sEE_KV_BANK_HEADER_SIZE   12
+#define sEE_KV_RECORD_HEADER_SIZE 8
+
+#define sEE_KV_TYPE_VALUE         0xA5
+#define sEE_KV_TYPE_DELETE        0x5A
+
+#if (sEE_KV_MAX_VALUE > 255)
+ #error "sEE_KV_MAX_VALUE must be lower than 256"
+#endif
+#if ((sEE_KV_EE_ADDRESS % sEE_PAGESIZE) != 0) || ((sEE_KV_BANK_SIZE % sEE_PAGESIZE) != 0)
+ #error "sEE KV banks must be aligned on the EEPROM pages"
+#endif
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Private_Macros
+  * @{
+  */
+#define sEE_KV_BANK_ADDRESS(BANK)  (sEE_KV_EE_ADDRESS + (uint16_t)(BANK) * sEE_KV_BANK_SIZE)
+#define sEE_KV_DATA_SIZE(LENGTH)   (((uint16_t)(LENGTH) + 3) & ~3)
+#define sEE_KV_RECORD_SIZE(LENGTH) (sEE_KV_RECORD_HEADER_SIZE + sEE_KV_DATA_SIZE(LENGTH))
+#define sEE_KV_INFO(KEY, LENGTH, TYPE) ((uint32_t)(KEY) | ((uint32_t)(LENGTH) << 16) | ((uint32_t)(TYPE) << 24))
+#define sEE_KV_INFO_KEY(INFO)      ((uint16_t)(INFO))
+#define sEE_KV_INFO_LENGTH(INFO)   ((uint8_t)((INFO) >> 16))
+#define sEE_KV_INFO_TYPE(INFO)     ((uint8_t)((INFO) >> 24))
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Private_Variables
+  * @{
+  */
+static uint16_t sEEKVIndex[sEE_KV_KEYS];   /* record offset in the bank, 0 if none */
+static uint8_t  sEEKVLength[sEE_KV_KEYS];
+static uint8_t  sEEKVBank = 0;             /* active bank */
+static uint32_t sEEKVGeneration = 0;       /* generation of the active bank */
+static uint16_t sEEKVTail = 0;             /* offset of the next record */
+/* Record image: header and data */
+static uint32_t sEEKVBuffer[(sEE_KV_RECORD_HEADER_SIZE + sEE_KV_MAX_VALUE + 3) / 4];
+static __IO uint16_t sEEKVCount = 0;
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Private_Function_Prototypes
+  * @{
+  */
+static uint32_t sEE_KVAppend(uint16_t Key, uint8_t Type, const uint8_t* pData, uint8_t Length);
+static uint32_t sEE_KVReadRecord(uint8_t Bank, uint32_t Generation, uint16_t Offset);
+static uint32_t sEE_KVReadHeader(uint8_t Bank, uint32_t* pGeneration);
+static uint32_t sEE_KVWriteHeader(uint8_t Bank, uint32_t Generation);
+static uint32_t sEE_KVRecordCRC(uint32_t Generation);
+static uint32_t sEE_KVRead(uint16_t Address, uint8_t* pBuffer, uint16_t NumByteToRead);
+static uint32_t sEE_KVWrite(uint16_t Address, uint8_t* pBuffer, uint16_t NumByteToWrite);
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Initializes the store: selects the bank with the highest valid
+  *         generation and rebuilds the RAM index from its records. An EEPROM
+  *         without valid bank is formatted.
+  * @note   sEE_Init() must have been called.
+  * @param  None
+  * @retval sEE_OK (0) if the store is ready, sEE_FAIL otherwise.
+  */
+uint32_t sEE_KVInit(void)
+{
+  uint32_t generation[2] = {0, 0};
+  uint32_t info = 0;
+  uint16_t offset = 0, key = 0;
+
+  RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_CRC, ENABLE);
+
+  /* A communication failure must not format the store */
+  if ((sEE_KVReadHeader(0, &generation[0]) != sEE_OK) ||
+      (sEE_KVReadHeader(1, &generation[1]) != sEE_OK))
+  {
+    return sEE_FAIL;
+  }
+
+  if ((generation[0] == 0) && (generation[1] == 0))
+  {
+    sEEKVGeneration = 0;
+    return sEE_KVFormat();
+  }
+
+  sEEKVBank = (generation[1] > generation[0]) ? 1 : 0;
+  sEEKVGeneration = generation[sEEKVBank];
+
+  memset(sEEKVIndex, 0, sizeof(sEEKVIndex));
+  memset(sEEKVLength, 0, sizeof(sEEKVLength));
+
+  /* Replay the log: the last record of each key wins */
+  offset = sEE_KV_BANK_HEADER_SIZE;
+  while (sEE_KVReadRecord(sEEKVBank, sEEKVGeneration, offset) == sEE_OK)
+  {
+    info = sEEKVBuffer[0];
+    key = sEE_KV_INFO_KEY(info);
+    if (sEE_KV_INFO_TYPE(info) == sEE_KV_TYPE_VALUE)
+    {
+      sEEKVIndex[key] = offset;
+      sEEKVLength[key] = sEE_KV_INFO_LENGTH(info);
+    }
+    else
+    {
+      sEEKVIndex[key] = 0;
+      sEEKVLength[key] = 0;
+    }
+    offset += sEE_KV_RECORD_SIZE(sEE_KV_INFO_LENGTH(info));
+  }
+  sEEKVTail = offset;
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Erases all the keys: bank 0 becomes active with a new generation.
+  * @param  None
+  * @retval sEE_OK (0) if the store was formatted, sEE_FAIL otherwise.
+  */
+uint32_t sEE_KVFormat(void)
+{
+  /* Without valid bank header until the end, sEE_KVInit() formats again */
+  if ((sEE_KVWriteHeader(1, 0) != sEE_OK) ||
+      (sEE_KVWriteHeader(0, sEEKVGeneration + 1) != sEE_OK))
+  {
+    return sEE_FAIL;
+  }
+
+  sEEKVBank = 0;
+  sEEKVGeneration++;
+  sEEKVTail = sEE_KV_BANK_HEADER_SIZE;
+  memset(sEEKVIndex, 0, sizeof(sEEKVIndex));
+  memset(sEEKVLength, 0, sizeof(sEEKVLength));
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Reads the value of a key.
+  * @param  Key: key, from 0 to sEE_KV_KEYS - 1.
+  * @param  pBuffer: pointer to the buffer that receives the value.
+  * @param  BufferSize: size of the buffer, a longer value is truncated.
+  * @param  pLength: pointer to the value length, may be 0.
+  * @retval sEE_OK (0) if the value was read, sEE_FAIL if the key is not set or
+  *         its record is corrupted.
+  */
+uint32_t sEE_KVGet(uint16_t Key, uint8_t* pBuffer, uint8_t BufferSize, uint8_t* pLength)
+{
+  uint8_t length = 0;
+
+  if ((Key >= sEE_KV_KEYS) || (sEEKVIndex[Key] == 0))
+  {
+    return sEE_FAIL;
+  }
+
+  if (sEE_KVReadRecord(sEEKVBank, sEEKVGeneration, sEEKVIndex[Key]) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  length = sEEKVLength[Key];
+  memcpy(pBuffer, &sEEKVBuffer[2], (length < BufferSize) ? length : BufferSize);
+  if (pLength != 0)
+  {
+    *pLength = length;
+  }
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Sets the value of a key. Nothing is written if the value is not
+  *         changed, the bank is compacted if full.
+  * @param  Key: key, from 0 to sEE_KV_KEYS - 1.
+  * @param  pData: pointer to the value.
+  * @param  Length: value length, from 0 to sEE_KV_MAX_VALUE.
+  * @retval sEE_OK (0) if the value was written, sEE_FAIL otherwise.
+  */
+uint32_t sEE_KVSet(uint16_t Key, const uint8_t* pData, uint8_t Length)
+{
+  if ((Key >= sEE_KV_KEYS) || (Length > sEE_KV_MAX_VALUE))
+  {
+    return sEE_FAIL;
+  }
+
+  /* Saves an EEPROM write cycle when the application saves its settings
+     without change */
+  if ((sEEKVIndex[Key] != 0) && (sEEKVLength[Key] == Length) &&
+      (sEE_KVReadRecord(sEEKVBank, sEEKVGeneration, sEEKVIndex[Key]) == sEE_OK) &&
+      (memcmp(&sEEKVBuffer[2], pData, Length) == 0))
+  {
+    return sEE_OK;
+  }
+
+  return sEE_KVAppend(Key, sEE_KV_TYPE_VALUE, pData, Length);
+}
+
+/**
+  * @brief  Deletes a key.
+  * @param  Key: key, from 0 to sEE_KV_KEYS - 1.
+  * @retval sEE_OK (0) if the key is deleted, sEE_FAIL otherwise.
+  */
+uint32_t sEE_KVDelete(uint16_t Key)
+{
+  if (Key >= sEE_KV_KEYS)
+  {
+    return sEE_FAIL;
+  }
+
+  if (sEEKVIndex[Key] == 0)
+  {
+    return sEE_OK;
+  }
+
+  return sEE_KVAppend(Key, sEE_KV_TYPE_DELETE, 0, 0);
+}
+
+/**
+  * @brief  Copies the last record of each key to the other bank, which then
+  *         becomes the active bank.
+  * @param  None
+  * @retval sEE_OK (0) if the store was compacted, sEE_FAIL otherwise (the
+  *         active bank is unchanged).
+  */
+uint32_t sEE_KVCompact(void)
+{
+  uint16_t index[sEE_KV_KEYS];
+  uint16_t offset = sEE_KV_BANK_HEADER_SIZE, size = 0, key = 0;
+  uint8_t bank = sEEKVBank ^ 1;
+  uint32_t generation = sEEKVGeneration + 1;
+
+  /* The target bank may hold a valid header of an older generation: it is
+     invalidated before its records are overwritten */
+  if (sEE_KVWriteHeader(bank, 0) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  for (key = 0; key < sEE_KV_KEYS; key++)
+  {
+    index[key] = 0;
+    if (sEEKVIndex[key] == 0)
+    {
+      continue;
+    }
+
+    if (sEE_KVReadRecord(sEEKVBank, sEEKVGeneration, sEEKVIndex[key]) != sEE_OK)
+    {
+      /* Corrupted value, not readable by sEE_KVGet() either: dropped */
+      continue;
+    }
+
+    size = sEE_KV_RECORD_SIZE(sEEKVLength[key]);
+    sEEKVBuffer[1] = sEE_KVRecordCRC(generation);
+    if (sEE_KVWrite(sEE_KV_BANK_ADDRESS(bank) + offset, (uint8_t*)sEEKVBuffer, size) != sEE_OK)
+    {
+      return sEE_FAIL;
+    }
+    index[key] = offset;
+    offset += size;
+  }
+
+  /* Commit point */
+  if (sEE_KVWriteHeader(bank, generation) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  sEEKVBank = bank;
+  sEEKVGeneration = generation;
+  sEEKVTail = offset;
+  for (key = 0; key < sEE_KV_KEYS; key++)
+  {
+    sEEKVIndex[key] = index[key];
+    if (index[key] == 0)
+    {
+      sEEKVLength[key] = 0;
+    }
+  }
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Returns the free space in the active bank.
+  * @param  None
+  * @retval Free bytes, a value of Length bytes takes 8 bytes + Length rounded
+  *         up to 4.
+  */
+uint16_t sEE_KVGetFree(void)
+{
+  return sEE_KV_BANK_SIZE - sEEKVTail;
+}
+
+/**
+  * @brief  Appends a record to the active bank, compacted first if full.
+  * @param  Key: key.
+  * @param  Type: sEE_KV_TYPE_VALUE or sEE_KV_TYPE_DELETE.
+  * @param  pData: pointer to the value.
+  * @param  Length: value length, 0 for sEE_KV_TYPE_DELETE.
+  * @retval sEE_OK (0) if the record was written, sEE_FAIL otherwise.
+  */
+static uint32_t sEE_KVAppend(uint16_t Key, uint8_t Type, const uint8_t* pData, uint8_t Length)
+{
+  uint16_t size = sEE_KV_RECORD_SIZE(Length);
+
+  if ((sEEKVTail + size) > sEE_KV_BANK_SIZE)
+  {
+    if ((sEE_KVCompact() != sEE_OK) || ((sEEKVTail + size) > sEE_KV_BANK_SIZE))
+    {
+      return sEE_FAIL;
+    }
+  }
+
+  sEEKVBuffer[0] = sEE_KV_INFO(Key, Length, Type);
+  sEEKVBuffer[(size / 4) - 1] = 0xFFFFFFFF;   /* padding */
+  memcpy(&sEEKVBuffer[2], pData, Length);
+  sEEKVBuffer[1] = sEE_KVRecordCRC(sEEKVGeneration);
+
+  /* A record torn by a reset is invalid and ends the log, a failed record is
+     overwritten by the next one */
+  if (sEE_KVWrite(sEE_KV_BANK_ADDRESS(sEEKVBank) + sEEKVTail, (uint8_t*)sEEKVBuffer, size) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  sEEKVIndex[Key] = (Type == sEE_KV_TYPE_VALUE) ? sEEKVTail : 0;
+  sEEKVLength[Key] = Length;
+  sEEKVTail += size;
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Reads and checks a record in sEEKVBuffer.
+  * @param  Bank: bank number.
+  * @param  Generation: generation of the bank.
+  * @param  Offset: record offset in the bank.
+  * @retval sEE_OK (0) if the record is valid, sEE_FAIL otherwise.
+  */
+static uint32_t sEE_KVReadRecord(uint8_t Bank, uint32_t Generation, uint16_t Offset)
+{
+  uint32_t info = 0;
+  uint16_t address = sEE_KV_BANK_ADDRESS(Bank) + Offset;
+  uint8_t length = 0, type = 0;
+
+  if ((Offset + sEE_KV_RECORD_HEADER_SIZE) > sEE_KV_BANK_SIZE)
+  {
+    return sEE_FAIL;
+  }
+
+  if (sEE_KVRead(address, (uint8_t*)sEEKVBuffer, sEE_KV_RECORD_HEADER_SIZE) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  /* Bounds first: the header may be garbage */
+  info = sEEKVBuffer[0];
+  length = sEE_KV_INFO_LENGTH(info);
+  type = sEE_KV_INFO_TYPE(info);
+  if ((sEE_KV_INFO_KEY(info) >= sEE_KV_KEYS) || (length > sEE_KV_MAX_VALUE) ||
+      ((type != sEE_KV_TYPE_VALUE) && ((type != sEE_KV_TYPE_DELETE) || (length != 0))) ||
+      ((Offset + sEE_KV_RECORD_SIZE(length)) > sEE_KV_BANK_SIZE))
+  {
+    return sEE_FAIL;
+  }
+
+  if ((length > 0) &&
+      (sEE_KVRead(address + sEE_KV_RECORD_HEADER_SIZE, (uint8_t*)&sEEKVBuffer[2], sEE_KV_DATA_SIZE(length)) != sEE_OK))
+  {
+    return sEE_FAIL;
+  }
+
+  return (sEEKVBuffer[1] == sEE_KVRecordCRC(Generation)) ? sEE_OK : sEE_FAIL;
+}
+
+/**
+  * @brief  Reads and checks a bank header.
+  * @param  Bank: bank number.
+  * @param  pGeneration: pointer to the bank generation, 0 if the header is
+  *         not valid.
+  * @retval sEE_OK (0) if the header was read, sEE_FAIL otherwise.
+  */
+static uint32_t sEE_KVReadHeader(uint8_t Bank, uint32_t* pGeneration)
+{
+  uint32_t header[sEE_KV_BANK_HEADER_SIZE / 4];
+
+  if (sEE_KVRead(sEE_KV_BANK_ADDRESS(Bank), (uint8_t*)header, sEE_KV_BANK_HEADER_SIZE) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  *pGeneration = 0;
+  CRC_ResetDR();
+  if ((header[0] == sEE_KV_MAGIC) && (CRC_CalcBlockCRC(header, 2) == header[2]))
+  {
+    *pGeneration = header[1];
+  }
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Writes a bank header.
+  * @param  Bank: bank number.
+  * @param  Generation: bank generation, 0 to invalidate the bank.
+  * @retval sEE_OK (0) if the header was written, sEE_FAIL otherwise.
+  */
+static uint32_t sEE_KVWriteHeader(uint8_t Bank, uint32_t Generation)
+{
+  uint32_t header[sEE_KV_BANK_HEADER_SIZE / 4] = {0, 0, 0};
+
+  if (Generation != 0)
+  {
+    header[0] = sEE_KV_MAGIC;
+    header[1] = Generation;
+    CRC_ResetDR();
+    header[2] = CRC_CalcBlockCRC(header, 2);
+  }
+
+  return sEE_KVWrite(sEE_KV_BANK_ADDRESS(Bank), (uint8_t*)header, sEE_KV_BANK_HEADER_SIZE);
+}
+
+/**
+  * @brief  Computes the CRC of the record in sEEKVBuffer: generation, record
+  *         header and data words.
+  * @param  Generation: generation of the bank holding the record.
+  * @retval CRC-32.
+  */
+static uint32_t sEE_KVRecordCRC(uint32_t Generation)
+{
+  CRC_ResetDR();
+  CRC_CalcCRC(Generation);
+  CRC_CalcCRC(sEEKVBuffer[0]);
+
+  return CRC_CalcBlockCRC(&sEEKVBuffer[2], sEE_KV_DATA_SIZE(sEE_KV_INFO_LENGTH(sEEKVBuffer[0])) / 4);
+}
+
+/**
+  * @brief  Reads EEPROM data and waits for the end of the read.
+  * @param  Address: EEPROM address.
+  * @param  pBuffer: pointer to the buffer that receives the data.
+  * @param  NumByteToRead: number of bytes to read.
+  * @retval sEE_OK (0) if the data was read, sEE_FAIL otherwise.
+  */
+static uint32_t sEE_KVRead(uint16_t Address, uint8_t* pBuffer, uint16_t NumByteToRead)
+{
+  sEEKVCount = NumByteToRead;
+  if (sEE_ReadBuffer(pBuffer, Address, (uint16_t*)(&sEEKVCount)) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  /* On timeout only the read is cancelled: pBuffer may be on the caller
+     stack, the other I2C transfers go on */
+  if ((sEE_WaitRead() != sEE_OK) || (sEEKVCount > 0))
+  {
+    return sEE_FAIL;
+  }
+
+  return sEE_OK;
+}
+
+/**
+  * @brief  Writes EEPROM data and waits for the end of the write cycle.
+  * @param  Address: EEPROM address.
+  * @param  pBuffer: pointer to the data.
+  * @param  NumByteToWrite: number of bytes to write.
+  * @retval sEE_OK (0) if the data was written, sEE_FAIL otherwise.
+  */
+static uint32_t sEE_KVWrite(uint16_t Address, uint8_t* pBuffer, uint16_t NumByteToWrite)
+{
+  /* End of a background write first */
+  sEE_WaitWrite();
+
+  sEEKVCount = NumByteToWrite;
+  if (sEE_WriteBufferAsync(pBuffer, Address, (uint16_t*)(&sEEKVCount)) != sEE_OK)
+  {
+    return sEE_FAIL;
+  }
+
+  if ((sEE_WaitWrite() != sEE_OK) || (sEEKVCount > 0))
+  {
+    return sEE_FAIL;
+  }
+
+  return sEE_WaitEepromStandbyState();
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
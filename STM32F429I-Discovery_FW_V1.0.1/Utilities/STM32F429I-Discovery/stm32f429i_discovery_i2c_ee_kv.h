@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file    stm32f429i_discovery_i2c_ee_kv.h
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    28-October-2013
+  * @brief   This file contains all the functions prototypes for
+  *          the stm32f429i_discovery_i2c_ee_kv.c firmware driver.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F429I_DISCOVERY_I2C_EE_KV_H
+#define __STM32F429I_DISCOVERY_I2C_EE_KV_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f429i_discovery_i2c_ee.h"
+
+/** @addtogroup Utilities
+  * @{
+  */
+
+/** @addtogroup STM32F4_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY_I2C_EE_KV
+  * @{
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Exported_Types
+  * @{
+  */
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Exported_Constants
+  * @{
+  */
+
+/* The store uses two banks of sEE_KV_EE_SIZE / 2 bytes from sEE_KV_EE_ADDRESS.
+   The records are appended to the active bank, the compaction copies the
+   last value of each key to the other bank which becomes active once
+   complete. The area must not overlap the other EEPROM users: the default one
+   follows the sEE cache records and ends before the touch panel calibration
+   (IOE_TP_CAL_EE_ADDRESS). */
+#ifndef sEE_KV_EE_ADDRESS
+ #define sEE_KV_EE_ADDRESS        0x0800
+#endif /* sEE_KV_EE_ADDRESS */
+
+#ifndef sEE_KV_EE_SIZE
+ #define sEE_KV_EE_SIZE           0x1000 /* two banks of 2 KB */
+#endif /* sEE_KV_EE_SIZE */
+
+/* Keys are 0 to sEE_KV_KEYS - 1: the RAM index is a table of sEE_KV_KEYS
+   entries */
+#ifndef sEE_KV_KEYS
+ #define sEE_KV_KEYS              32
+#endif /* sEE_KV_KEYS */
+
+#ifndef sEE_KV_MAX_VALUE
+ #define sEE_KV_MAX_VALUE         64     /* bytes, at most 255 */
+#endif /* sEE_KV_MAX_VALUE */
+
+#define sEE_KV_BANK_SIZE          (sEE_KV_EE_SIZE / 2)
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Exported_Macros
+  * @{
+  */
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_I2C_EE_KV_Exported_Functions
+  * @{
+  */
+uint32_t sEE_KVInit(void);
+uint32_t sEE_KVFormat(void);
+uint32_t sEE_KVGet(uint16_t Key, uint8_t* pBuffer, uint8_t BufferSize, uint8_t* pLength);
+uint32_t sEE_KVSet(uint16_t Key, const uint8_t* pData, uint8_t Length);
+uint32_t sEE_KVDelete(uint16_t Key);
+uint32_t sEE_KVCompact(void);
+uint16_t sEE_KVGetFree(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F429I_DISCOVERY_I2C_EE_KV_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
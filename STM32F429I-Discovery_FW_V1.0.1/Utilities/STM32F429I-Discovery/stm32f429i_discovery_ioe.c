@@ -30,15 +30,27 @@
   
     Note:
     -----
-    - This driver uses the DMA method for sending and receiving data on I2C bus
-      which allow higher efficiency and reliability of the communication.  
+    - This driver queues its transfers on the I2C bus engine shared with the
+      I2C EEPROM driver (stm32f429i_discovery_i2c.c): the transfers run from
+      the I2C interrupts, with DMA for the bursts. The register functions
+      wait for the end of their transfer, the touch Panel FIFO is read in
+      the background after each touch Panel interrupt.
   
     SUPPORTED FEATURES:
       - Touch Panel Features: Single point mode (Polling/Interrupt)
+      - Touch Panel FIFO: batches of samples read in one I2C DMA burst,
+        on FIFO threshold or touch interrupt
+      - Touch Panel calibration: 3 points affine transform, optionally saved
+        in the I2C EEPROM
+      - Touch Panel gestures: press, tap, long press, drag, fling and release
+        events queued from the filtered FIFO samples
   ----------------------------------------------------------------------------*/
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery_ioe.h"
+#ifdef USE_TP_CALIBRATION_EEPROM
+#include "stm32f429i_discovery_i2c_ee.h"
+#endif /* USE_TP_CALIBRATION_EEPROM */
 
 /** @addtogroup Utilities
   * @{
@@ -62,6 +74,44 @@
 /** @defgroup STM32F429I_DISCOVERY_IOE_Private_TypesDefinitions
   * @{
   */ 
+/* Gesture recognizer contact states */
+typedef enum
+{
+  TP_CONTACT_NONE = 0,
+  TP_CONTACT_PRESSED,
+  TP_CONTACT_LONG_PRESSED,
+  TP_CONTACT_DRAGGING
+}TP_Contact_TypeDef;
+
+/* Gesture recognizer state */
+typedef struct
+{
+  TP_Contact_TypeDef Contact;
+  uint8_t  NumSamples;       /* samples in the median window */
+  uint16_t MedianX[3];
+  uint16_t MedianY[3];
+  int32_t  X;                /* IIR filtered position, 4 fractional bits */
+  int32_t  Y;
+  int32_t  LastX;            /* filtered position at the last update */
+  int32_t  LastY;
+  int32_t  VX;               /* filtered velocity, pixels per second */
+  int32_t  VY;
+  uint32_t LastTime;
+  int32_t  StartX;           /* filtered position of the first contact */
+  int32_t  StartY;
+  uint32_t StartTime;
+}TP_Gesture_TypeDef;
+
+/* Touch Panel FIFO reading steps, run from the I2C interrupts */
+typedef enum
+{
+  TP_FIFO_IDLE = 0,
+  TP_FIFO_SIZE,              /* reading FIFO_SIZE */
+  TP_FIFO_DATA,              /* reading the samples */
+  TP_FIFO_CTRL,              /* reading TP_CTRL */
+  TP_FIFO_ACK,               /* clearing INT_STA */
+  TP_FIFO_READY              /* batch waiting for IOE_TP_GetSamples */
+}TP_FIFOState_TypeDef;
 /**
   * @}
   */ 
@@ -71,6 +121,11 @@
   * @{
   */ 
 #define TIMEOUT_MAX    0x3000 /*<! The value of the maximal timeout for I2C waiting loops */
+
+#define TP_CAL_MAGIC   0x31435054 /*<! "TPC1": saved calibration record signature */
+
+#define TP_IIR_SHIFT   2          /*<! position IIR filter: 1/4 of each new sample */
+#define TP_MAX_SPEED   10000      /*<! velocity estimate limit, pixels per second */
 /**
   * @}
   */ 
@@ -79,6 +134,7 @@
 /** @defgroup STM32F429I_DISCOVERY_IOE_Private_Macros
   * @{
   */ 
+#define IOE_ABS(X)  ((X) > 0 ? (X) : -(X))
 /**
   * @}
   */ 
@@ -89,6 +145,32 @@
 TP_STATE TP_State;              /* The global structure holding the TS state */
 
 uint32_t IOE_TimeOut = TIMEOUT_MAX; /* Value of Timeout when I2C communication fails */
+
+static uint8_t IOE_FIFOBuffer[IOE_TP_BATCH_SIZE * IOE_TP_SAMPLE_SIZE]; /* packed samples of a burst */
+static uint8_t IOE_FIFOThreshold = 1;
+static I2CBus_Transfer_TypeDef IOE_FIFOTransfer;
+static __IO TP_FIFOState_TypeDef IOE_FIFOState = TP_FIFO_IDLE;
+static __IO uint8_t IOE_FIFOPending = 0; /* touch interrupt during a batch */
+static uint8_t IOE_FIFOSize = 0;         /* FIFO_SIZE register */
+static uint8_t IOE_FIFOControl = 0;      /* TP_CTRL register */
+static uint8_t IOE_FIFOAck = IOE_GIT_TOUCH | IOE_GIT_FTH;
+static uint8_t IOE_FIFOCount = 0;        /* samples of the batch */
+static uint8_t IOE_FIFOIndex = 0;        /* samples already returned */
+
+/* Default calibration: X = (3870 - x) / 15, Y = (y - 360) / 11. Above
+   IOE_TP_DEFAULT_X_KNEE the panel reads X as (3800 - x) / 15 instead, so the
+   default calibration moves those raw values by IOE_TP_DEFAULT_X_OFFSET. */
+static TP_CALIBRATION IOE_Calibration = 
+{
+  -(1 << IOE_TP_CAL_SHIFT) / 15, 0, (3870 << IOE_TP_CAL_SHIFT) / 15,
+  0, (1 << IOE_TP_CAL_SHIFT) / 11, -(360 << IOE_TP_CAL_SHIFT) / 11
+};
+static uint8_t IOE_DefaultCalibration = 1; /* no calibration set yet */
+
+static TP_Gesture_TypeDef IOE_Gesture;
+static TP_GESTURE IOE_GestureQueue[IOE_TP_GESTURE_QUEUE_SIZE];
+static uint8_t IOE_GestureHead = 0;       /* next event to read */
+static uint8_t IOE_GestureCount = 0;      /* queued events */
 /**
   * @}
   */ 
@@ -97,12 +179,16 @@ uint32_t IOE_TimeOut = TIMEOUT_MAX; /* Value of Timeout when I2C communication f
 /** @defgroup STM32F429I_DISCOVERY_IOE_Private_FunctionPrototypes
   * @{
   */ 
-static uint16_t IOE_TP_Read_X(void);
-static uint16_t IOE_TP_Read_Y(void);
 static uint16_t IOE_TP_Read_Z(void);
-static void     IOE_GPIO_Config(void);
-static void     IOE_I2C_Config(void);
-static void     IOE_DMA_Config(IOE_DMADirection_TypeDef Direction, uint8_t* buffer);
+static void     IOE_TP_Unpack(const uint8_t *pData, TP_SAMPLE *pSamples, uint8_t NumSamples);
+static void     IOE_TP_FIFORead(TP_FIFOState_TypeDef State);
+static void     IOE_TP_FIFOCallback(I2CBus_Transfer_TypeDef *pTransfer);
+static uint8_t  IOE_TP_FIFOTake(TP_SAMPLE *pSamples, uint8_t MaxSamples, uint8_t *pCount, uint8_t *pTouched);
+static void     IOE_EXTI_Config(void);
+static uint8_t  IOE_Transfer(uint8_t Flags, uint8_t RegisterAddr, uint8_t *pBuffer, uint16_t Size);
+static void     IOE_TP_GestureSample(const TP_SAMPLE *pSample);
+static void     IOE_TP_PostGesture(TP_GestureType_TypeDef Type, uint32_t Time);
+static uint16_t IOE_Median3(const uint16_t *pValues);
 
 #ifndef USE_Delay
 static void delay(__IO uint32_t nCount);
@@ -126,11 +212,9 @@ static void delay(__IO uint32_t nCount);
   */
 uint8_t IOE_Config(void)
 {
-  /* Configure the needed pins */
-  IOE_GPIO_Config(); 
-  
-  /* I2C initialization */
-  IOE_I2C_Config();
+  /* I2C bus initialization (pins, I2C, DMA and interrupts), may already be
+     done by the I2C EEPROM driver */
+  I2CBus_Init();
     
   /* Read IO Expander ID  */
   if(IOE_IsOperational())
@@ -179,14 +263,19 @@ TP_STATE* IOE_TP_GetState(void)
 {
   uint32_t xDiff, yDiff , x , y;
   static uint32_t _x = 0, _y = 0;
+  TP_SAMPLE sample;
   
   /* Check if the Touch detect event happened */
   TP_State.TouchDetected = (I2C_ReadDeviceRegister(IOE_REG_TP_CTRL) & 0x80);
   
   if(TP_State.TouchDetected) 
   {
-    x = IOE_TP_Read_X();
-    y = IOE_TP_Read_Y();
+    /* Read x and y values from DATA_X and DATA_Y registers */
+    sample.X = I2C_ReadDataBuffer(IOE_REG_TP_DATA_X);
+    sample.Y = I2C_ReadDataBuffer(IOE_REG_TP_DATA_Y);
+    IOE_TP_CalibrateSamples(&sample, 1);
+    x = sample.X;
+    y = sample.Y;
     xDiff = x > _x? (x - _x): (_x - x);
     yDiff = y > _y? (y - _y): (_y - y);       
     if (xDiff + yDiff > 5)
@@ -211,6 +300,452 @@ TP_STATE* IOE_TP_GetState(void)
   return &TP_State; 
 }
 
+/**
+  * @brief  Configures the touch Panel FIFO for batch reading: the FIFO
+  *         threshold and touch interrupts are routed to the IOE_IT EXTI line.
+  * @note   IOE_TP_FIFOIRQHandler must be called from the IOE_IT EXTI
+  *         interrupt handler.
+  * @param  Threshold: FIFO samples that trigger an interrupt (1 to IOE_TP_BATCH_SIZE).
+  * @retval IOE_OK: if all initializations are OK. Other value if error.
+  */
+uint8_t IOE_TP_FIFOConfig(uint8_t Threshold)
+{
+  if ((Threshold == 0) || (Threshold > IOE_TP_BATCH_SIZE))
+  {
+    return PARAM_ERROR;
+  }
+  IOE_FIFOThreshold = Threshold;
+  
+  /* Interrupt when Threshold samples are queued */
+  I2C_WriteDeviceRegister(IOE_REG_FIFO_TH, Threshold);
+  
+  /* Clear the FIFO memory content and put it back into operation mode */
+  I2C_WriteDeviceRegister(IOE_REG_FIFO_STA, 0x01);
+  I2C_WriteDeviceRegister(IOE_REG_FIFO_STA, 0x00);
+  
+  /* Threshold interrupt for the batches, touch interrupt for the samples
+     left in the FIFO when the touch is released */
+  IOE_GITConfig((uint8_t)(IOE_GIT_TOUCH | IOE_GIT_FTH), ENABLE);
+  I2C_WriteDeviceRegister(IOE_REG_INT_STA, 0xFF);
+  
+  IOE_FIFOPending = 0;
+  IOE_FIFOState = TP_FIFO_IDLE;
+  IOE_EXTI_Config();
+  
+  /* Level interrupt, active low */
+  I2C_WriteDeviceRegister(IOE_REG_INT_CTRL, Polarity_Low | Type_Level);
+  IOE_GITCmd(ENABLE);
+  
+  return IOE_OK;
+}
+
+/**
+  * @brief  Reads the samples queued in the touch Panel FIFO.
+  * @note   The packed X/Y/Z samples are read in one I2C DMA burst, instead
+  *         of one register transaction per coordinate.
+  * @param  pSamples: pointer to the samples buffer.
+  * @param  MaxSamples: size of the samples buffer.
+  * @retval Number of samples read (at most IOE_TP_BATCH_SIZE).
+  */
+uint8_t IOE_TP_ReadFIFO(TP_SAMPLE *pSamples, uint8_t MaxSamples)
+{
+  uint8_t buffer[IOE_TP_BATCH_SIZE * IOE_TP_SAMPLE_SIZE];
+  uint32_t count = 0;
+  
+  count = I2C_ReadDeviceRegister(IOE_REG_FIFO_SIZE);
+  if (count > MaxSamples)
+  {
+    count = MaxSamples;
+  }
+  if (count > IOE_TP_BATCH_SIZE)
+  {
+    count = IOE_TP_BATCH_SIZE;
+  }
+  if (count == 0)
+  {
+    return 0;
+  }
+  
+  if (I2C_DMA_ReadBuffer(IOE_REG_TP_DATA_FIFO, buffer, count * IOE_TP_SAMPLE_SIZE) != IOE_OK)
+  {
+    return 0;
+  }
+  
+  IOE_TP_Unpack(buffer, pSamples, (uint8_t)count);
+  
+  return (uint8_t)count;
+}
+
+/**
+  * @brief  Returns the touch Panel FIFO samples read in the background after
+  *         the last FIFO threshold or touch interrupt.
+  * @note   The samples not returned are kept for the next call.
+  * @param  pSamples: pointer to the samples buffer.
+  * @param  MaxSamples: size of the samples buffer.
+  * @retval Number of samples read, 0 if no batch is ready.
+  */
+uint8_t IOE_TP_GetSamples(TP_SAMPLE *pSamples, uint8_t MaxSamples)
+{
+  uint8_t count = 0, touched = 0;
+  
+  IOE_TP_FIFOTake(pSamples, MaxSamples, &count, &touched);
+  
+  return count;
+}
+
+/**
+  * @brief  Handles the touch Panel interrupt: the FIFO reading is queued on
+  *         the I2C bus, the samples are then returned by IOE_TP_GetSamples.
+  * @param  None
+  * @retval None
+  */
+void IOE_TP_FIFOIRQHandler(void)
+{
+  if (EXTI_GetITStatus(IOE_IT_EXTI_LINE) != RESET)
+  {
+    EXTI_ClearITPendingBit(IOE_IT_EXTI_LINE);
+    
+    /* The I2C interrupts preempt this one, not the other way round */
+    if (IOE_FIFOState == TP_FIFO_IDLE)
+    {
+      IOE_TP_FIFORead(TP_FIFO_SIZE);
+    }
+    else
+    {
+      IOE_FIFOPending = 1;
+    }
+  }
+}
+
+/**
+  * @brief  Computes the touch Panel calibration from 3 touched targets.
+  * @note   The targets should be far apart and not aligned, e.g. near three
+  *         corners of the screen. Each raw value is best averaged over a
+  *         FIFO batch.
+  * @param  pRaw: raw ADC values of the 3 touches.
+  * @param  pScreen: screen coordinates of the 3 targets (X and Y only).
+  * @param  pCalibration: pointer to the calibration to compute.
+  * @retval IOE_OK if the calibration is valid, PARAM_ERROR if the points are aligned.
+  */
+uint8_t IOE_TP_Calibrate(const TP_SAMPLE *pRaw, const TP_SAMPLE *pScreen, TP_CALIBRATION *pCalibration)
+{
+  int64_t x0 = pRaw[0].X, x1 = pRaw[1].X, x2 = pRaw[2].X;
+  int64_t y0 = pRaw[0].Y, y1 = pRaw[1].Y, y2 = pRaw[2].Y;
+  int64_t X0 = pScreen[0].X, X1 = pScreen[1].X, X2 = pScreen[2].X;
+  int64_t Y0 = pScreen[0].Y, Y1 = pScreen[1].Y, Y2 = pScreen[2].Y;
+  int64_t k = 0;
+  
+  /* Determinant of the raw points: null when they are aligned */
+  k = (x0 - x2) * (y1 - y2) - (x1 - x2) * (y0 - y2);
+  if (k == 0)
+  {
+    return PARAM_ERROR;
+  }
+  
+  /* Cramer's rule, coefficients scaled to Q(IOE_TP_CAL_SHIFT). Half a unit
+     is added to C and F so that the transform rounds to nearest. */
+  pCalibration->A = (int32_t)((((X0 - X2) * (y1 - y2) - (X1 - X2) * (y0 - y2)) * ((int64_t)1 << IOE_TP_CAL_SHIFT)) / k);
+  pCalibration->B = (int32_t)((((x0 - x2) * (X1 - X2) - (X0 - X2) * (x1 - x2)) * ((int64_t)1 << IOE_TP_CAL_SHIFT)) / k);
+  pCalibration->C = (int32_t)((((y0 * (x2 * X1 - x1 * X2) + y1 * (x0 * X2 - x2 * X0) +
+                                 y2 * (x1 * X0 - x0 * X1)) * ((int64_t)1 << IOE_TP_CAL_SHIFT)) / k) +
+                              (1 << (IOE_TP_CAL_SHIFT - 1)));
+  pCalibration->D = (int32_t)((((Y0 - Y2) * (y1 - y2) - (Y1 - Y2) * (y0 - y2)) * ((int64_t)1 << IOE_TP_CAL_SHIFT)) / k);
+  pCalibration->E = (int32_t)((((x0 - x2) * (Y1 - Y2) - (Y0 - Y2) * (x1 - x2)) * ((int64_t)1 << IOE_TP_CAL_SHIFT)) / k);
+  pCalibration->F = (int32_t)((((y0 * (x2 * Y1 - x1 * Y2) + y1 * (x0 * Y2 - x2 * Y0) +
+                                 y2 * (x1 * Y0 - x0 * Y1)) * ((int64_t)1 << IOE_TP_CAL_SHIFT)) / k) +
+                              (1 << (IOE_TP_CAL_SHIFT - 1)));
+  
+  return IOE_OK;
+}
+
+/**
+  * @brief  Selects the calibration used to convert the touch Panel samples.
+  * @param  pCalibration: pointer to the calibration.
+  * @retval None
+  */
+void IOE_TP_SetCalibration(const TP_CALIBRATION *pCalibration)
+{
+  IOE_Calibration = *pCalibration;
+  IOE_DefaultCalibration = 0;
+}
+
+/**
+  * @brief  Returns the calibration used to convert the touch Panel samples.
+  * @param  pCalibration: pointer to the calibration to fill.
+  * @retval None
+  */
+void IOE_TP_GetCalibration(TP_CALIBRATION *pCalibration)
+{
+  *pCalibration = IOE_Calibration;
+}
+
+/**
+  * @brief  Converts raw touch Panel samples to screen coordinates, clamped to
+  *         the screen.
+  * @param  pSamples: samples to convert in place (a FIFO batch).
+  * @param  NumSamples: number of samples.
+  * @retval None
+  */
+void IOE_TP_CalibrateSamples(TP_SAMPLE *pSamples, uint8_t NumSamples)
+{
+  int32_t a = IOE_Calibration.A, b = IOE_Calibration.B, c = IOE_Calibration.C;
+  int32_t d = IOE_Calibration.D, e = IOE_Calibration.E, f = IOE_Calibration.F;
+  int32_t x = 0, y = 0, rawx = 0;
+  
+  for (; NumSamples != 0; NumSamples--, pSamples++)
+  {
+    rawx = pSamples->X;
+    if ((IOE_DefaultCalibration != 0) && (rawx > IOE_TP_DEFAULT_X_KNEE))
+    {
+      rawx += IOE_TP_DEFAULT_X_OFFSET;
+    }
+    
+    x = (a * rawx + b * pSamples->Y + c) >> IOE_TP_CAL_SHIFT;
+    y = (d * rawx + e * pSamples->Y + f) >> IOE_TP_CAL_SHIFT;
+    
+    if (x < 0)
+    {
+      x = 0;
+    }
+    else if (x >= IOE_TP_SCREEN_WIDTH)
+    {
+      x = IOE_TP_SCREEN_WIDTH - 1;
+    }
+    if (y < 0)
+    {
+      y = 0;
+    }
+    else if (y >= IOE_TP_SCREEN_HEIGHT)
+    {
+      y = IOE_TP_SCREEN_HEIGHT - 1;
+    }
+    
+    pSamples->X = (uint16_t)x;
+    pSamples->Y = (uint16_t)y;
+  }
+}
+
+/**
+  * @brief  Resets the touch Panel gesture recognizer and its event queue.
+  * @note   The touch Panel FIFO must be configured with IOE_TP_FIFOConfig.
+  * @param  None
+  * @retval None
+  */
+void IOE_TP_GestureInit(void)
+{
+  IOE_Gesture.Contact = TP_CONTACT_NONE;
+  IOE_Gesture.NumSamples = 0;
+  IOE_GestureHead = 0;
+  IOE_GestureCount = 0;
+}
+
+/**
+  * @brief  Runs the touch Panel gesture recognizer.
+  * @note   The FIFO batch read from the I2C interrupts after a touch Panel
+  *         interrupt is converted to screen coordinates, denoised (median
+  *         of 3 then IIR filter) and the contact state is updated. Without
+  *         new batch only the long press timeout is checked: this function
+  *         never waits for the I2C bus.
+  * @param  Time: current time in ms (SysTick based counter for example).
+  * @retval Number of events waiting in the queue.
+  */
+uint8_t IOE_TP_GestureUpdate(uint32_t Time)
+{
+  TP_SAMPLE samples[IOE_TP_BATCH_SIZE];
+  uint32_t index = 0, dt = 0;
+  uint8_t count = 0, touched = 1;
+  int32_t vx = 0, vy = 0, speed = 0;
+  
+  if (IOE_TP_FIFOTake(samples, IOE_TP_BATCH_SIZE, &count, &touched) != 0)
+  {
+    IOE_TP_CalibrateSamples(samples, count);
+    for (index = 0; index < count; index++)
+    {
+      IOE_TP_GestureSample(&samples[index]);
+    }
+  }
+  
+  if (count != 0)
+  {
+    if (IOE_Gesture.Contact == TP_CONTACT_NONE)
+    {
+      /* First contact */
+      IOE_Gesture.Contact = TP_CONTACT_PRESSED;
+      IOE_Gesture.StartX = IOE_Gesture.LastX = IOE_Gesture.X;
+      IOE_Gesture.StartY = IOE_Gesture.LastY = IOE_Gesture.Y;
+      IOE_Gesture.StartTime = IOE_Gesture.LastTime = Time;
+      IOE_Gesture.VX = IOE_Gesture.VY = 0;
+      IOE_TP_PostGesture(TP_GESTURE_PRESS, Time);
+    }
+    else
+    {
+      /* Velocity over the batch, averaged with the previous estimate */
+      dt = Time - IOE_Gesture.LastTime;
+      if (dt != 0)
+      {
+        vx = (((IOE_Gesture.X - IOE_Gesture.LastX) * 1000) / (int32_t)dt) >> 4;
+        vy = (((IOE_Gesture.Y - IOE_Gesture.LastY) * 1000) / (int32_t)dt) >> 4;
+        vx = (vx > TP_MAX_SPEED) ? TP_MAX_SPEED : ((vx < -TP_MAX_SPEED) ? -TP_MAX_SPEED : vx);
+        vy = (vy > TP_MAX_SPEED) ? TP_MAX_SPEED : ((vy < -TP_MAX_SPEED) ? -TP_MAX_SPEED : vy);
+        IOE_Gesture.VX = (IOE_Gesture.VX + vx) / 2;
+        IOE_Gesture.VY = (IOE_Gesture.VY + vy) / 2;
+      }
+      
+      if ((IOE_Gesture.Contact == TP_CONTACT_PRESSED) &&
+          ((IOE_ABS(IOE_Gesture.X - IOE_Gesture.StartX) + IOE_ABS(IOE_Gesture.Y - IOE_Gesture.StartY)) > 
+           (IOE_TP_DRAG_DISTANCE << 4)))
+      {
+        IOE_Gesture.Contact = TP_CONTACT_DRAGGING;
+      }
+      
+      if ((IOE_Gesture.Contact == TP_CONTACT_DRAGGING) &&
+          (((IOE_Gesture.X >> 4) != (IOE_Gesture.LastX >> 4)) || ((IOE_Gesture.Y >> 4) != (IOE_Gesture.LastY >> 4))))
+      {
+        IOE_TP_PostGesture(TP_GESTURE_DRAG, Time);
+      }
+      
+      IOE_Gesture.LastX = IOE_Gesture.X;
+      IOE_Gesture.LastY = IOE_Gesture.Y;
+      IOE_Gesture.LastTime = Time;
+    }
+  }
+  
+  if (IOE_Gesture.Contact == TP_CONTACT_NONE)
+  {
+    return IOE_GestureCount;
+  }
+  
+  if (touched == 0)
+  {
+    /* End of contact */
+    if ((IOE_Gesture.Contact == TP_CONTACT_PRESSED) && ((Time - IOE_Gesture.StartTime) <= IOE_TP_TAP_TIME))
+    {
+      IOE_TP_PostGesture(TP_GESTURE_TAP, Time);
+    }
+    else if (IOE_Gesture.Contact == TP_CONTACT_DRAGGING)
+    {
+      speed = IOE_Gesture.VX * IOE_Gesture.VX + IOE_Gesture.VY * IOE_Gesture.VY;
+      if (speed >= (IOE_TP_FLING_SPEED * IOE_TP_FLING_SPEED))
+      {
+        IOE_TP_PostGesture(TP_GESTURE_FLING, Time);
+      }
+    }
+    IOE_TP_PostGesture(TP_GESTURE_RELEASE, Time);
+    IOE_Gesture.Contact = TP_CONTACT_NONE;
+    IOE_Gesture.NumSamples = 0;
+  }
+  else if ((IOE_Gesture.Contact == TP_CONTACT_PRESSED) && 
+           ((Time - IOE_Gesture.StartTime) >= IOE_TP_LONG_PRESS_TIME))
+  {
+    IOE_Gesture.Contact = TP_CONTACT_LONG_PRESSED;
+    IOE_TP_PostGesture(TP_GESTURE_LONG_PRESS, Time);
+  }
+  
+  return IOE_GestureCount;
+}
+
+/**
+  * @brief  Takes the oldest event of the touch Panel gesture queue.
+  * @param  pGesture: pointer to the event to fill.
+  * @retval 1 if an event was returned, 0 if the queue is empty.
+  */
+uint8_t IOE_TP_GetGesture(TP_GESTURE *pGesture)
+{
+  if (IOE_GestureCount == 0)
+  {
+    return 0;
+  }
+  
+  *pGesture = IOE_GestureQueue[IOE_GestureHead];
+  IOE_GestureHead = (IOE_GestureHead + 1) % IOE_TP_GESTURE_QUEUE_SIZE;
+  IOE_GestureCount--;
+  
+  return 1;
+}
+
+#ifdef USE_TP_CALIBRATION_EEPROM
+/**
+  * @brief  Saves the current touch Panel calibration in the I2C EEPROM.
+  * @param  None
+  * @retval IOE_OK if the calibration was written, IOE_FAILURE otherwise.
+  */
+uint8_t IOE_TP_SaveCalibration(void)
+{
+  uint32_t record[8];
+  uint32_t index = 0;
+  __IO uint16_t NumDataWrite = sizeof(record);
+  
+  /* Signature, coefficients and checksum */
+  record[0] = TP_CAL_MAGIC;
+  record[1] = (uint32_t)IOE_Calibration.A;
+  record[2] = (uint32_t)IOE_Calibration.B;
+  record[3] = (uint32_t)IOE_Calibration.C;
+  record[4] = (uint32_t)IOE_Calibration.D;
+  record[5] = (uint32_t)IOE_Calibration.E;
+  record[6] = (uint32_t)IOE_Calibration.F;
+  record[7] = 0;
+  for (index = 0; index < 7; index++)
+  {
+    record[7] += record[index];
+  }
+  
+  /* End of a background write first. The record is on the stack: the write
+     is aborted by sEE_WaitWrite() if it does not end */
+  sEE_WaitWrite();
+  if ((sEE_WriteBufferAsync((uint8_t *)record, IOE_TP_CAL_EE_ADDRESS, (uint16_t *)(&NumDataWrite)) != sEE_OK) ||
+      (sEE_WaitWrite() != sEE_OK) || (NumDataWrite != 0))
+  {
+    return IOE_FAILURE;
+  }
+  
+  return IOE_OK;
+}
+
+/**
+  * @brief  Restores the touch Panel calibration saved in the I2C EEPROM.
+  * @param  None
+  * @retval IOE_OK if a valid calibration was restored, IOE_FAILURE otherwise
+  *         (the current calibration is kept).
+  */
+uint8_t IOE_TP_LoadCalibration(void)
+{
+  uint32_t record[8];
+  uint32_t index = 0, sum = 0;
+  __IO uint16_t NumDataRead = sizeof(record);
+  
+  if (sEE_ReadBuffer((uint8_t *)record, IOE_TP_CAL_EE_ADDRESS, (uint16_t *)(&NumDataRead)) != sEE_OK)
+  {
+    return IOE_FAILURE;
+  }
+  
+  /* Wait for the end of the DMA transfer. The record is on the stack: the
+     read is aborted by sEE_WaitRead() if it does not end */
+  if ((sEE_WaitRead() != sEE_OK) || (NumDataRead != 0))
+  {
+    return IOE_FAILURE;
+  }
+  
+  for (index = 0; index < 7; index++)
+  {
+    sum += record[index];
+  }
+  if ((record[0] != TP_CAL_MAGIC) || (record[7] != sum))
+  {
+    return IOE_FAILURE;
+  }
+  
+  IOE_Calibration.A = (int32_t)record[1];
+  IOE_Calibration.B = (int32_t)record[2];
+  IOE_Calibration.C = (int32_t)record[3];
+  IOE_Calibration.D = (int32_t)record[4];
+  IOE_Calibration.E = (int32_t)record[5];
+  IOE_Calibration.F = (int32_t)record[6];
+  IOE_DefaultCalibration = 0;
+  
+  return IOE_OK;
+}
+#endif /* USE_TP_CALIBRATION_EEPROM */
+
 /**
   * @brief  Checks the selected Global interrupt source pending bit
   * @param  Global_IT: the Global interrupt source to be checked, could be:
@@ -516,533 +1051,371 @@ uint8_t IOE_IOAFConfig(uint8_t IO_Pin, FunctionalState NewState)
 
 /**
   * @brief  Writes a value in a register of the device through I2C.
+  * @note   Kept for compatibility: the I2C bus engine uses the DMA by itself
+  *         for the longer transfers.
   * @param  RegisterAddr: The target register address
   * @param  RegisterValue: The target register value to be written 
   * @retval IOE_OK: if all operations are OK. Other value if error.
   */
 uint8_t I2C_DMA_WriteDeviceRegister(uint8_t RegisterAddr, uint8_t RegisterValue)
 {
-  uint32_t read_verif = 0;  
-  uint8_t IOE_BufferTX = 0;
-  
-  /* Get Value to be written */
-  IOE_BufferTX = RegisterValue;
-  
-  /* Configure DMA Peripheral */
-  IOE_DMA_Config(IOE_DMA_TX, (uint8_t*)(&IOE_BufferTX));
-  
-  /* Enable the I2C peripheral */
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
-  
-  /* Test on SB Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_SB) == RESET) 
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Transmit the slave address and enable writing operation */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Transmitter);
-  
-  /* Test on ADDR Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_CheckEvent(IOE_I2C, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Transmit the first address for r/w operations */
-  I2C_SendData(IOE_I2C, RegisterAddr);
-  
-  /* Test on TXE FLag (data dent) */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while ((!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_TXE)) && (!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_BTF)))  
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Enable I2C DMA request */
-  I2C_DMACmd(IOE_I2C,ENABLE);
-  
-  /* Enable DMA TX Channel */
-  DMA_Cmd(IOE_DMA_TX_STREAM, ENABLE);
-  
-  /* Wait until DMA Transfer Complete */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!DMA_GetFlagStatus(IOE_DMA_TX_STREAM,IOE_DMA_TX_TCFLAG))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }  
-  
-  /* Wait until BTF Flag is set before generating STOP */
-  IOE_TimeOut = 0xFF * TIMEOUT_MAX;
-  while ((!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_BTF)))  
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Send STOP Condition */
-  I2C_GenerateSTOP(IOE_I2C, ENABLE);
-  
-  /* Disable DMA TX Channel */
-  DMA_Cmd(IOE_DMA_TX_STREAM, DISABLE);
-  
-  /* Disable I2C DMA request */  
-  I2C_DMACmd(IOE_I2C,DISABLE);
-  
-  /* Clear DMA TX Transfer Complete Flag */
-  DMA_ClearFlag(IOE_DMA_TX_STREAM,IOE_DMA_TX_TCFLAG);
-  
-#ifdef VERIFY_WRITTENDATA
-  /* Verify (if needed) that the loaded data is correct  */
-  
-  /* Read the just written register*/
-  read_verif = I2C_ReadDeviceRegister(RegisterAddr);
-  /* Load the register and verify its value  */
-  if (read_verif != RegisterValue)
-  {
-    /* Control data wrongly transferred */
-    read_verif = IOE_FAILURE;
-  }
-  else
-  {
-    /* Control data correctly transferred */
-    read_verif = 0;
-  }
-#endif
-  
-  /* Return the verifying value: 0 (Passed) or 1 (Failed) */
-  return read_verif;
+  return I2C_WriteDeviceRegister(RegisterAddr, RegisterValue);
 }
 
 /**
   * @brief  Reads a register of the device through I2C.
+  * @note   Kept for compatibility, see I2C_DMA_WriteDeviceRegister().
   * @param  RegisterAddr: The target register address (between 00x and 0x24)
-  * @retval The value of the read register (0xAA if Timeout occurred)   
+  * @retval The value of the read register (0 if Timeout occurred)   
   */
 uint8_t I2C_DMA_ReadDeviceRegister(uint8_t RegisterAddr)
 {
-  uint8_t IOE_BufferRX[2] = {0x00, 0x00};  
-  
-  /* Configure DMA Peripheral */
-  IOE_DMA_Config(IOE_DMA_RX, (uint8_t*)IOE_BufferRX);
-  
-  /* Enable DMA NACK automatic generation */
-  I2C_DMALastTransferCmd(IOE_I2C, ENABLE);
-  
-  /* Enable the I2C peripheral */
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
-  
-  /* Test on SB Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_SB)) 
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Send device address for write */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Transmitter);
-  
-  /* Test on ADDR Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_CheckEvent(IOE_I2C, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED)) 
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Send the device's internal address to write to */
-  I2C_SendData(IOE_I2C, RegisterAddr);  
-  
-  /* Test on TXE FLag (data dent) */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while ((!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_TXE)) && (!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_BTF)))  
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Send START condition a second time */  
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
-  
-  /* Test on SB Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_SB)) 
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Send IOExpander address for read */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Receiver);
-  
-  /* Test on ADDR Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_CheckEvent(IOE_I2C, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED))   
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-    
-  /* Enable I2C DMA request */
-  I2C_DMACmd(IOE_I2C,ENABLE);
-  
-  /* Enable DMA RX Channel */
-  DMA_Cmd(IOE_DMA_RX_STREAM, ENABLE);
-  
-  /* Wait until DMA Transfer Complete */
-  IOE_TimeOut = 2 * TIMEOUT_MAX;
-  while (!DMA_GetFlagStatus(IOE_DMA_RX_STREAM,IOE_DMA_RX_TCFLAG))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }        
-  
-  /* Send STOP Condition */
-  I2C_GenerateSTOP(IOE_I2C, ENABLE);
-  
-  /* Disable DMA RX Channel */
-  DMA_Cmd(IOE_DMA_RX_STREAM, DISABLE);
-  
-  /* Disable I2C DMA request */  
-  I2C_DMACmd(IOE_I2C,DISABLE);
-  
-  /* Clear DMA RX Transfer Complete Flag */
- DMA_ClearFlag(IOE_DMA_RX_STREAM,IOE_DMA_RX_TCFLAG);
-  
-  /* return a pointer to the IOE_Buffer */
-  return (uint8_t)IOE_BufferRX[0];
+  return I2C_ReadDeviceRegister(RegisterAddr);
 }
 
-
 /**
   * @brief  Reads a buffer of 2 bytes from the device registers.
+  * @note   Kept for compatibility, see I2C_DMA_WriteDeviceRegister().
   * @param  RegisterAddr: The target register address (between 00x and 0x24)
   * @retval A pointer to the buffer containing the two returned bytes (in halfword).  
   */
 uint16_t I2C_DMA_ReadDataBuffer(uint32_t RegisterAddr)
 { 
-  uint8_t tmp= 0;
-  uint8_t IOE_BufferRX[2] = {0x00, 0x00};  
-  
-  /* Configure DMA Peripheral */
-  IOE_DMA_Config(IOE_DMA_RX, (uint8_t*)IOE_BufferRX);
-  
-  /* Enable DMA NACK automatic generation */
-  I2C_DMALastTransferCmd(IOE_I2C, ENABLE);
-  
-  /* Enable the I2C peripheral */
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
-  
-  /* Test on SB Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_SB)) 
+  return I2C_ReadDataBuffer(RegisterAddr);
+}
+
+/**
+  * @brief  Reads a buffer of bytes from the device registers through I2C DMA.
+  * @param  RegisterAddr: The first register address.
+  * @param  pBuffer: pointer to the buffer receiving the data.
+  * @param  NumByteToRead: number of bytes to read.
+  * @retval IOE_OK: if all operations are OK, IOE_TIMEOUT if a Timeout occurred.
+  */
+uint8_t I2C_DMA_ReadBuffer(uint8_t RegisterAddr, uint8_t *pBuffer, uint16_t NumByteToRead)
+{
+  if (IOE_Transfer(I2CBUS_FLAG_READ, RegisterAddr, pBuffer, NumByteToRead) != IOE_OK)
   {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
+    IOE_TimeoutUserCallback();
+    return IOE_TIMEOUT;
   }
   
-  /* Send device address for write */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Transmitter);
+  return IOE_OK;
+}
+
+/**
+  * @brief  Return Touch Panel Z position value
+  * @param  None
+  * @retval Z position.
+  */
+static uint16_t IOE_TP_Read_Z(void)
+{
+  uint32_t z;
   
-  /* Test on ADDR Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_CheckEvent(IOE_I2C, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
+  /* Read z value from DATA_Z register */
+  z = I2C_ReadDataBuffer(IOE_REG_TP_DATA_Z);
+
+  /* return z position value */
+  if(z <= 0)
+    z = 0;
+  return (uint16_t)(z); 
+}
+
+/**
+  * @brief  Denoises a calibrated touch Panel sample: median of the last 3
+  *         samples, then first order IIR filter.
+  * @param  pSample: sample in screen coordinates.
+  * @retval None
+  */
+static void IOE_TP_GestureSample(const TP_SAMPLE *pSample)
+{
+  int32_t x = 0, y = 0;
   
-  /* Send the device's internal address to write to */
-  I2C_SendData(IOE_I2C, RegisterAddr);  
+  IOE_Gesture.MedianX[IOE_Gesture.NumSamples % 3] = pSample->X;
+  IOE_Gesture.MedianY[IOE_Gesture.NumSamples % 3] = pSample->Y;
   
-  /* Test on TXE FLag (data dent) */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while ((!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_TXE)) && (!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_BTF)))  
+  if (IOE_Gesture.NumSamples == 0)
   {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
+    /* First sample of a contact: start the filter on it */
+    IOE_Gesture.X = (int32_t)pSample->X << 4;
+    IOE_Gesture.Y = (int32_t)pSample->Y << 4;
+    IOE_Gesture.NumSamples = 1;
+    return;
   }
   
-  /* Send START condition a second time */  
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
-  
-  /* Test on SB Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C,I2C_FLAG_SB)) 
+  if (IOE_Gesture.NumSamples < 3)
   {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
+    x = pSample->X;
+    y = pSample->Y;
   }
-  
-  /* Send IO Expander address for read */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Receiver);
-  
-  /* Test on ADDR Flag */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_CheckEvent(IOE_I2C, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED))   
+  else
   {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
+    x = IOE_Median3(IOE_Gesture.MedianX);
+    y = IOE_Median3(IOE_Gesture.MedianY);
   }
   
-  /* Enable I2C DMA request */
-  I2C_DMACmd(IOE_I2C,ENABLE);
-  
-  /* Enable DMA RX Channel */
-  DMA_Cmd(IOE_DMA_RX_STREAM, ENABLE);
-  
-  /* Wait until DMA Transfer Complete */
-  IOE_TimeOut = 2 * TIMEOUT_MAX;
-  while (!DMA_GetFlagStatus(IOE_DMA_RX_STREAM, IOE_DMA_RX_TCFLAG))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }        
-  
-  /* Send STOP Condition */
-  I2C_GenerateSTOP(IOE_I2C, ENABLE);
-  
-  /* Disable DMA RX Channel */
-  DMA_Cmd(IOE_DMA_RX_STREAM, DISABLE);
-  
-  /* Disable I2C DMA request */  
-  I2C_DMACmd(IOE_I2C,DISABLE);
-  
-  /* Clear DMA RX Transfer Complete Flag */
-  DMA_ClearFlag(IOE_DMA_RX_STREAM,IOE_DMA_RX_TCFLAG);
+  /* Keep the window index cycling over 3, 4 and 5 once full */
+  IOE_Gesture.NumSamples = (IOE_Gesture.NumSamples == 5) ? 3 : IOE_Gesture.NumSamples + 1;
   
-  /* Reorganize received data */  
-  tmp = IOE_BufferRX[0];
-  IOE_BufferRX[0] = IOE_BufferRX[1];
-  IOE_BufferRX[1] = tmp;
-  
-  /* return the data */
-  return (uint16_t) ((uint16_t)IOE_BufferRX[0] | (uint16_t)IOE_BufferRX[1]<< 8);
+  IOE_Gesture.X += ((x << 4) - IOE_Gesture.X) >> TP_IIR_SHIFT;
+  IOE_Gesture.Y += ((y << 4) - IOE_Gesture.Y) >> TP_IIR_SHIFT;
 }
 
-
 /**
-  * @brief  Return Touch Panel X position value
-  * @param  None
-  * @retval X position.
+  * @brief  Queues a touch Panel gesture event at the filtered position.
+  * @note   The event is dropped if the queue is full.
+  * @param  Type: event type.
+  * @param  Time: event time in ms.
+  * @retval None
   */
-static uint16_t IOE_TP_Read_X(void)
+static void IOE_TP_PostGesture(TP_GestureType_TypeDef Type, uint32_t Time)
 {
-  int32_t x, xr;
-  
-  /* Read x value from DATA_X register */
-  x = I2C_ReadDataBuffer(IOE_REG_TP_DATA_X);
+  TP_GESTURE *pGesture;
   
-  /* x value first correction */
-  if(x <= 3000)
+  if (IOE_GestureCount == IOE_TP_GESTURE_QUEUE_SIZE)
   {
-  x = 3870 - x;
-  }
-  else
-  {
-   x = 3800 - x;
+    return;
   }
   
-  /* x value second correction */  
-  xr = x / 15;
+  pGesture = &IOE_GestureQueue[(IOE_GestureHead + IOE_GestureCount) % IOE_TP_GESTURE_QUEUE_SIZE];
+  pGesture->Type = Type;
+  pGesture->X = (uint16_t)(IOE_Gesture.X >> 4);
+  pGesture->Y = (uint16_t)(IOE_Gesture.Y >> 4);
+  pGesture->VX = (int16_t)IOE_Gesture.VX;
+  pGesture->VY = (int16_t)IOE_Gesture.VY;
+  pGesture->Time = Time;
+  IOE_GestureCount++;
+}
+
+/**
+  * @brief  Returns the median of 3 values.
+  * @param  pValues: the 3 values.
+  * @retval Median value.
+  */
+static uint16_t IOE_Median3(const uint16_t *pValues)
+{
+  uint16_t a = pValues[0], b = pValues[1], c = pValues[2];
   
-  /* return x position value */
-  if(xr <= 0)
-  {
-    xr = 0;
-  }
-  else if (xr > 240)
+  if (a > b)
   {
-    xr = 239;
+    if (b > c) return b;
+    return (a > c) ? c : a;
   }
-  else 
-  {}
-  return (uint16_t)(xr); 
+  if (a > c) return a;
+  return (b > c) ? c : b;
 }
 
 /**
-  * @brief  Return Touch Panel Y position value
-  * @param  None
-  * @retval Y position.
+  * @brief  Unpacks touch Panel FIFO samples.
+  * @param  pData: packed samples [X11:4] [X3:0 Y11:8] [Y7:0] [Z7:0].
+  * @param  pSamples: pointer to the samples buffer.
+  * @param  NumSamples: number of samples.
+  * @retval None
   */
-static uint16_t IOE_TP_Read_Y(void)
+static void IOE_TP_Unpack(const uint8_t *pData, TP_SAMPLE *pSamples, uint8_t NumSamples)
 {
-  int32_t y, yr;
-  
-  /* Read y value from DATA_Y register */
-  y = I2C_ReadDataBuffer(IOE_REG_TP_DATA_Y);
+  uint32_t index = 0;
   
-  /* y value first correction */
+  for (index = 0; index < NumSamples; index++)
+  {
+    pSamples[index].X = ((uint16_t)pData[0] << 4) | (pData[1] >> 4);
+    pSamples[index].Y = ((uint16_t)(pData[1] & 0x0F) << 8) | pData[2];
+    pSamples[index].Z = pData[3];
+    pData += IOE_TP_SAMPLE_SIZE;
+  }
+}
 
-  y -= 360;  
-  
-  /* y value second correction */
-  yr = y / 11;
-  
-  /* return y position value */
-  if(yr <= 0)
+/**
+  * @brief  Queues a step of the touch Panel FIFO reading on the I2C bus.
+  * @param  State: the step to run.
+  * @retval None
+  */
+static void IOE_TP_FIFORead(TP_FIFOState_TypeDef State)
+{
+  I2CBus_TransferStructInit(&IOE_FIFOTransfer);
+  IOE_FIFOTransfer.Address = IOE_ADDR;
+  IOE_FIFOTransfer.Flags = I2CBUS_FLAG_READ | I2CBUS_FLAG_URGENT;
+  IOE_FIFOTransfer.RegisterSize = 1;
+  IOE_FIFOTransfer.Size = 1;
+  IOE_FIFOTransfer.Callback = IOE_TP_FIFOCallback;
+  
+  switch (State)
   {
-    yr = 0;
+  case TP_FIFO_SIZE:
+    IOE_FIFOTransfer.Register = IOE_REG_FIFO_SIZE;
+    IOE_FIFOTransfer.pBuffer = &IOE_FIFOSize;
+    break;
+  case TP_FIFO_DATA:
+    /* All the samples in one burst */
+    IOE_FIFOTransfer.Register = IOE_REG_TP_DATA_FIFO;
+    IOE_FIFOTransfer.pBuffer = IOE_FIFOBuffer;
+    IOE_FIFOTransfer.Size = IOE_FIFOCount * IOE_TP_SAMPLE_SIZE;
+    break;
+  case TP_FIFO_CTRL:
+    IOE_FIFOTransfer.Register = IOE_REG_TP_CTRL;
+    IOE_FIFOTransfer.pBuffer = &IOE_FIFOControl;
+    break;
+  default:
+    /* Acknowledge the interrupt: the line is released */
+    IOE_FIFOTransfer.Flags = I2CBUS_FLAG_URGENT;
+    IOE_FIFOTransfer.Register = IOE_REG_INT_STA;
+    IOE_FIFOTransfer.pBuffer = &IOE_FIFOAck;
+    break;
   }
-  else if (yr > 320)
+  
+  IOE_FIFOState = State;
+  if (I2CBus_Submit(&IOE_FIFOTransfer) != I2CBUS_PENDING)
   {
-    yr = 319;
+    IOE_FIFOState = TP_FIFO_IDLE;
   }
-  else
-  {}
-  return (uint16_t)(yr); 
 }
 
 /**
-  * @brief  Return Touch Panel Z position value
-  * @param  None
-  * @retval Z position.
+  * @brief  Touch Panel FIFO reading step completion, interrupt context.
+  * @param  pTransfer: pointer to the completed transfer.
+  * @retval None
   */
-static uint16_t IOE_TP_Read_Z(void)
+static void IOE_TP_FIFOCallback(I2CBus_Transfer_TypeDef *pTransfer)
 {
-  uint32_t z;
+  if (pTransfer->Status != I2CBUS_DONE)
+  {
+    /* Read again on the next IOE_TP_GetSamples call */
+    IOE_FIFOState = TP_FIFO_IDLE;
+    IOE_FIFOPending = 1;
+    return;
+  }
   
-  /* Read z value from DATA_Z register */
-  z = I2C_ReadDataBuffer(IOE_REG_TP_DATA_Z);
-
-  /* return z position value */
-  if(z <= 0)
-    z = 0;
-  return (uint16_t)(z); 
+  switch (IOE_FIFOState)
+  {
+  case TP_FIFO_SIZE:
+    IOE_FIFOCount = (IOE_FIFOSize > IOE_TP_BATCH_SIZE) ? IOE_TP_BATCH_SIZE : IOE_FIFOSize;
+    IOE_TP_FIFORead((IOE_FIFOCount != 0) ? TP_FIFO_DATA : TP_FIFO_CTRL);
+    break;
+  case TP_FIFO_DATA:
+    IOE_TP_FIFORead(TP_FIFO_CTRL);
+    break;
+  case TP_FIFO_CTRL:
+    IOE_TP_FIFORead(TP_FIFO_ACK);
+    break;
+  default:
+    /* Samples left for the next batch */
+    if ((IOE_FIFOSize - IOE_FIFOCount) >= IOE_FIFOThreshold)
+    {
+      IOE_FIFOPending = 1;
+    }
+    IOE_FIFOIndex = 0;
+    IOE_FIFOState = TP_FIFO_READY;
+    break;
+  }
 }
 
 /**
-  * @brief  Initializes the GPIO pins used by the IO expander.
-  * @param  None
-  * @retval None
+  * @brief  Takes samples of the touch Panel FIFO batch, and starts reading the
+  *         next batch once this one is consumed.
+  * @param  pSamples: pointer to the samples buffer.
+  * @param  MaxSamples: size of the samples buffer.
+  * @param  pCount: number of samples returned.
+  * @param  pTouched: touch detected when the batch was read.
+  * @retval 1 if a batch was ready, 0 otherwise.
   */
-static void IOE_GPIO_Config(void)
+static uint8_t IOE_TP_FIFOTake(TP_SAMPLE *pSamples, uint8_t MaxSamples, uint8_t *pCount, uint8_t *pTouched)
 {
-  GPIO_InitTypeDef GPIO_InitStructure;
+  uint32_t primask = 0;
+  uint8_t count = 0, ready = 0;
   
-  /* Enable IOE_I2C and IOE_I2C_GPIO_PORT & Alternate Function clocks */
-  RCC_APB1PeriphClockCmd(IOE_I2C_CLK, ENABLE);
-  RCC_AHB1PeriphClockCmd(IOE_I2C_SCL_GPIO_CLK | IOE_I2C_SDA_GPIO_CLK |
-                         IOE_IT_GPIO_CLK, ENABLE);
-  RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+  if (IOE_FIFOState == TP_FIFO_READY)
+  {
+    count = IOE_FIFOCount - IOE_FIFOIndex;
+    if (count > MaxSamples)
+    {
+      count = MaxSamples;
+    }
+    IOE_TP_Unpack(&IOE_FIFOBuffer[IOE_FIFOIndex * IOE_TP_SAMPLE_SIZE], pSamples, count);
+    IOE_FIFOIndex += count;
+    *pTouched = IOE_FIFOControl & 0x80;
+    ready = 1;
+  }
+  *pCount = count;
   
-  /* Reset IOE_I2C IP */
-  RCC_APB1PeriphResetCmd(IOE_I2C_CLK, ENABLE);
-  /* Release reset signal of IOE_I2C IP */
-  RCC_APB1PeriphResetCmd(IOE_I2C_CLK, DISABLE);
-
-  /* Connect PXx to I2C_SCL*/
-  GPIO_PinAFConfig(IOE_I2C_SCL_GPIO_PORT, IOE_I2C_SCL_SOURCE, IOE_I2C_SCL_AF);
-  /* Connect PXx to I2C_SDA*/
-  GPIO_PinAFConfig(IOE_I2C_SDA_GPIO_PORT, IOE_I2C_SDA_SOURCE, IOE_I2C_SDA_AF); 
-    
-  /* IOE_I2C SCL and SDA pins configuration */
-  GPIO_InitStructure.GPIO_Pin = IOE_I2C_SCL_PIN;
-  GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
-  GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-  GPIO_InitStructure.GPIO_OType = GPIO_OType_OD;
-  GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_NOPULL;
-  GPIO_Init(IOE_I2C_SCL_GPIO_PORT, &GPIO_InitStructure);
-
-  GPIO_InitStructure.GPIO_Pin = IOE_I2C_SDA_PIN;
-  GPIO_Init(IOE_I2C_SDA_GPIO_PORT, &GPIO_InitStructure);
+  /* Not preempted by the touch interrupt while the state changes */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if ((IOE_FIFOState == TP_FIFO_READY) && (IOE_FIFOIndex == IOE_FIFOCount))
+  {
+    IOE_FIFOState = TP_FIFO_IDLE;
+  }
+  if ((IOE_FIFOState == TP_FIFO_IDLE) && (IOE_FIFOPending != 0))
+  {
+    IOE_FIFOPending = 0;
+    IOE_TP_FIFORead(TP_FIFO_SIZE);
+  }
+  __set_PRIMASK(primask);
   
+  return ready;
 }
 
 /**
-  * @brief  Configure the I2C Peripheral used to communicate with IO_Expanders.
+  * @brief  Configures the EXTI line of the IO Expander interrupt pin.
   * @param  None
   * @retval None
   */
-static void IOE_I2C_Config(void)
+static void IOE_EXTI_Config(void)
 {
-  I2C_InitTypeDef I2C_InitStructure;
-
-  /* If the I2C peripheral is already enabled, don't reconfigure it */
-  if ((IOE_I2C->CR1 & I2C_CR1_PE) == 0)
-  {   
-    /* IOE_I2C configuration */
-    I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
-    I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
-    I2C_InitStructure.I2C_OwnAddress1 = 0x00;
-    I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
-    I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
-    I2C_InitStructure.I2C_ClockSpeed = I2C_SPEED;
-  
-    /* Initialize the I2C peripheral */
-    I2C_Init(IOE_I2C, &I2C_InitStructure);
-  
-    /* Enable the I2C peripheral */
-    I2C_Cmd(IOE_I2C, ENABLE);
-  }   
+  GPIO_InitTypeDef GPIO_InitStructure;
+  EXTI_InitTypeDef EXTI_InitStructure;
+  NVIC_InitTypeDef NVIC_InitStructure;
+  
+  RCC_AHB1PeriphClockCmd(IOE_IT_GPIO_CLK, ENABLE);
+  RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+  
+  /* Configure the interrupt pin as input, the line is active low */
+  GPIO_InitStructure.GPIO_Pin = IOE_IT_PIN;
+  GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
+  GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+  GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+  GPIO_Init(IOE_IT_GPIO_PORT, &GPIO_InitStructure);
+  
+  /* Connect the EXTI line to the interrupt pin */
+  SYSCFG_EXTILineConfig(IOE_IT_EXTI_PORT_SOURCE, IOE_IT_EXTI_PIN_SOURCE);
+  
+  EXTI_InitStructure.EXTI_Line = IOE_IT_EXTI_LINE;
+  EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+  EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Falling;
+  EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+  EXTI_Init(&EXTI_InitStructure);
+  
+  NVIC_InitStructure.NVIC_IRQChannel = IOE_IT_EXTI_IRQn;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = IOE_IT_PREPRIO;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = IOE_IT_SUBPRIO;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&NVIC_InitStructure);
 }
 
 /**
-  * @brief  Configure the DMA Peripheral used to handle communication via I2C.
-  * @param  None
-  * @retval None
+  * @brief  Runs a register transfer with the IO Expander and waits for its end.
+  * @param  Flags: I2CBUS_FLAG_READ for a read, 0 for a write.
+  * @param  RegisterAddr: The first register address.
+  * @param  pBuffer: pointer to the data.
+  * @param  Size: number of bytes.
+  * @retval IOE_OK: if all operations are OK, IOE_TIMEOUT otherwise.
   */
-static void IOE_DMA_Config(IOE_DMADirection_TypeDef Direction, uint8_t* buffer)
+static uint8_t IOE_Transfer(uint8_t Flags, uint8_t RegisterAddr, uint8_t *pBuffer, uint16_t Size)
 {
-  DMA_InitTypeDef DMA_InitStructure;
-  
-  RCC_AHB1PeriphClockCmd(IOE_DMA_CLK, ENABLE);
-  
-  /* Initialize the DMA_Channel member */
-  DMA_InitStructure.DMA_Channel = IOE_DMA_CHANNEL;
-  
-  /* Initialize the DMA_PeripheralBaseAddr member */
-  DMA_InitStructure.DMA_PeripheralBaseAddr = IOE_I2C_DR;
-  
-  /* Initialize the DMA_Memory0BaseAddr member */
-  DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)buffer;
-  
-  /* Initialize the DMA_PeripheralInc member */
-  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-  
-  /* Initialize the DMA_MemoryInc member */
-  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
-  
-  /* Initialize the DMA_PeripheralDataSize member */
-  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
-  
-  /* Initialize the DMA_MemoryDataSize member */
-  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
-  
-  /* Initialize the DMA_Mode member */
-  DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
-  
-  /* Initialize the DMA_Priority member */
-  DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
-  
-  /* Initialize the DMA_FIFOMode member */
-  DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Enable;
+  I2CBus_Transfer_TypeDef transfer;
   
-  /* Initialize the DMA_FIFOThreshold member */
-  DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_1QuarterFull;
+  I2CBus_TransferStructInit(&transfer);
+  transfer.Address = IOE_ADDR;
+  transfer.Flags = Flags;
+  transfer.RegisterSize = 1;
+  transfer.Register = RegisterAddr;
+  transfer.pBuffer = pBuffer;
+  transfer.Size = Size;
   
-  /* Initialize the DMA_MemoryBurst member */
-  DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
-  
-  /* Initialize the DMA_PeripheralBurst member */
-  DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
-  
-  /* If using DMA for Reception */
-  if (Direction == IOE_DMA_RX)
-  {    
-    /* Initialize the DMA_DIR member */
-    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
-    
-    /* Initialize the DMA_BufferSize member */
-    DMA_InitStructure.DMA_BufferSize = 2;
-    
-    DMA_DeInit(IOE_DMA_RX_STREAM);
-    
-    DMA_Init(IOE_DMA_RX_STREAM, &DMA_InitStructure);
-  }
-  /* If using DMA for Transmission */
-  else if (Direction == IOE_DMA_TX)
-  { 
-    /* Initialize the DMA_DIR member */
-    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
-    
-    /* Initialize the DMA_BufferSize member */
-    DMA_InitStructure.DMA_BufferSize = 1;
-    
-    DMA_DeInit(IOE_DMA_TX_STREAM);
-    
-    DMA_Init(IOE_DMA_TX_STREAM, &DMA_InitStructure);
+  if (I2CBus_Execute(&transfer) != I2CBUS_DONE)
+  {
+    return IOE_TIMEOUT;
   }
+  
+  return IOE_OK;
 }
 
 /**
@@ -1055,64 +1428,16 @@ uint8_t I2C_WriteDeviceRegister(uint8_t RegisterAddr, uint8_t RegisterValue)
 {
   uint32_t read_verif = 0;
 
-  /* Begin the configuration sequence */
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
-
-  /* Test on EV5 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_SB))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-
-  /* Transmit the slave address and enable writing operation */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Transmitter);
-  
-  /* Test on EV6 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;  
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_ADDR))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Read status register 2 to clear ADDR flag */
-  IOE_I2C->SR2;
-  
-  /* Test on EV8_1 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_TXE))
+  if (IOE_Transfer(0, RegisterAddr, &RegisterValue, 1) != IOE_OK)
   {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
+    return(IOE_TimeoutUserCallback());
   }
   
-  /* Transmit the first address for r/w operations */
-  I2C_SendData(IOE_I2C, RegisterAddr);
-  
-  /* Test on EV8 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_TXE))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Prepare the register value to be sent */
-  I2C_SendData(IOE_I2C, RegisterValue);
-  
-  /* Test on EV8_2 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while ((!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_TXE)) || (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_BTF)))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* End the configuration sequence */
-  I2C_GenerateSTOP(IOE_I2C, ENABLE);
-  
 #ifdef VERIFY_WRITTENDATA
   /* Verify (if needed) that the loaded data is correct  */
   
   /* Read the just written register*/
-  read_verif = IOE_I2C_ReadDeviceRegister(RegisterAddr);
+  read_verif = I2C_ReadDeviceRegister(RegisterAddr);
 
   /* Load the register and verify its value  */
   if (read_verif != RegisterValue)
@@ -1129,226 +1454,54 @@ uint8_t I2C_WriteDeviceRegister(uint8_t RegisterAddr, uint8_t RegisterValue)
   
   /* Return the verifying value: 0 (Passed) or 1 (Failed) */
   return read_verif;
-  
 }
 
 /**
-  * @brief  Reads a register of the device through I2C without DMA.
+  * @brief  Reads a register of the device through I2C.
   * @param  RegisterAddr: The target register address (between 00x and 0x24)
-  * @retval The value of the read register (0xAA if Timeout occurred)   
+  * @retval The value of the read register (0 if Timeout occurred)   
   */ 
 uint8_t I2C_ReadDeviceRegister(uint8_t RegisterAddr)
 {
   uint8_t tmp = 0;
   
-  /* Enable the I2C peripheral */
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
-  
-    /* Test on EV5 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_SB))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  /* Disable Acknowledgement */
-  I2C_AcknowledgeConfig(IOE_I2C, DISABLE);
-  
-  /* Transmit the slave address and enable writing operation */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Transmitter);
-  
-  /* Test on EV6 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;  
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_ADDR))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Read status register 2 to clear ADDR flag */
-  IOE_I2C->SR2;
-  
-  /* Test on EV8 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_TXE))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Transmit the first address for r/w operations */
-  I2C_SendData(IOE_I2C, RegisterAddr);
-  
-  /* Test on EV8 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while ((!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_TXE)) || (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_BTF)))
+  if (IOE_Transfer(I2CBUS_FLAG_READ, RegisterAddr, &tmp, 1) != IOE_OK)
   {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
+    return(IOE_TimeoutUserCallback());
   }
   
-  /* Regenerate a start condition */
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
-  
-  /* Test on EV5 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_SB))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Transmit the slave address and enable writing operation */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Receiver);
-  
-  /* Test on EV6 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_ADDR))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-    /* Read status register 2 to clear ADDR flag */
-  IOE_I2C->SR2;
-  
-  /* Test on EV7 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_RXNE))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* End the configuration sequence */
-  I2C_GenerateSTOP(IOE_I2C, ENABLE);
-  
-  /* Load the register value */
-  tmp = I2C_ReceiveData(IOE_I2C);
-  
-  /* Enable Acknowledgement */
-  I2C_AcknowledgeConfig(IOE_I2C, ENABLE);
-  
-  /* Return the read value */
   return tmp;
-  
 }
 
 /**
   * @brief  Reads a buffer of 2 bytes from the device registers.
-  * @param  RegisterAddr: The target register adress (between 00x and 0x24)
-  * @retval The data in the buffer containing the two returned bytes (in halfword).   
+  * @param  RegisterAddr: The target register address (between 00x and 0x24)
+  * @retval The two returned bytes, first one in the MSB.  
   */
 uint16_t I2C_ReadDataBuffer(uint32_t RegisterAddr)
 {
-  uint8_t IOE_BufferRX[2] = {0x00, 0x00};  
-  
-  /* Enable the I2C peripheral */
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
- 
-  /* Test on EV5 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_SB))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-   
-  /* Send device address for write */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Transmitter);
-  
-  /* Test on EV6 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;  
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_ADDR))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Read status register 2 to clear ADDR flag */
-  IOE_I2C->SR2;
-  
-  /* Test on EV8 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_TXE))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
-  
-  /* Send the device's internal address to write to */
-  I2C_SendData(IOE_I2C, RegisterAddr);  
-    
-  /* Send START condition a second time */  
-  I2C_GenerateSTART(IOE_I2C, ENABLE);
+  uint8_t IOE_BufferRX[2] = {0x00, 0x00};
   
-  /* Test on EV5 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_SB))
+  if (IOE_Transfer(I2CBUS_FLAG_READ, (uint8_t)RegisterAddr, IOE_BufferRX, 2) != IOE_OK)
   {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
+    return(IOE_TimeoutUserCallback());
   }
   
-  /* Send IO Expander address for read */
-  I2C_Send7bitAddress(IOE_I2C, IOE_ADDR, I2C_Direction_Receiver);
-  
-  /* Test on EV6 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_ADDR))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
- 
-  /* Disable Acknowledgement and set Pos bit */
-  I2C_AcknowledgeConfig(IOE_I2C, DISABLE);       
-  I2C_NACKPositionConfig(IOE_I2C, I2C_NACKPosition_Next);
-  
-  /* Read status register 2 to clear ADDR flag */
-  IOE_I2C->SR2;
-
-  /* Test on EV7 and clear it */
-  IOE_TimeOut = TIMEOUT_MAX;
-  while (!I2C_GetFlagStatus(IOE_I2C, I2C_FLAG_BTF))
-  {
-    if (IOE_TimeOut-- == 0) return(IOE_TimeoutUserCallback());
-  }
- 
-  /* Send STOP Condition */
-  I2C_GenerateSTOP(IOE_I2C, ENABLE);
-   
-  /* Read the first byte from the IO Expander */
-  IOE_BufferRX[1] = I2C_ReceiveData(IOE_I2C);
-    
-  /* Read the second byte from the IO Expander */
-  IOE_BufferRX[0] = I2C_ReceiveData(IOE_I2C);
-                                         
-  /* Enable Acknowledgement and reset POS bit to be ready for another reception */
-  I2C_AcknowledgeConfig(IOE_I2C, ENABLE);
-  I2C_NACKPositionConfig(IOE_I2C, I2C_NACKPosition_Current);
-   
   /* return the data */
-  return ((uint16_t) IOE_BufferRX[0] | ((uint16_t)IOE_BufferRX[1]<< 8));
+  return (((uint16_t)IOE_BufferRX[0] << 8) | (uint16_t)IOE_BufferRX[1]);
 }
 
 #ifndef USE_TIMEOUT_USER_CALLBACK 
 /**
   * @brief  IOE_TIMEOUT_UserCallback
+  * @note   The failed transfer is already completed: I2CBus_Wait() aborts
+  *         it on timeout, and resets the I2C peripheral if it was in
+  *         progress. The transfers of the other drivers are left alone.
   * @param  None
   * @retval 0
   */
 uint8_t IOE_TimeoutUserCallback(void)
 {
-  I2C_InitTypeDef I2C_InitStructure;
-
-  I2C_GenerateSTOP(IOE_I2C, ENABLE);
-  I2C_SoftwareResetCmd(IOE_I2C, ENABLE);
-  I2C_SoftwareResetCmd(IOE_I2C, DISABLE);
-  
-  IOE_GPIO_Config();
-
-  /* CODEC_I2C peripheral configuration */
-  I2C_DeInit(IOE_I2C);
-  I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
-  I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
-  I2C_InitStructure.I2C_OwnAddress1 = 0x00;
-  I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
-  I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
-  I2C_InitStructure.I2C_ClockSpeed = I2C_SPEED;
-  
-  /* Enable the I2C peripheral */
-  I2C_Cmd(IOE_I2C, ENABLE);  
-  I2C_Init(IOE_I2C, &I2C_InitStructure);
-  
   return 0;
 }
 #endif /* !USE_TIMEOUT_USER_CALLBACK */
@@ -36,6 +36,7 @@
    
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery.h"
+#include "stm32f429i_discovery_i2c.h"
    
 /** @addtogroup Utilities
   * @{
@@ -69,6 +70,58 @@ typedef struct
   uint16_t Z;
 }TP_STATE; 
 
+/** 
+  * @brief  Touch Panel FIFO sample (raw 12-bit X/Y and 8-bit Z ADC values)  
+  */ 
+typedef struct
+{
+  uint16_t X;
+  uint16_t Y;
+  uint16_t Z;
+}TP_SAMPLE; 
+
+/** 
+  * @brief  Touch Panel calibration: affine transform from raw ADC values to
+  *         screen coordinates, coefficients in Q(IOE_TP_CAL_SHIFT) fixed point  
+  *           X = (A * x + B * y + C) >> IOE_TP_CAL_SHIFT
+  *           Y = (D * x + E * y + F) >> IOE_TP_CAL_SHIFT
+  */ 
+typedef struct
+{
+  int32_t A;
+  int32_t B;
+  int32_t C;
+  int32_t D;
+  int32_t E;
+  int32_t F;
+}TP_CALIBRATION; 
+
+/** 
+  * @brief  Touch Panel gesture events  
+  */ 
+typedef enum
+{
+  TP_GESTURE_PRESS = 0,      /* first contact */
+  TP_GESTURE_TAP,            /* short contact without motion, on release */
+  TP_GESTURE_LONG_PRESS,     /* contact held without motion */
+  TP_GESTURE_DRAG,           /* motion while in contact */
+  TP_GESTURE_FLING,          /* release while dragging fast */
+  TP_GESTURE_RELEASE         /* end of contact, after TAP or FLING if any */
+}TP_GestureType_TypeDef;
+
+/** 
+  * @brief  Touch Panel gesture event: filtered screen position and velocity  
+  */ 
+typedef struct
+{
+  TP_GestureType_TypeDef Type;
+  uint16_t X;
+  uint16_t Y;
+  int16_t  VX;               /* pixels per second */
+  int16_t  VY;
+  uint32_t Time;             /* ms, time base of IOE_TP_GestureUpdate */
+}TP_GESTURE; 
+
 /** 
   * @brief  IO_Expander Error codes  
   */ 
@@ -122,6 +175,13 @@ typedef enum
  */
 /* #define USE_TIMEOUT_USER_CALLBACK */
 
+/**
+ * @brief Uncomment the line below to save and restore the touch panel
+ *        calibration in the I2C EEPROM (stm32f429i_discovery_i2c_ee.c driver,
+ *        sEE_Init() must be called by the application).
+ */
+/* #define USE_TP_CALIBRATION_EEPROM */
+
 /**
  * @brief Uncomment the line below if you want to use user defined Delay function
  *        (for precise timing), otherwise default _delay_ function defined within
@@ -162,34 +222,36 @@ typedef enum
   * @brief  IOE DMA definitions  
   */
 #define IOE_DMA_CLK                RCC_AHB1Periph_DMA1
-#define IOE_DMA_CHANNEL            DMA_Channel_1
+#define IOE_DMA_CHANNEL            DMA_Channel_3
 
 #ifndef IOE_DMA_TX_STREAM
- #define IOE_DMA_TX_STREAM         DMA1_Stream6
+ #define IOE_DMA_TX_STREAM         DMA1_Stream4
 #endif /* IOE_DMA_TX_STREAM */
 
 #ifndef IOE_DMA_TX_TCFLAG 
- #define IOE_DMA_TX_TCFLAG         DMA_FLAG_TCIF6
+ #define IOE_DMA_TX_TCFLAG         DMA_FLAG_TCIF4
 #endif /* IOE_DMA_TX_TCFLAG */
 
 #ifndef IOE_DMA_RX_STREAM
- #define IOE_DMA_RX_STREAM         DMA1_Stream0
+ #define IOE_DMA_RX_STREAM         DMA1_Stream2
 #endif /* IOE_DMA_RX_STREAM */
 
 #ifndef IOE_DMA_RX_TCFLAG 
- #define IOE_DMA_RX_TCFLAG         DMA_FLAG_TCIF0
+ #define IOE_DMA_RX_TCFLAG         DMA_FLAG_TCIF2
 #endif /* IOE_DMA_RX_TCFLAG */
 
 /** 
   * @brief  IO Expander Interrupt line on EXTI  
   */ 
-#define IOE_IT_PIN                 GPIO_Pin_2
-#define IOE_IT_GPIO_PORT           GPIOI
-#define IOE_IT_GPIO_CLK            RCC_AHB1Periph_GPIOI
-#define IOE_IT_EXTI_PORT_SOURCE    EXTI_PortSourceGPIOI
-#define IOE_IT_EXTI_PIN_SOURCE     EXTI_PinSource2
-#define IOE_IT_EXTI_LINE           EXTI_Line2
-#define IOE_IT_EXTI_IRQn           EXTI2_IRQn   
+#define IOE_IT_PIN                 GPIO_Pin_15
+#define IOE_IT_GPIO_PORT           GPIOA
+#define IOE_IT_GPIO_CLK            RCC_AHB1Periph_GPIOA
+#define IOE_IT_EXTI_PORT_SOURCE    EXTI_PortSourceGPIOA
+#define IOE_IT_EXTI_PIN_SOURCE     EXTI_PinSource15
+#define IOE_IT_EXTI_LINE           EXTI_Line15
+#define IOE_IT_EXTI_IRQn           EXTI15_10_IRQn   
+#define IOE_IT_PREPRIO             0x0F
+#define IOE_IT_SUBPRIO             0x0F
 
 /**
   * @brief Eval Board IO Exapander Pins definition 
@@ -307,6 +369,41 @@ typedef enum
 #define IOE_REG_TP_DATA            0x57
 #define IOE_REG_TP_I_DRIVE         0x58
 #define IOE_REG_TP_SHIELD          0x59
+#define IOE_REG_TP_DATA_FIFO       0xD7   /* TSC_DATA without address auto-increment */
+
+/** 
+  * @brief  TouchPanel FIFO  
+  */ 
+#define IOE_TP_FIFO_SIZE           128    /* samples */
+#define IOE_TP_SAMPLE_SIZE         4      /* packed X/Y/Z bytes per sample */
+
+#ifndef IOE_TP_BATCH_SIZE
+ #define IOE_TP_BATCH_SIZE         32     /* samples read per I2C burst */
+#endif /* IOE_TP_BATCH_SIZE */
+
+/** 
+  * @brief  TouchPanel calibration  
+  */ 
+#define IOE_TP_SCREEN_WIDTH        240
+#define IOE_TP_SCREEN_HEIGHT       320
+#define IOE_TP_CAL_SHIFT           16     /* fractional bits of the coefficients */
+#define IOE_TP_DEFAULT_X_KNEE      3000   /* default calibration: raw X knee */
+#define IOE_TP_DEFAULT_X_OFFSET    70     /* added to raw X above the knee */
+
+#ifndef IOE_TP_CAL_EE_ADDRESS
+ #define IOE_TP_CAL_EE_ADDRESS     0x1FE0 /* EEPROM address of the saved calibration */
+#endif /* IOE_TP_CAL_EE_ADDRESS */
+
+/** 
+  * @brief  TouchPanel gestures  
+  */ 
+#ifndef IOE_TP_GESTURE_QUEUE_SIZE
+ #define IOE_TP_GESTURE_QUEUE_SIZE 16     /* events */
+#endif /* IOE_TP_GESTURE_QUEUE_SIZE */
+#define IOE_TP_DRAG_DISTANCE       8      /* pixels before a contact becomes a drag */
+#define IOE_TP_TAP_TIME            300    /* ms, longest tap */
+#define IOE_TP_LONG_PRESS_TIME     800    /* ms */
+#define IOE_TP_FLING_SPEED         600    /* pixels per second */
 
 
 
@@ -412,6 +509,21 @@ uint8_t  IOE_IOAFConfig(uint8_t IO_Pin, FunctionalState NewState);
   */
 TP_STATE* IOE_TP_GetState(void);
 uint8_t   IOE_TP_Config(void);
+uint8_t   IOE_TP_FIFOConfig(uint8_t Threshold);
+uint8_t   IOE_TP_ReadFIFO(TP_SAMPLE *pSamples, uint8_t MaxSamples);
+uint8_t   IOE_TP_GetSamples(TP_SAMPLE *pSamples, uint8_t MaxSamples);
+void      IOE_TP_FIFOIRQHandler(void);
+uint8_t   IOE_TP_Calibrate(const TP_SAMPLE *pRaw, const TP_SAMPLE *pScreen, TP_CALIBRATION *pCalibration);
+void      IOE_TP_SetCalibration(const TP_CALIBRATION *pCalibration);
+void      IOE_TP_GetCalibration(TP_CALIBRATION *pCalibration);
+void      IOE_TP_CalibrateSamples(TP_SAMPLE *pSamples, uint8_t NumSamples);
+void      IOE_TP_GestureInit(void);
+uint8_t   IOE_TP_GestureUpdate(uint32_t Time);
+uint8_t   IOE_TP_GetGesture(TP_GESTURE *pGesture);
+#ifdef USE_TP_CALIBRATION_EEPROM
+uint8_t   IOE_TP_SaveCalibration(void);
+uint8_t   IOE_TP_LoadCalibration(void);
+#endif /* USE_TP_CALIBRATION_EEPROM */
 
 /** 
   * @brief Low Layer functions
@@ -422,6 +534,7 @@ uint16_t I2C_ReadDataBuffer(uint32_t RegisterAddr);
 uint8_t  I2C_DMA_WriteDeviceRegister(uint8_t RegisterAddr, uint8_t RegisterValue);
 uint8_t  I2C_DMA_ReadDeviceRegister(uint8_t RegisterAddr);
 uint16_t I2C_DMA_ReadDataBuffer(uint32_t RegisterAddr);
+uint8_t  I2C_DMA_ReadBuffer(uint8_t RegisterAddr, uint8_t *pBuffer, uint16_t NumByteToRead);
 
 
 /** 
@@ -29,6 +29,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery_lcd.h"
 #include "../Common/fonts.c"
+#include <string.h>
 
 
 /** @addtogroup Utilities
@@ -51,6 +52,44 @@
 /** @defgroup STM32F429I_DISCOVERY_LCD_Private_TypesDefinitions
   * @{
   */ 
+/* Layer window (position and size in pixels, relative to the active area) */
+typedef struct
+{
+  int16_t  Xpos;
+  int16_t  Ypos;
+  uint16_t Width;
+  uint16_t Height;
+} LCD_LayerWindow_TypeDef;
+
+/* Layer palette (L8 mode when Colors is not null) */
+typedef struct
+{
+  const uint16_t *Colors;     /* RGB(5-6-5) color of each CLUT index */
+  uint16_t        NumColors;
+} LCD_LayerPalette_TypeDef;
+
+/* Clip rectangle in screen coordinates (X1 and Y1 excluded) */
+typedef struct
+{
+  int16_t X0;
+  int16_t Y0;
+  int16_t X1;
+  int16_t Y1;
+} LCD_ClipRect_TypeDef;
+
+/* BMP picture layout, from its file and info headers */
+typedef struct
+{
+  uint32_t DataOffset;        /* first byte of the pixel data in the file */
+  uint32_t Width;
+  uint32_t Height;
+  uint32_t TopDown;           /* 1 when the first row of the file is the top one */
+  uint32_t PixelSize;         /* bytes per pixel */
+  uint32_t Stride;            /* bytes per row, padded to 32 bits */
+  uint32_t ColorMode;         /* DMA2D foreground color mode */
+  uint32_t NumColors;         /* CLUT entries in CM_L8 mode */
+  uint32_t PaletteOffset;     /* first palette entry in the file */
+} LCD_BmpInfo_TypeDef;
 /**
   * @}
   */ 
@@ -61,6 +100,13 @@
 
 #define POLY_Y(Z)          ((int32_t)((Points + Z)->X))
 #define POLY_X(Z)          ((int32_t)((Points + Z)->Y))   
+
+/* Bytes per pixel of a layer: 1 in L8 (CLUT) mode, 2 in RGB565 mode */
+#define LAYER_PIXEL_SIZE(Layerx)  ((LayerPalette[(Layerx)].Colors != 0) ? 1 : 2)
+
+/* BMP file and info headers, up to the red mask of BI_BITFIELDS pictures */
+#define BMP_HEADER_SIZE    58
+#define BMP_MAX_COLORS     256
 /**
   * @}
   */ 
@@ -83,6 +129,32 @@ static uint16_t CurrentBackColor   = 0xFFFF;
 /* Default LCD configuration with LCD Layer 1 */
 static uint32_t CurrentFrameBuffer = LCD_FRAME_BUFFER;
 static uint32_t CurrentLayer = LCD_BACKGROUND_LAYER;
+/* Layer windows handled by LCD_SetLayerWindow and LCD_SetLayerPosition */
+static LCD_LayerWindow_TypeDef LayerWindow[2] = 
+{
+  {0, 0, LCD_PIXEL_WIDTH, LCD_PIXEL_HEIGHT},
+  {0, 0, LCD_PIXEL_WIDTH, LCD_PIXEL_HEIGHT}
+};
+/* Layer palettes handled by LCD_SetPalette and LCD_ReSetPalette */
+static LCD_LayerPalette_TypeDef LayerPalette[2] = {{0, 0}, {0, 0}};
+/* Clip stack handled by LCD_PushClipRect and LCD_PopClipRect */
+static LCD_ClipRect_TypeDef CurrentClip = {0, 0, LCD_PIXEL_WIDTH, LCD_PIXEL_HEIGHT};
+static LCD_ClipRect_TypeDef ClipStack[LCD_CLIP_STACK_SIZE];
+static uint32_t ClipDepth = 0;
+/* Viewport origin: drawing coordinates are translated by -ViewportX/Y */
+static int16_t ViewportX = 0;
+static int16_t ViewportY = 0;
+/* Point batch handled by LCD_AddPoint and LCD_FlushPoints */
+static uint32_t PointBuffer[LCD_POINT_BUFFER_SIZE];
+static uint32_t PointNumber = 0;
+static uint32_t PointFrameBuffer = LCD_FRAME_BUFFER;
+static uint32_t PointLayer = LCD_BACKGROUND_LAYER;
+static uint16_t PointColor = 0;
+static uint16_t PointValue = 0;
+
+/* LCD_DrawBMP row buffers (one being filled while the DMA2D converts the other) and CLUT */
+static uint32_t BmpLine[2][LCD_PIXEL_WIDTH];
+static uint32_t BmpClut[BMP_MAX_COLORS];
 /**
   * @}
   */ 
@@ -94,7 +166,19 @@ static uint32_t CurrentLayer = LCD_BACKGROUND_LAYER;
 static void delay(__IO uint32_t nCount);
 #endif /* USE_Delay*/
 
-static void PutPixel(int16_t x, int16_t y);
+static void LCD_LayerWindowUpdate(uint32_t Layerx);
+static uint16_t LCD_PixelValue(uint16_t Color);
+static void LCD_WritePixel(uint32_t Offset, uint16_t Value);
+static void LCD_FillRect8(uint32_t Offset, uint16_t Width, uint16_t Height, uint8_t Index);
+static uint32_t LCD_ClipReject(int32_t X0, int32_t Y0, int32_t X1, int32_t Y1);
+static void LCD_PutClippedPixel(int32_t Xpos, int32_t Ypos, uint16_t Value);
+static void LCD_FillClippedRect(int32_t Xpos, int32_t Ypos, int32_t Width, int32_t Height, uint16_t Color);
+static __INLINE void LCD_StorePixel(uint32_t Address, uint16_t Value, uint32_t PixelSize);
+static ErrorStatus LCD_BMPParse(const uint8_t *pHeader, LCD_BmpInfo_TypeDef *pInfo);
+static void LCD_BMPConfig(const LCD_BmpInfo_TypeDef *pInfo, uint32_t Width, uint32_t Height, uint32_t FGOffset);
+static ErrorStatus LCD_BMPClip(const LCD_BmpInfo_TypeDef *pInfo, int32_t *pXpos, int32_t *pYpos,
+                               uint32_t *pFirst, uint32_t *pLast, uint32_t *pXskip, uint32_t *pWidth);
+static uint32_t LCD_BMPReadMemory(void *pSource, uint32_t Offset, uint8_t *pBuffer, uint32_t Size);
 static void LCD_PolyLineRelativeClosed(pPoint Points, uint16_t PointCount, uint16_t Closed);
 static void LCD_AF_GPIOConfig(void);
 
@@ -355,6 +439,10 @@ void LCD_LayerInit(void)
   /* Configure the number of lines */  
   LTDC_Layer_InitStruct.LTDC_CFBLineNumber = LCD_PIXEL_HEIGHT;
   
+  /* Record the two layer frame buffers in the SDRAM memory map */
+  SDRAM_RegionReserve("LCD layer 1", SDRAM_REGION_FRAMEBUFFER, LCD_FRAME_BUFFER, BUFFER_OFFSET);
+  SDRAM_RegionReserve("LCD layer 2", SDRAM_REGION_FRAMEBUFFER, LCD_LAYER2_FRAME_BUFFER, BUFFER_OFFSET);
+  
   /* Start Address configuration : the LCD Frame buffer is defined on SDRAM */    
   LTDC_Layer_InitStruct.LTDC_CFBStartAdress = LCD_FRAME_BUFFER;
   
@@ -362,8 +450,9 @@ void LCD_LayerInit(void)
   LTDC_LayerInit(LTDC_Layer1, &LTDC_Layer_InitStruct);
   
   /* Configure Layer2 */
-  /* Start Address configuration : the LCD Frame buffer is defined on SDRAM w/ Offset */     
-  LTDC_Layer_InitStruct.LTDC_CFBStartAdress = LCD_FRAME_BUFFER + BUFFER_OFFSET;
+  /* Start Address configuration : the LCD Frame buffer is defined on SDRAM,
+     in bank 0 after layer 1 or in bank 1 (LCD_FB_PLACEMENT) */     
+  LTDC_Layer_InitStruct.LTDC_CFBStartAdress = LCD_LAYER2_FRAME_BUFFER;
   
   /* Configure blending factors */       
   LTDC_Layer_InitStruct.LTDC_BlendingFactor_1 = LTDC_BlendingFactor1_PAxCA;    
@@ -372,6 +461,18 @@ void LCD_LayerInit(void)
   /* Initialize LTDC layer 2 */
   LTDC_LayerInit(LTDC_Layer2, &LTDC_Layer_InitStruct);
   
+  /* Both layer windows cover the whole active area */
+  LayerWindow[LCD_BACKGROUND_LAYER].Xpos = 0;
+  LayerWindow[LCD_BACKGROUND_LAYER].Ypos = 0;
+  LayerWindow[LCD_BACKGROUND_LAYER].Width = LCD_PIXEL_WIDTH;
+  LayerWindow[LCD_BACKGROUND_LAYER].Height = LCD_PIXEL_HEIGHT;
+  LayerWindow[LCD_FOREGROUND_LAYER] = LayerWindow[LCD_BACKGROUND_LAYER];
+  
+  /* Both layers are RGB565 */
+  LayerPalette[LCD_BACKGROUND_LAYER].Colors = 0;
+  LayerPalette[LCD_BACKGROUND_LAYER].NumColors = 0;
+  LayerPalette[LCD_FOREGROUND_LAYER] = LayerPalette[LCD_BACKGROUND_LAYER];
+  
   /* LTDC configuration reload */  
   LTDC_ReloadConfig(LTDC_IMReload);
   
@@ -420,7 +521,7 @@ void LCD_SetLayer(uint32_t Layerx)
   }
   else
   {
-    CurrentFrameBuffer = LCD_FRAME_BUFFER + BUFFER_OFFSET;
+    CurrentFrameBuffer = LCD_LAYER2_FRAME_BUFFER;
     CurrentLayer = LCD_FOREGROUND_LAYER;
   }
 }  
@@ -539,15 +640,109 @@ void LCD_ClearLine(uint16_t Line)
   */
 void LCD_Clear(uint16_t Color)
 {
-  uint32_t index = 0;
+  uint32_t index = 0, value = 0;
+  
+  if ((CurrentClip.X0 != 0) || (CurrentClip.Y0 != 0) || 
+      (CurrentClip.X1 != LCD_PIXEL_WIDTH) || (CurrentClip.Y1 != LCD_PIXEL_HEIGHT))
+  {
+    /* Only clear the clip rectangle */
+    LCD_FillClippedRect(CurrentClip.X0, CurrentClip.Y0, CurrentClip.X1 - CurrentClip.X0, 
+                        CurrentClip.Y1 - CurrentClip.Y0, Color);
+    return;
+  }
   
-  /* erase memory */
-  for (index = 0x00; index < BUFFER_OFFSET; index++)
+  if (LayerPalette[CurrentLayer].Colors != 0)
+  {
+    /* L8 mode: erase the frame buffer four indexes at a time */
+    value = LCD_PixelValue(Color);
+    value |= (value << 8);
+    value |= (value << 16);
+    for (index = 0x00; index < ((LCD_PIXEL_WIDTH * LCD_PIXEL_HEIGHT) / 4); index++)
+    {
+      *(__IO uint32_t*)(CurrentFrameBuffer + (4*index)) = value;
+    }
+    return;
+  }
+  
+  /* erase memory: the layer only, the other layer may follow it */
+  for (index = 0x00; index < (LCD_PIXEL_WIDTH * LCD_PIXEL_HEIGHT); index++)
   {
     *(__IO uint16_t*)(CurrentFrameBuffer + (2*index)) = Color;
   } 
 }
 
+/**
+  * @brief  Moves full width pixel lines of the current layer with the DMA2D,
+  *         to scroll a text zone without drawing it again.
+  * @note   The lines are frame buffer lines: the clip rectangle and the
+  *         viewport do not apply. The source and destination may overlap.
+  * @param  YposSrc: first line to move.
+  * @param  YposDst: line where the first line is moved to.
+  * @param  Height: number of lines to move.
+  * @retval None
+  */
+void LCD_MoveLines(uint16_t YposSrc, uint16_t YposDst, uint16_t Height)
+{
+  DMA2D_InitTypeDef      DMA2D_InitStruct;
+  DMA2D_FG_InitTypeDef   DMA2D_FG_InitStruct;
+  uint32_t LineSize = LCD_PIXEL_WIDTH * LAYER_PIXEL_SIZE(CurrentLayer);
+  uint16_t Band = Height;
+  
+  if ((Height == 0) || (YposSrc == YposDst))
+  {
+    return;
+  }
+  if (YposDst > YposSrc)
+  {
+    /* Moving down: the DMA2D copies forward, move bands not overlapping their
+       destination starting from the bottom */
+    if (Band > (YposDst - YposSrc))
+    {
+      Band = YposDst - YposSrc;
+    }
+    YposSrc += Height - Band;
+    YposDst += Height - Band;
+  }
+  
+  while (Height != 0)
+  {
+    /* The lines are copied as RGB565 pixels, whatever the layer format */
+    DMA2D_DeInit();
+    DMA2D_InitStruct.DMA2D_Mode = DMA2D_M2M;
+    DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;
+    DMA2D_InitStruct.DMA2D_OutputGreen = 0;
+    DMA2D_InitStruct.DMA2D_OutputBlue = 0;
+    DMA2D_InitStruct.DMA2D_OutputRed = 0;
+    DMA2D_InitStruct.DMA2D_OutputAlpha = 0;
+    DMA2D_InitStruct.DMA2D_OutputMemoryAdd = CurrentFrameBuffer + LineSize * YposDst;
+    DMA2D_InitStruct.DMA2D_OutputOffset = 0;
+    DMA2D_InitStruct.DMA2D_NumberOfLine = Band;
+    DMA2D_InitStruct.DMA2D_PixelPerLine = LineSize / 2;
+    DMA2D_Init(&DMA2D_InitStruct);
+    
+    DMA2D_FG_StructInit(&DMA2D_FG_InitStruct);
+    DMA2D_FG_InitStruct.DMA2D_FGMA = CurrentFrameBuffer + LineSize * YposSrc;
+    DMA2D_FG_InitStruct.DMA2D_FGCM = CM_RGB565;
+    DMA2D_FGConfig(&DMA2D_FG_InitStruct);
+    
+    /* Start Transfer */ 
+    DMA2D_StartTransfer();
+    
+    /* Wait for CTC Flag activation */
+    while(DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET)
+    {
+    }
+    
+    Height -= Band;
+    if (Band > Height)
+    {
+      Band = Height;
+    }
+    YposSrc -= Band;
+    YposDst -= Band;
+  }
+}
+
 /**
   * @brief  Sets the cursor position.
   * @param  Xpos: specifies the X position.
@@ -556,7 +751,30 @@ void LCD_Clear(uint16_t Color)
   */
 uint32_t LCD_SetCursor(uint16_t Xpos, uint16_t Ypos)
 {  
-  return CurrentFrameBuffer + 2*(Xpos + (LCD_PIXEL_WIDTH*Ypos));
+  return CurrentFrameBuffer + LAYER_PIXEL_SIZE(CurrentLayer)*(Xpos + (LCD_PIXEL_WIDTH*Ypos));
+}
+
+/**
+  * @brief  Reads a pixel of the current layer.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position. 
+  * @retval Pixel color code RGB(5-6-5), looked up in the palette in L8 mode.
+  */
+uint16_t LCD_GetPixel(uint16_t Xpos, uint16_t Ypos)
+{
+  uint32_t index = 0;
+  
+  if (LayerPalette[CurrentLayer].Colors != 0)
+  {
+    index = *(__IO uint8_t*)(CurrentFrameBuffer + Xpos + (LCD_PIXEL_WIDTH*Ypos));
+    if (index >= LayerPalette[CurrentLayer].NumColors)
+    {
+      return 0;
+    }
+    return LayerPalette[CurrentLayer].Colors[index];
+  }
+  
+  return *(__IO uint16_t*)(CurrentFrameBuffer + 2*(Xpos + (LCD_PIXEL_WIDTH*Ypos)));
 }
 
 /**
@@ -610,6 +828,110 @@ void LCD_ReSetColorKeying(void)
   }
 } 
 
+/**
+  * @brief  Switches the current layer to L8 mode and loads its CLUT.
+  * @note   Each pixel then takes one byte in the frame buffer instead of two,
+  *         which halves the LTDC scanout and drawing traffic on the SDRAM.
+  *         The drawing functions keep taking RGB(5-6-5) colors: they are 
+  *         translated to the matching (or nearest) palette index. The palette
+  *         is not copied and must stay valid while the layer is in L8 mode.
+  *         The layer content must be redrawn after the switch.
+  * @param  Palette: RGB(5-6-5) color of each CLUT index.
+  * @param  NumColors: number of palette entries, from 1 to 256.
+  * @retval None
+  */
+void LCD_SetPalette(const uint16_t *Palette, uint16_t NumColors)
+{
+  LTDC_CLUT_InitTypeDef LTDC_CLUT_InitStruct;
+  LTDC_Layer_TypeDef *LTDC_Layerx;
+  uint32_t index = 0;
+  
+  if (CurrentLayer == LCD_BACKGROUND_LAYER)
+  {
+    LTDC_Layerx = LTDC_Layer1;
+  }
+  else
+  {
+    LTDC_Layerx = LTDC_Layer2;
+  }
+  
+  /* The CLUT can only be written while the layer is disabled */
+  LTDC_LayerCmd(LTDC_Layerx, DISABLE);
+  LTDC_ReloadConfig(LTDC_IMReload);
+  
+  /* Load the CLUT, expanding the colors to RGB(8-8-8) */
+  for (index = 0; index < NumColors; index++)
+  {
+    LTDC_CLUT_InitStruct.LTDC_CLUTAdress = index;
+    LTDC_CLUT_InitStruct.LTDC_RedValue = ((Palette[index] & 0xF800) >> 8) | ((Palette[index] & 0xE000) >> 13);
+    LTDC_CLUT_InitStruct.LTDC_GreenValue = ((Palette[index] & 0x07E0) >> 3) | ((Palette[index] & 0x0600) >> 9);
+    LTDC_CLUT_InitStruct.LTDC_BlueValue = ((Palette[index] & 0x001F) << 3) | ((Palette[index] & 0x001C) >> 2);
+    LTDC_CLUTInit(LTDC_Layerx, &LTDC_CLUT_InitStruct);
+  }
+  
+  LayerPalette[CurrentLayer].Colors = Palette;
+  LayerPalette[CurrentLayer].NumColors = NumColors;
+  
+  /* Reconfigure the layer pixel format and CLUT, then the pitch and window:
+     the layer is enabled and everything applied with a single reload
+     (LTDC_CLUTCmd() would reload the shadow registers immediately) */
+  LTDC_LayerPixelFormat(LTDC_Layerx, LTDC_Pixelformat_L8);
+  LTDC_Layerx->CR |= (uint32_t)LTDC_LxCR_CLUTEN;
+  LCD_LayerWindowUpdate(CurrentLayer);
+}
+
+/**
+  * @brief  Switches the current layer back to RGB565 mode.
+  * @note   The layer content must be redrawn after the switch.
+  * @param  None
+  * @retval None
+  */
+void LCD_ReSetPalette(void)
+{
+  LTDC_Layer_TypeDef *LTDC_Layerx;
+  
+  if (CurrentLayer == LCD_BACKGROUND_LAYER)
+  {
+    LTDC_Layerx = LTDC_Layer1;
+  }
+  else
+  {
+    LTDC_Layerx = LTDC_Layer2;
+  }
+  
+  LayerPalette[CurrentLayer].Colors = 0;
+  LayerPalette[CurrentLayer].NumColors = 0;
+  
+  /* Pixel format and CLUT applied with the window by a single reload */
+  LTDC_LayerPixelFormat(LTDC_Layerx, LTDC_Pixelformat_RGB565);
+  LTDC_Layerx->CR &= ~(uint32_t)LTDC_LxCR_CLUTEN;
+  LCD_LayerWindowUpdate(CurrentLayer);
+}
+
+/**
+  * @brief  Gets the number of bytes the LTDC fetches from the SDRAM per frame.
+  * @note   Sum over the enabled layers of the visible window size times the 
+  *         layer pixel size; multiply by the refresh rate to get the scanout
+  *         bandwidth.
+  * @param  None
+  * @retval Bytes fetched per frame.
+  */
+uint32_t LCD_GetScanoutBytes(void)
+{
+  uint32_t bytes = 0;
+  
+  if ((LTDC_Layer1->CR & LTDC_LxCR_LEN) != 0)
+  {
+    bytes += ((LTDC_Layer1->CFBLR & 0x1FFF) - 3) * (LTDC_Layer1->CFBLNR & 0x7FF);
+  }
+  if ((LTDC_Layer2->CR & LTDC_LxCR_LEN) != 0)
+  {
+    bytes += ((LTDC_Layer2->CFBLR & 0x1FFF) - 3) * (LTDC_Layer2->CFBLNR & 0x7FF);
+  }
+  
+  return bytes;
+}
+
 /**
   * @brief  Draws a character on LCD.
   * @param  Xpos: the Line where to display the character shape.
@@ -619,11 +941,19 @@ void LCD_ReSetColorKeying(void)
   */
 void LCD_DrawChar(uint16_t Xpos, uint16_t Ypos, const uint16_t *c)
 {
-  uint32_t index = 0, counter = 0, xpos =0;
-  uint32_t  Xaddress = 0;
+  uint32_t index = 0, counter = 0;
+  int32_t  x = 0, y = 0;
+  uint16_t TextValue = 0, BackValue = 0;
   
-  xpos = Xpos*LCD_PIXEL_WIDTH*2;
-  Xaddress += Ypos;
+  /* Xpos is the line (vertical) and Ypos the column (horizontal) position */
+  x = (int32_t)Ypos - ViewportX;
+  y = (int32_t)Xpos - ViewportY;
+  if (LCD_ClipReject(x, y, x + LCD_Currentfonts->Width - 1, y + LCD_Currentfonts->Height - 1))
+  {
+    return;
+  }
+  TextValue = LCD_PixelValue(CurrentTextColor);
+  BackValue = LCD_PixelValue(CurrentBackColor);
   
   for(index = 0; index < LCD_Currentfonts->Height; index++)
   {
@@ -635,16 +965,14 @@ void LCD_DrawChar(uint16_t Xpos, uint16_t Ypos, const uint16_t *c)
         (((c[index] & (0x1 << counter)) == 0x00)&&(LCD_Currentfonts->Width > 12 )))
       {
           /* Write data value to all SDRAM memory */
-         *(__IO uint16_t*) (CurrentFrameBuffer + (2*Xaddress) + xpos) = CurrentBackColor;
+         LCD_PutClippedPixel(x + counter, y + index, BackValue);
       }
       else
       {
           /* Write data value to all SDRAM memory */
-         *(__IO uint16_t*) (CurrentFrameBuffer + (2*Xaddress) + xpos) = CurrentTextColor;         
+         LCD_PutClippedPixel(x + counter, y + index, TextValue);
       }
-      Xaddress++;
     }
-      Xaddress += (LCD_PIXEL_WIDTH - LCD_Currentfonts->Width);
   }
 }
 
@@ -689,34 +1017,43 @@ void LCD_DisplayStringLine(uint16_t Line, uint8_t *ptr)
 
 /**
   * @brief  Sets a display window
-  * @param  Xpos: specifies the X bottom left position from 0 to 240.
-  * @param  Ypos: specifies the Y bottom left position from 0 to 320.
+  * @note   The window goes through the layer window, like LCD_SetLayerWindow()
+  *         and LCD_SetLayerPosition(): the frame buffer keeps its full pitch
+  *         and its top left part is shown at (Xpos, Ypos). The base clip
+  *         rectangle is set to that visible frame buffer area; rectangles
+  *         pushed with LCD_PushClipRect() are kept and the new window applies
+  *         once they are popped.
+  * @param  Xpos: specifies the X top left position from 0 to 240.
+  * @param  Ypos: specifies the Y top left position from 0 to 320.
   * @param  Height: display window height, can be a value from 0 to 320.
   * @param  Width: display window width, can be a value from 0 to 240.
   * @retval None
   */
 void LCD_SetDisplayWindow(uint16_t Xpos, uint16_t Ypos, uint16_t Height, uint16_t Width)
 {
-
-  if (CurrentLayer == LCD_BACKGROUND_LAYER)
-  { 
-    /* reconfigure the layer1 position */
-    LTDC_LayerPosition(LTDC_Layer1, Xpos, Ypos);
-    LTDC_ReloadConfig(LTDC_IMReload);
-    
-    /* reconfigure the layer1 size */
-    LTDC_LayerSize(LTDC_Layer1, Width, Height);
-    LTDC_ReloadConfig(LTDC_IMReload);
- }
- else
- {   
-    /* reconfigure the layer2 position */
-    LTDC_LayerPosition(LTDC_Layer2, Xpos, Ypos);
-    LTDC_ReloadConfig(LTDC_IMReload); 
-   
-   /* reconfigure the layer2 size */
-    LTDC_LayerSize(LTDC_Layer2, Width, Height);
-    LTDC_ReloadConfig(LTDC_IMReload);
+  LCD_ClipRect_TypeDef window;
+
+  LayerWindow[CurrentLayer].Xpos = Xpos;
+  LayerWindow[CurrentLayer].Ypos = Ypos;
+  LayerWindow[CurrentLayer].Width = Width;
+  LayerWindow[CurrentLayer].Height = Height;
+  LCD_LayerWindowUpdate(CurrentLayer);
+
+  /* Frame buffer area left on screen by the layer window */
+  window.X0 = 0;
+  window.Y0 = 0;
+  window.X1 = (Xpos >= LCD_PIXEL_WIDTH) ? 0 :
+              (((Xpos + Width) < LCD_PIXEL_WIDTH) ? Width : (LCD_PIXEL_WIDTH - Xpos));
+  window.Y1 = (Ypos >= LCD_PIXEL_HEIGHT) ? 0 :
+              (((Ypos + Height) < LCD_PIXEL_HEIGHT) ? Height : (LCD_PIXEL_HEIGHT - Ypos));
+
+  if (ClipDepth == 0)
+  {
+    CurrentClip = window;
+  }
+  else
+  {
+    ClipStack[0] = window;
   }
 }
 
@@ -730,6 +1067,108 @@ void LCD_WindowModeDisable(void)
   LCD_SetDisplayWindow(0, 0, LCD_PIXEL_HEIGHT, LCD_PIXEL_WIDTH); 
 }
 
+/**
+  * @brief  Restricts the drawing to a rectangle.
+  * @note   The rectangle is intersected with the current one, which is saved
+  *         on the clip stack and restored by LCD_PopClipRect(). All the 
+  *         drawing functions but LCD_MoveLines() honour the clip rectangle; 
+  *         shapes lying fully outside of it are rejected before any frame 
+  *         buffer access.
+  * @param  Xpos: specifies the X position on the screen.
+  * @param  Ypos: specifies the Y position on the screen.
+  * @param  Width: clip rectangle width.
+  * @param  Height: clip rectangle height.
+  * @retval ERROR if the clip stack is full, SUCCESS otherwise.
+  */
+ErrorStatus LCD_PushClipRect(int16_t Xpos, int16_t Ypos, uint16_t Width, uint16_t Height)
+{
+  int32_t x1 = 0, y1 = 0;
+  
+  if (ClipDepth >= LCD_CLIP_STACK_SIZE)
+  {
+    return ERROR;
+  }
+  ClipStack[ClipDepth++] = CurrentClip;
+  
+  x1 = Xpos + Width;
+  y1 = Ypos + Height;
+  if (Xpos > CurrentClip.X0) CurrentClip.X0 = Xpos;
+  if (Ypos > CurrentClip.Y0) CurrentClip.Y0 = Ypos;
+  if (x1 < CurrentClip.X1) CurrentClip.X1 = x1;
+  if (y1 < CurrentClip.Y1) CurrentClip.Y1 = y1;
+  
+  /* Keep an empty rectangle well formed */
+  if (CurrentClip.X1 < CurrentClip.X0) CurrentClip.X1 = CurrentClip.X0;
+  if (CurrentClip.Y1 < CurrentClip.Y0) CurrentClip.Y1 = CurrentClip.Y0;
+  
+  return SUCCESS;
+}
+
+/**
+  * @brief  Restores the clip rectangle saved by the last LCD_PushClipRect().
+  * @param  None
+  * @retval None
+  */
+void LCD_PopClipRect(void)
+{
+  if (ClipDepth > 0)
+  {
+    CurrentClip = ClipStack[--ClipDepth];
+  }
+}
+
+/**
+  * @brief  Sets the viewport origin.
+  * @note   The coordinates given to the drawing functions are translated by
+  *         (-Xorigin, -Yorigin) before clipping: scrolling a drawing larger 
+  *         than the screen only requires to move the origin.
+  * @param  Xorigin: drawing X coordinate shown on the first screen column.
+  * @param  Yorigin: drawing Y coordinate shown on the first screen line.
+  * @retval None
+  */
+void LCD_SetViewport(int16_t Xorigin, int16_t Yorigin)
+{
+  ViewportX = Xorigin;
+  ViewportY = Yorigin;
+}
+
+/**
+  * @brief  Shrinks a layer window to a sprite of the given size.
+  * @note   The window shows the top left Width x Height pixels of the layer
+  *         frame buffer, which keeps its full line pitch: the sprite is drawn
+  *         once with the usual LCD_* functions, then moved with 
+  *         LCD_SetLayerPosition() without touching the frame buffer again.
+  * @param  Layerx: specifies the Layer foreground or background.
+  * @param  Width: sprite width, can be a value from 1 to 240.
+  * @param  Height: sprite height, can be a value from 1 to 320.
+  * @retval None
+  */
+void LCD_SetLayerWindow(uint32_t Layerx, uint16_t Width, uint16_t Height)
+{
+  LayerWindow[Layerx].Width = Width;
+  LayerWindow[Layerx].Height = Height;
+  
+  LCD_LayerWindowUpdate(Layerx);
+}
+
+/**
+  * @brief  Moves a layer window on the screen.
+  * @note   Only the LTDC layer registers are written; the new position is 
+  *         taken into account at the next vertical blanking. The parts of the
+  *         window lying outside the active area are clipped.
+  * @param  Layerx: specifies the Layer foreground or background.
+  * @param  Xpos: specifies the X position of the window top left corner.
+  * @param  Ypos: specifies the Y position of the window top left corner.
+  * @retval None
+  */
+void LCD_SetLayerPosition(uint32_t Layerx, int16_t Xpos, int16_t Ypos)
+{
+  LayerWindow[Layerx].Xpos = Xpos;
+  LayerWindow[Layerx].Ypos = Ypos;
+  
+  LCD_LayerWindowUpdate(Layerx);
+}
+
 /**
   * @brief  Displays a line.
   * @param Xpos: specifies the X position, can be a value from 0 to 240.
@@ -741,48 +1180,14 @@ void LCD_WindowModeDisable(void)
   */
 void LCD_DrawLine(uint16_t Xpos, uint16_t Ypos, uint16_t Length, uint8_t Direction)
 {
-  DMA2D_InitTypeDef      DMA2D_InitStruct;
-  
-  uint32_t  Xaddress = 0;
-  uint16_t Red_Value = 0, Green_Value = 0, Blue_Value = 0;
-  
-  Xaddress = CurrentFrameBuffer + 2*(LCD_PIXEL_WIDTH*Ypos + Xpos);
- 
-  Red_Value = (0xF800 & CurrentTextColor) >> 11;
-  Blue_Value = 0x001F & CurrentTextColor;
-  Green_Value = (0x07E0 & CurrentTextColor) >> 5;
-
-  /* Configure DMA2D */    
-  DMA2D_DeInit();  
-  DMA2D_InitStruct.DMA2D_Mode = DMA2D_R2M;       
-  DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;      
-  DMA2D_InitStruct.DMA2D_OutputGreen = Green_Value;      
-  DMA2D_InitStruct.DMA2D_OutputBlue = Blue_Value;     
-  DMA2D_InitStruct.DMA2D_OutputRed = Red_Value;                
-  DMA2D_InitStruct.DMA2D_OutputAlpha = 0x0F;                  
-  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = Xaddress;                  
-  
   if(Direction == LCD_DIR_HORIZONTAL)
-  {                                                      
-    DMA2D_InitStruct.DMA2D_OutputOffset = 0;                
-    DMA2D_InitStruct.DMA2D_NumberOfLine = 1;            
-    DMA2D_InitStruct.DMA2D_PixelPerLine = Length; 
+  {
+    LCD_FillClippedRect((int32_t)Xpos - ViewportX, (int32_t)Ypos - ViewportY, Length, 1, CurrentTextColor);
   }
   else
-  {                                                            
-    DMA2D_InitStruct.DMA2D_OutputOffset = LCD_PIXEL_WIDTH - 1;                
-    DMA2D_InitStruct.DMA2D_NumberOfLine = Length;            
-    DMA2D_InitStruct.DMA2D_PixelPerLine = 1;  
-  }
-  
-  DMA2D_Init(&DMA2D_InitStruct);  
-  /* Start Transfer */ 
-  DMA2D_StartTransfer();  
-  /* Wait for CTC Flag activation */
-  while(DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET)
   {
+    LCD_FillClippedRect((int32_t)Xpos - ViewportX, (int32_t)Ypos - ViewportY, 1, Length, CurrentTextColor);
   }
-  
 }
 
 /**
@@ -814,11 +1219,47 @@ void LCD_DrawRect(uint16_t Xpos, uint16_t Ypos, uint16_t Height, uint16_t Width)
 void LCD_DrawCircle(uint16_t Xpos, uint16_t Ypos, uint16_t Radius)
 {
     int x = -Radius, y = 0, err = 2-2*Radius, e2;
+    int32_t cx = (int32_t)Xpos - ViewportX, cy = (int32_t)Ypos - ViewportY;
+    uint32_t Lower = 0, Upper = 0, PixelSize = 0;
+    uint16_t Value = 0;
+    
+    if (LCD_ClipReject(cx - Radius, cy - Radius, cx + Radius, cy + Radius))
+    {
+        return;
+    }
+    Value = LCD_PixelValue(CurrentTextColor);
+    
+    if ((cx - Radius >= CurrentClip.X0) && (cx + Radius < CurrentClip.X1) &&
+        (cy - Radius >= CurrentClip.Y0) && (cy + Radius < CurrentClip.Y1))
+    {
+        /* Fully visible: keep the two row addresses, never compute y*240 */
+        PixelSize = LAYER_PIXEL_SIZE(CurrentLayer);
+        Lower = CurrentFrameBuffer + PixelSize*(cx + LCD_PIXEL_WIDTH*cy);
+        Upper = Lower;
+        do {
+            LCD_StorePixel(Lower - PixelSize*x, Value, PixelSize); 
+            LCD_StorePixel(Lower + PixelSize*x, Value, PixelSize);
+            LCD_StorePixel(Upper + PixelSize*x, Value, PixelSize);
+            LCD_StorePixel(Upper - PixelSize*x, Value, PixelSize);
+          
+            e2 = err;
+            if (e2 <= y) {
+                err += ++y*2+1;
+                Lower += PixelSize*LCD_PIXEL_WIDTH;
+                Upper -= PixelSize*LCD_PIXEL_WIDTH;
+                if (-x == y && e2 <= x) e2 = 0;
+            }
+            if (e2 > x) err += ++x*2+1;
+        }
+        while (x <= 0);
+        return;
+    }
+    
     do {
-        *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos-x) + LCD_PIXEL_WIDTH*(Ypos+y)))) = CurrentTextColor; 
-        *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos+x) + LCD_PIXEL_WIDTH*(Ypos+y)))) = CurrentTextColor;
-        *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos+x) + LCD_PIXEL_WIDTH*(Ypos-y)))) = CurrentTextColor;
-        *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos-x) + LCD_PIXEL_WIDTH*(Ypos-y)))) = CurrentTextColor;
+        LCD_PutClippedPixel(cx-x, cy+y, Value); 
+        LCD_PutClippedPixel(cx+x, cy+y, Value);
+        LCD_PutClippedPixel(cx+x, cy-y, Value);
+        LCD_PutClippedPixel(cx-x, cy-y, Value);
       
         e2 = err;
         if (e2 <= y) {
@@ -843,6 +1284,13 @@ void LCD_DrawFullEllipse(int Xpos, int Ypos, int Radius, int Radius2)
   int x = -Radius, y = 0, err = 2-2*Radius, e2;
   float K = 0, rad1 = 0, rad2 = 0;
   
+  Xpos -= ViewportX;
+  Ypos -= ViewportY;
+  if (LCD_ClipReject(Xpos - Radius, Ypos - Radius2, Xpos + Radius, Ypos + Radius2))
+  {
+    return;
+  }
+  
   rad1 = Radius;
   rad2 = Radius2;
   
@@ -851,8 +1299,8 @@ void LCD_DrawFullEllipse(int Xpos, int Ypos, int Radius, int Radius2)
     do 
     {
       K = (float)(rad1/rad2);
-      LCD_DrawLine((Xpos+x), (Ypos-(uint16_t)(y/K)), (2*(uint16_t)(y/K) + 1), LCD_DIR_VERTICAL);
-      LCD_DrawLine((Xpos-x), (Ypos-(uint16_t)(y/K)), (2*(uint16_t)(y/K) + 1), LCD_DIR_VERTICAL);
+      LCD_FillClippedRect((Xpos+x), (Ypos-(uint16_t)(y/K)), 1, (2*(uint16_t)(y/K) + 1), CurrentTextColor);
+      LCD_FillClippedRect((Xpos-x), (Ypos-(uint16_t)(y/K)), 1, (2*(uint16_t)(y/K) + 1), CurrentTextColor);
       
       e2 = err;
       if (e2 <= y) 
@@ -872,8 +1320,8 @@ void LCD_DrawFullEllipse(int Xpos, int Ypos, int Radius, int Radius2)
     do 
     { 
       K = (float)(rad2/rad1);       
-      LCD_DrawLine((Xpos-(uint16_t)(x/K)), (Ypos+y), (2*(uint16_t)(x/K) + 1), LCD_DIR_HORIZONTAL);
-      LCD_DrawLine((Xpos-(uint16_t)(x/K)), (Ypos-y), (2*(uint16_t)(x/K) + 1), LCD_DIR_HORIZONTAL);
+      LCD_FillClippedRect((Xpos-(uint16_t)(x/K)), (Ypos+y), (2*(uint16_t)(x/K) + 1), 1, CurrentTextColor);
+      LCD_FillClippedRect((Xpos-(uint16_t)(x/K)), (Ypos-y), (2*(uint16_t)(x/K) + 1), 1, CurrentTextColor);
       
       e2 = err;
       if (e2 <= x) 
@@ -899,6 +1347,15 @@ void LCD_DrawEllipse(int Xpos, int Ypos, int Radius, int Radius2)
 {
   int x = -Radius, y = 0, err = 2-2*Radius, e2;
   float K = 0, rad1 = 0, rad2 = 0;
+  uint16_t Value = 0;
+  
+  Xpos -= ViewportX;
+  Ypos -= ViewportY;
+  if (LCD_ClipReject(Xpos - Radius, Ypos - Radius2, Xpos + Radius, Ypos + Radius2))
+  {
+    return;
+  }
+  Value = LCD_PixelValue(CurrentTextColor);
    
   rad1 = Radius;
   rad2 = Radius2;
@@ -907,10 +1364,10 @@ void LCD_DrawEllipse(int Xpos, int Ypos, int Radius, int Radius2)
   { 
     do {
       K = (float)(rad1/rad2);
-      *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos-x) + LCD_PIXEL_WIDTH*(Ypos+(uint16_t)(y/K))))) = CurrentTextColor; 
-      *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos+x) + LCD_PIXEL_WIDTH*(Ypos+(uint16_t)(y/K))))) = CurrentTextColor;
-      *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos+x) + LCD_PIXEL_WIDTH*(Ypos-(uint16_t)(y/K))))) = CurrentTextColor;
-      *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos-x) + LCD_PIXEL_WIDTH*(Ypos-(uint16_t)(y/K))))) = CurrentTextColor;
+      LCD_PutClippedPixel((Xpos-x), (Ypos+(uint16_t)(y/K)), Value); 
+      LCD_PutClippedPixel((Xpos+x), (Ypos+(uint16_t)(y/K)), Value);
+      LCD_PutClippedPixel((Xpos+x), (Ypos-(uint16_t)(y/K)), Value);
+      LCD_PutClippedPixel((Xpos-x), (Ypos-(uint16_t)(y/K)), Value);
             
       e2 = err;
       if (e2 <= y) {
@@ -927,10 +1384,10 @@ void LCD_DrawEllipse(int Xpos, int Ypos, int Radius, int Radius2)
     x = 0;
     do { 
       K = (float)(rad2/rad1);
-      *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos-(uint16_t)(x/K)) + LCD_PIXEL_WIDTH*(Ypos+y)))) = CurrentTextColor; 
-      *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos+(uint16_t)(x/K)) + LCD_PIXEL_WIDTH*(Ypos+y)))) = CurrentTextColor;
-      *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos+(uint16_t)(x/K)) + LCD_PIXEL_WIDTH*(Ypos-y)))) = CurrentTextColor;
-      *(__IO uint16_t*) (CurrentFrameBuffer + (2*((Xpos-(uint16_t)(x/K)) + LCD_PIXEL_WIDTH*(Ypos-y)))) = CurrentTextColor;
+      LCD_PutClippedPixel((Xpos-(uint16_t)(x/K)), (Ypos+y), Value); 
+      LCD_PutClippedPixel((Xpos+(uint16_t)(x/K)), (Ypos+y), Value);
+      LCD_PutClippedPixel((Xpos+(uint16_t)(x/K)), (Ypos-y), Value);
+      LCD_PutClippedPixel((Xpos-(uint16_t)(x/K)), (Ypos-y), Value);
       
       e2 = err;
       if (e2 <= x) {
@@ -944,26 +1401,39 @@ void LCD_DrawEllipse(int Xpos, int Ypos, int Radius, int Radius2)
 }
 
 /**
-  * @brief  Displays a mono-color picture.
-  * @param  Pict: pointer to the picture array.
+  * @brief  Displays a full screen mono-color picture.
+  * @note   The picture is drawn at the viewport origin, trimmed to the clip
+  *         rectangle.
+  * @param  Pict: pointer to the picture array, one bit per pixel from the
+  *         top left corner, least significant bit first.
   * @retval None
   */
 void LCD_DrawMonoPict(const uint32_t *Pict)
 {
-  uint32_t index = 0, counter = 0;
+  uint32_t index = 0, counter = 0, pixel = 0;
+  uint16_t TextValue = 0, BackValue = 0;
+  
+  if (LCD_ClipReject(-ViewportX, -ViewportY, LCD_PIXEL_WIDTH - 1 - ViewportX, LCD_PIXEL_HEIGHT - 1 - ViewportY))
+  {
+    return;
+  }
+  
+  TextValue = LCD_PixelValue(CurrentTextColor);
+  BackValue = LCD_PixelValue(CurrentBackColor);
   
-   
   for(index = 0; index < 2400; index++)
   {
-    for(counter = 0; counter < 32; counter++)
+    for(counter = 0; counter < 32; counter++, pixel++)
     {
       if((Pict[index] & (1 << counter)) == 0x00)
       {
-        *(__IO uint16_t*)(CurrentFrameBuffer) = CurrentBackColor;
+        LCD_PutClippedPixel((int32_t)(pixel % LCD_PIXEL_WIDTH) - ViewportX, 
+                            (int32_t)(pixel / LCD_PIXEL_WIDTH) - ViewportY, BackValue);
       }
       else
       {
-        *(__IO uint16_t*)(CurrentFrameBuffer) = CurrentTextColor;
+        LCD_PutClippedPixel((int32_t)(pixel % LCD_PIXEL_WIDTH) - ViewportX, 
+                            (int32_t)(pixel / LCD_PIXEL_WIDTH) - ViewportY, TextValue);
       }
     }
   }
@@ -971,113 +1441,233 @@ void LCD_DrawMonoPict(const uint32_t *Pict)
 
 /**
   * @brief  Displays a bitmap picture loaded in the internal Flash.
+  * @note   The layer size and pixel format are changed to the ones of the
+  *         picture: use LCD_DrawBMP to keep the layer configuration. The 
+  *         picture is drawn at the viewport origin, trimmed to the clip 
+  *         rectangle. Supported pictures: 32, 24 and 16 bit/pixel.
   * @param  BmpAddress: Bmp picture address in the internal Flash.
   * @retval None
   */
 void LCD_WriteBMP(uint32_t BmpAddress)
 {
-  uint32_t index = 0, size = 0, width = 0, height = 0, bit_pixel = 0;
-  uint32_t Address;
-  uint32_t currentline = 0, linenumber = 0;
- 
-  Address = CurrentFrameBuffer;
-
-  /* Read bitmap size */
-  size = *(__IO uint16_t *) (BmpAddress + 2);
-  size |= (*(__IO uint16_t *) (BmpAddress + 4)) << 16;
+  LCD_BmpInfo_TypeDef BmpInfo;
+  LTDC_Layer_TypeDef *LTDC_Layerx = LTDC_Layer1;
+  uint32_t first = 0, last = 0, xskip = 0, width = 0;
+  uint32_t row = 0, line = 0, PixelFormat = 0;
+  int32_t x = 0, y = 0;
   
-  /* Get bitmap data address offset */
-  index = *(__IO uint16_t *) (BmpAddress + 10);
-  index |= (*(__IO uint16_t *) (BmpAddress + 12)) << 16;
-
-  /* Read bitmap width */
-  width = *(uint16_t *) (BmpAddress + 18);
-  width |= (*(uint16_t *) (BmpAddress + 20)) << 16;
-
-  /* Read bitmap height */
-  height = *(uint16_t *) (BmpAddress + 22);
-  height |= (*(uint16_t *) (BmpAddress + 24)) << 16;
-
-  /* Read bit/pixel */
-  bit_pixel = *(uint16_t *) (BmpAddress + 28);  
- 
-  if (CurrentLayer == LCD_BACKGROUND_LAYER)
+  if ((LCD_BMPParse((const uint8_t *)BmpAddress, &BmpInfo) == ERROR) || (BmpInfo.PixelSize == 1))
   {
-    /* reconfigure layer size in accordance with the picture */
-    LTDC_LayerSize(LTDC_Layer1, width, height);
-    LTDC_ReloadConfig(LTDC_VBReload);
-
-    /* Reconfigure the Layer pixel format in accordance with the picture */    
-    if ((bit_pixel/8) == 4)
-    {
-      LTDC_LayerPixelFormat(LTDC_Layer1, LTDC_Pixelformat_ARGB8888);
-      LTDC_ReloadConfig(LTDC_VBReload);
-    }
-    else if ((bit_pixel/8) == 2)
-    {
-      LTDC_LayerPixelFormat(LTDC_Layer1, LTDC_Pixelformat_RGB565);
-      LTDC_ReloadConfig(LTDC_VBReload);
-    }
-    else 
-    {
-      LTDC_LayerPixelFormat(LTDC_Layer1, LTDC_Pixelformat_RGB888);
-      LTDC_ReloadConfig(LTDC_VBReload);
-    } 
+    return;
+  }
+  
+  /* The picture sets its own pixel format: leave L8 mode */
+  LayerPalette[CurrentLayer].Colors = 0;
+  LayerPalette[CurrentLayer].NumColors = 0;
+  
+  if (CurrentLayer != LCD_BACKGROUND_LAYER)
+  {
+    LTDC_Layerx = LTDC_Layer2;
+  }
+  
+  /* reconfigure layer size in accordance with the picture */
+  LTDC_LayerSize(LTDC_Layerx, BmpInfo.Width, BmpInfo.Height);
+  LTDC_ReloadConfig(LTDC_VBReload);
+  
+  /* Reconfigure the Layer pixel format in accordance with the picture */
+  if (BmpInfo.PixelSize == 4)
+  {
+    PixelFormat = LTDC_Pixelformat_ARGB8888;
+  }
+  else if (BmpInfo.PixelSize == 2)
+  {
+    PixelFormat = LTDC_Pixelformat_RGB565;
   }
   else
   {
-    /* reconfigure layer size in accordance with the picture */
-    LTDC_LayerSize(LTDC_Layer2, width, height);
-    LTDC_ReloadConfig(LTDC_VBReload); 
-    
-    /* Reconfigure the Layer pixel format in accordance with the picture */
-    if ((bit_pixel/8) == 4)
-    {
-      LTDC_LayerPixelFormat(LTDC_Layer2, LTDC_Pixelformat_ARGB8888);
-      LTDC_ReloadConfig(LTDC_VBReload);
-    }
-    else if ((bit_pixel/8) == 2)
-    {
-      LTDC_LayerPixelFormat(LTDC_Layer2, LTDC_Pixelformat_RGB565);
-      LTDC_ReloadConfig(LTDC_VBReload);
-    }
-    else
-    {
-      LTDC_LayerPixelFormat(LTDC_Layer2, LTDC_Pixelformat_RGB888);
-      LTDC_ReloadConfig(LTDC_VBReload);  
-    }
+    PixelFormat = LTDC_Pixelformat_RGB888;
   }
- 
-  /* compute the real size of the picture (without the header)) */  
-  size = (size - index); 
-
-  /* bypass the bitmap header */
-  BmpAddress += index;
-
-  /* start copie image from the bottom */
-  Address += width*(height-1)*(bit_pixel/8);
+  LTDC_LayerPixelFormat(LTDC_Layerx, PixelFormat);
+  LTDC_ReloadConfig(LTDC_VBReload);
   
-  for(index = 0; index < size; index++)
+  /* Only the visible part of the rows is copied */
+  LCD_BMPClip(&BmpInfo, &x, &y, &first, &last, &xskip, &width);
+  for (row = first; row < last; row++)
   {
-    *(__IO uint8_t*) (Address) = *(__IO uint8_t *)BmpAddress;
-    
-    /*jump on next byte */   
-    BmpAddress++;
-    Address++;
-    currentline++;
-    
-    if((currentline/(bit_pixel/8)) == width)
-    {
-      if(linenumber < height)
-      {
-        linenumber++;
-        Address -=(2*width*(bit_pixel/8));
-        currentline = 0;
-      }
-    }
+    line = (BmpInfo.TopDown != 0) ? (y + row) : (y + BmpInfo.Height - 1 - row);
+    memcpy((uint8_t *)(CurrentFrameBuffer + (line*BmpInfo.Width + x)*BmpInfo.PixelSize),
+           (const uint8_t *)(BmpAddress + BmpInfo.DataOffset + row*BmpInfo.Stride + xskip*BmpInfo.PixelSize),
+           width*BmpInfo.PixelSize);
   }
 }
 
+/**
+  * @brief  Displays a bitmap picture at a given position, converted by the
+  *         DMA2D to the current layer format.
+  * @note   Supported pictures: 32, 24 and 16 (X1R5G5B5 or R5G6B5 bit fields)
+  *         bit/pixel, and 8 bit/pixel with palette. The current layer must
+  *         be in RGB565 mode.
+  * @param  BmpAddress: Bmp picture address in a memory mapped area.
+  * @param  Xpos: specifies the X position of the picture top left corner.
+  * @param  Ypos: specifies the Y position of the picture top left corner.
+  * @retval ERROR if the picture or the layer format is not supported, SUCCESS otherwise
+  */
+ErrorStatus LCD_DrawBMP(uint32_t BmpAddress, int16_t Xpos, int16_t Ypos)
+{
+  LCD_BmpInfo_TypeDef BmpInfo;
+  uint32_t first = 0, last = 0, xskip = 0, width = 0;
+  uint32_t Address = 0, row = 0;
+  int32_t x = Xpos, y = Ypos;
+  
+  if ((LCD_BMPParse((const uint8_t *)BmpAddress, &BmpInfo) == ERROR) ||
+      (LCD_BMPClip(&BmpInfo, &x, &y, &first, &last, &xskip, &width) == ERROR))
+  {
+    return ERROR;
+  }
+  if (first == last)
+  {
+    return SUCCESS;
+  }
+  
+  Address = BmpAddress + BmpInfo.DataOffset + xskip*BmpInfo.PixelSize;
+  
+  /* The DMA2D reads pixels at their natural alignment: stream the rows
+     through the aligned line buffers otherwise */
+  if ((BmpInfo.PixelSize != 3) && ((Address & (BmpInfo.PixelSize - 1)) != 0))
+  {
+    return LCD_DrawBMPFromSource(LCD_BMPReadMemory, (void *)BmpAddress, Xpos, Ypos);
+  }
+  
+  if (BmpInfo.NumColors != 0)
+  {
+    memcpy(BmpClut, (const uint8_t *)(BmpAddress + BmpInfo.PaletteOffset), 4*BmpInfo.NumColors);
+  }
+  
+  if ((BmpInfo.TopDown != 0) && ((BmpInfo.Stride % BmpInfo.PixelSize) == 0))
+  {
+    /* Rows are in display order: one job, the row padding is skipped by
+       the foreground offset */
+    LCD_BMPConfig(&BmpInfo, width, last - first, BmpInfo.Stride/BmpInfo.PixelSize - width);
+    DMA2D->FGMAR = Address + first*BmpInfo.Stride;
+    DMA2D->OMAR = CurrentFrameBuffer + 2*(LCD_PIXEL_WIDTH*(y + first) + x);
+    DMA2D_StartTransfer();
+    while(DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET)
+    {
+    }
+    return SUCCESS;
+  }
+  
+  /* One job per row: the DMA2D offsets cannot walk the picture backwards */
+  LCD_BMPConfig(&BmpInfo, width, 1, 0);
+  for (row = first; row < last; row++)
+  {
+    DMA2D->FGMAR = Address + row*BmpInfo.Stride;
+    if (BmpInfo.TopDown != 0)
+    {
+      DMA2D->OMAR = CurrentFrameBuffer + 2*(LCD_PIXEL_WIDTH*(y + row) + x);
+    }
+    else
+    {
+      DMA2D->OMAR = CurrentFrameBuffer + 2*(LCD_PIXEL_WIDTH*(y + BmpInfo.Height - 1 - row) + x);
+    }
+    DMA2D_StartTransfer();
+    while(DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET)
+    {
+    }
+    DMA2D_ClearFlag(DMA2D_FLAG_TC);
+  }
+  
+  return SUCCESS;
+}
+
+/**
+  * @brief  Displays a bitmap picture read from a block source (SD card,
+  *         serial memory...) at a given position.
+  * @note   Each visible row is read in file order in one of two line buffers
+  *         while the DMA2D converts the previous one to the current layer
+  *         format. See LCD_DrawBMP for the supported pictures.
+  * @param  ReadBlock: block source read function.
+  * @param  pSource: block source handle, passed to ReadBlock.
+  * @param  Xpos: specifies the X position of the picture top left corner.
+  * @param  Ypos: specifies the Y position of the picture top left corner.
+  * @retval ERROR if the picture or the layer format is not supported, or if
+  *         the source is too short, SUCCESS otherwise
+  */
+ErrorStatus LCD_DrawBMPFromSource(LCD_ReadBlock_TypeDef ReadBlock, void *pSource, int16_t Xpos, int16_t Ypos)
+{
+  LCD_BmpInfo_TypeDef BmpInfo;
+  uint32_t Header[(BMP_HEADER_SIZE + 3)/4];
+  uint32_t first = 0, last = 0, xskip = 0, width = 0;
+  uint32_t row = 0, size = 0, buffer = 0, busy = 0;
+  int32_t x = Xpos, y = Ypos;
+  ErrorStatus status = SUCCESS;
+  
+  if ((ReadBlock(pSource, 0, (uint8_t *)Header, BMP_HEADER_SIZE) != BMP_HEADER_SIZE) ||
+      (LCD_BMPParse((const uint8_t *)Header, &BmpInfo) == ERROR) ||
+      (LCD_BMPClip(&BmpInfo, &x, &y, &first, &last, &xskip, &width) == ERROR))
+  {
+    return ERROR;
+  }
+  if (first == last)
+  {
+    return SUCCESS;
+  }
+  
+  if (BmpInfo.NumColors != 0)
+  {
+    size = 4*BmpInfo.NumColors;
+    if (ReadBlock(pSource, BmpInfo.PaletteOffset, (uint8_t *)BmpClut, size) != size)
+    {
+      return ERROR;
+    }
+  }
+  
+  LCD_BMPConfig(&BmpInfo, width, 1, 0);
+  
+  size = width*BmpInfo.PixelSize;
+  for (row = first; row < last; row++)
+  {
+    /* Fetch this row while the DMA2D converts the previous one */
+    if (ReadBlock(pSource, BmpInfo.DataOffset + row*BmpInfo.Stride + xskip*BmpInfo.PixelSize,
+                  (uint8_t *)BmpLine[buffer], size) != size)
+    {
+      status = ERROR;
+      break;
+    }
+    
+    if (busy != 0)
+    {
+      while(DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET)
+      {
+      }
+      DMA2D_ClearFlag(DMA2D_FLAG_TC);
+    }
+    
+    DMA2D->FGMAR = (uint32_t)BmpLine[buffer];
+    if (BmpInfo.TopDown != 0)
+    {
+      DMA2D->OMAR = CurrentFrameBuffer + 2*(LCD_PIXEL_WIDTH*(y + row) + x);
+    }
+    else
+    {
+      DMA2D->OMAR = CurrentFrameBuffer + 2*(LCD_PIXEL_WIDTH*(y + BmpInfo.Height - 1 - row) + x);
+    }
+    DMA2D_StartTransfer();
+    busy = 1;
+    buffer ^= 1;
+  }
+  
+  if (busy != 0)
+  {
+    while(DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET)
+    {
+    }
+    DMA2D_ClearFlag(DMA2D_FLAG_TC);
+  }
+  
+  return status;
+}
+
 /**
   * @brief  Displays a full rectangle.
   * @param  Xpos: specifies the X position, can be a value from 0 to 240.
@@ -1088,38 +1678,7 @@ void LCD_WriteBMP(uint32_t BmpAddress)
   */
 void LCD_DrawFullRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height)
 {
-  DMA2D_InitTypeDef      DMA2D_InitStruct;
-  
-  uint32_t  Xaddress = 0; 
-  uint16_t Red_Value = 0, Green_Value = 0, Blue_Value = 0;
- 
-  Red_Value = (0xF800 & CurrentTextColor) >> 11;
-  Blue_Value = 0x001F & CurrentTextColor;
-  Green_Value = (0x07E0 & CurrentTextColor) >> 5;
-  
-  Xaddress = CurrentFrameBuffer + 2*(LCD_PIXEL_WIDTH*Ypos + Xpos);
-  
-  /* configure DMA2D */
-  DMA2D_DeInit();
-  DMA2D_InitStruct.DMA2D_Mode = DMA2D_R2M;       
-  DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;      
-  DMA2D_InitStruct.DMA2D_OutputGreen = Green_Value;      
-  DMA2D_InitStruct.DMA2D_OutputBlue = Blue_Value;     
-  DMA2D_InitStruct.DMA2D_OutputRed = Red_Value;                
-  DMA2D_InitStruct.DMA2D_OutputAlpha = 0x0F;                  
-  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = Xaddress;                
-  DMA2D_InitStruct.DMA2D_OutputOffset = (LCD_PIXEL_WIDTH - Width);                
-  DMA2D_InitStruct.DMA2D_NumberOfLine = Height;            
-  DMA2D_InitStruct.DMA2D_PixelPerLine = Width;
-  DMA2D_Init(&DMA2D_InitStruct); 
-  
-  /* Start Transfer */ 
-  DMA2D_StartTransfer();
-  
-  /* Wait for CTC Flag activation */
-  while(DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET)
-  {
-  } 
+  LCD_FillClippedRect((int32_t)Xpos - ViewportX, (int32_t)Ypos - ViewportY, Width, Height, CurrentTextColor);
 
   LCD_SetTextColor(CurrentTextColor);
 }
@@ -1134,8 +1693,15 @@ void LCD_DrawFullRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Hei
 void LCD_DrawFullCircle(uint16_t Xpos, uint16_t Ypos, uint16_t Radius)
 {
   int32_t  D;    /* Decision Variable */ 
-  uint32_t  CurX;/* Current X Value */
-  uint32_t  CurY;/* Current Y Value */ 
+  int32_t  CurX; /* Current X Value */
+  int32_t  CurY; /* Current Y Value */ 
+  int32_t  cx = (int32_t)Xpos - ViewportX, cy = (int32_t)Ypos - ViewportY;
+  
+  /* Signed screen coordinates: no wrap around near the borders */
+  if (LCD_ClipReject(cx - Radius, cy - Radius, cx + Radius, cy + Radius))
+  {
+    return;
+  }
   
   D = 3 - (Radius << 1);
   
@@ -1146,14 +1712,14 @@ void LCD_DrawFullCircle(uint16_t Xpos, uint16_t Ypos, uint16_t Radius)
   {
     if(CurY > 0) 
     {
-      LCD_DrawLine(Xpos - CurX, Ypos - CurY, 2*CurY, LCD_DIR_VERTICAL);
-      LCD_DrawLine(Xpos + CurX, Ypos - CurY, 2*CurY, LCD_DIR_VERTICAL);
+      LCD_FillClippedRect(cx - CurX, cy - CurY, 1, 2*CurY, CurrentTextColor);
+      LCD_FillClippedRect(cx + CurX, cy - CurY, 1, 2*CurY, CurrentTextColor);
     }
     
     if(CurX > 0) 
     {
-      LCD_DrawLine(Xpos - CurY, Ypos - CurX, 2*CurX, LCD_DIR_VERTICAL);
-      LCD_DrawLine(Xpos + CurY, Ypos - CurX, 2*CurX, LCD_DIR_VERTICAL);
+      LCD_FillClippedRect(cx - CurY, cy - CurX, 1, 2*CurX, CurrentTextColor);
+      LCD_FillClippedRect(cx + CurY, cy - CurX, 1, 2*CurX, CurrentTextColor);
     }
     if (D < 0)
     { 
@@ -1183,11 +1749,23 @@ void LCD_DrawUniLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
   int16_t deltax = 0, deltay = 0, x = 0, y = 0, xinc1 = 0, xinc2 = 0, 
   yinc1 = 0, yinc2 = 0, den = 0, num = 0, numadd = 0, numpixels = 0, 
   curpixel = 0;
+  int32_t sx1 = (int32_t)x1 - ViewportX, sy1 = (int32_t)y1 - ViewportY;
+  int32_t sx2 = (int32_t)x2 - ViewportX, sy2 = (int32_t)y2 - ViewportY;
+  int32_t Inc1 = 0, Inc2 = 0;
+  uint32_t Address = 0, PixelSize = 0;
+  uint16_t Value = 0;
+  
+  /* Reject the lines lying fully on one side of the clip rectangle */
+  if (LCD_ClipReject((sx1 < sx2) ? sx1 : sx2, (sy1 < sy2) ? sy1 : sy2, 
+                     (sx1 > sx2) ? sx1 : sx2, (sy1 > sy2) ? sy1 : sy2))
+  {
+    return;
+  }
   
   deltax = ABS(x2 - x1);        /* The difference between the x's */
   deltay = ABS(y2 - y1);        /* The difference between the y's */
-  x = x1;                       /* Start x off at the first pixel */
-  y = y1;                       /* Start y off at the first pixel */
+  x = sx1;                      /* Start x off at the first pixel */
+  y = sy1;                      /* Start y off at the first pixel */
   
   if (x2 >= x1)                 /* The x-values are increasing */
   {
@@ -1230,9 +1808,34 @@ void LCD_DrawUniLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
     numpixels = deltay;         /* There are more y-values than x-values */
   }
   
+  Value = LCD_PixelValue(CurrentTextColor);
+  
+  if ((sx1 >= CurrentClip.X0) && (sx1 < CurrentClip.X1) && (sy1 >= CurrentClip.Y0) && (sy1 < CurrentClip.Y1) &&
+      (sx2 >= CurrentClip.X0) && (sx2 < CurrentClip.X1) && (sy2 >= CurrentClip.Y0) && (sy2 < CurrentClip.Y1))
+  {
+    /* Both ends visible: walk the frame buffer address, never compute y*240 */
+    PixelSize = LAYER_PIXEL_SIZE(CurrentLayer);
+    Address = CurrentFrameBuffer + PixelSize*(x + LCD_PIXEL_WIDTH*y);
+    Inc1 = PixelSize*(xinc1 + LCD_PIXEL_WIDTH*yinc1);
+    Inc2 = PixelSize*(xinc2 + LCD_PIXEL_WIDTH*yinc2);
+    
+    for (curpixel = 0; curpixel <= numpixels; curpixel++)
+    {
+      LCD_StorePixel(Address, Value, PixelSize);
+      num += numadd;
+      if (num >= den)
+      {
+        num -= den;
+        Address += Inc1;
+      }
+      Address += Inc2;
+    }
+    return;
+  }
+  
   for (curpixel = 0; curpixel <= numpixels; curpixel++)
   {
-    PutPixel(x, y);             /* Draw the current pixel */
+    LCD_PutClippedPixel(x, y, Value); /* Draw the current pixel */
     num += numadd;              /* Increase the numerator by the top of the fraction */
     if (num >= den)             /* Check if numerator >= denominator */
     {
@@ -1282,6 +1885,18 @@ void LCD_FillTriangle(uint16_t x1, uint16_t x2, uint16_t x3, uint16_t y1, uint16
   int16_t deltax = 0, deltay = 0, x = 0, y = 0, xinc1 = 0, xinc2 = 0, 
   yinc1 = 0, yinc2 = 0, den = 0, num = 0, numadd = 0, numpixels = 0, 
   curpixel = 0;
+  uint16_t xmin = 0, xmax = 0, ymin = 0, ymax = 0;
+  
+  /* Reject the triangles lying fully outside of the clip rectangle */
+  xmin = (x1 < x2) ? x1 : x2; xmin = (xmin < x3) ? xmin : x3;
+  xmax = (x1 > x2) ? x1 : x2; xmax = (xmax > x3) ? xmax : x3;
+  ymin = (y1 < y2) ? y1 : y2; ymin = (ymin < y3) ? ymin : y3;
+  ymax = (y1 > y2) ? y1 : y2; ymax = (ymax > y3) ? ymax : y3;
+  if (LCD_ClipReject((int32_t)xmin - ViewportX, (int32_t)ymin - ViewportY, 
+                     (int32_t)xmax - ViewportX, (int32_t)ymax - ViewportY))
+  {
+    return;
+  }
   
   deltax = ABS(x2 - x1);        /* The difference between the x's */
   deltay = ABS(y2 - y1);        /* The difference between the y's */
@@ -1346,6 +1961,89 @@ void LCD_FillTriangle(uint16_t x1, uint16_t x2, uint16_t x3, uint16_t y1, uint16
   
   
 }
+/**
+  * @brief  Adds a point to the point batch.
+  * @note   The points are drawn with the current text color by 
+  *         LCD_FlushPoints(), sorted by frame buffer address so that each 
+  *         SDRAM row is opened once. The batch is flushed automatically when 
+  *         it is full or when the text color or the layer changes.
+  * @param  Xpos: specifies the X position.
+  * @param  Ypos: specifies the Y position.
+  * @retval None
+  */
+void LCD_AddPoint(int16_t Xpos, int16_t Ypos)
+{
+  int32_t x = (int32_t)Xpos - ViewportX, y = (int32_t)Ypos - ViewportY;
+  
+  if ((x < CurrentClip.X0) || (x >= CurrentClip.X1) || 
+      (y < CurrentClip.Y0) || (y >= CurrentClip.Y1))
+  {
+    return;
+  }
+  
+  if ((PointNumber != 0) && ((PointColor != CurrentTextColor) || (PointLayer != CurrentLayer)))
+  {
+    LCD_FlushPoints();
+  }
+  if (PointNumber == 0)
+  {
+    PointColor = CurrentTextColor;
+    PointLayer = CurrentLayer;
+    PointFrameBuffer = CurrentFrameBuffer;
+    PointValue = LCD_PixelValue(CurrentTextColor);
+  }
+  
+  PointBuffer[PointNumber++] = x + (LCD_PIXEL_WIDTH*y);
+  if (PointNumber == LCD_POINT_BUFFER_SIZE)
+  {
+    LCD_FlushPoints();
+  }
+}
+
+/**
+  * @brief  Draws the pending points of the point batch.
+  * @param  None
+  * @retval None
+  */
+void LCD_FlushPoints(void)
+{
+  uint32_t index = 0, counter = 0, offset = 0, PixelSize = 0;
+  
+  /* Insertion sort: the batch is small and often nearly sorted */
+  for (index = 1; index < PointNumber; index++)
+  {
+    offset = PointBuffer[index];
+    for (counter = index; (counter > 0) && (PointBuffer[counter - 1] > offset); counter--)
+    {
+      PointBuffer[counter] = PointBuffer[counter - 1];
+    }
+    PointBuffer[counter] = offset;
+  }
+  
+  PixelSize = LAYER_PIXEL_SIZE(PointLayer);
+  for (index = 0; index < PointNumber; index++)
+  {
+    LCD_StorePixel(PointFrameBuffer + PixelSize*PointBuffer[index], PointValue, PixelSize);
+  }
+  PointNumber = 0;
+}
+
+/**
+  * @brief  Draws a list of points.
+  * @param  Points: pointer to the points array.
+  * @param  PointCount: Number of points.
+  * @retval None
+  */
+void LCD_DrawPoints(pPoint Points, uint16_t PointCount)
+{
+  while (PointCount--)
+  {
+    LCD_AddPoint(Points->X, Points->Y);
+    Points++;
+  }
+  LCD_FlushPoints();
+}
+
 /**
   * @brief  Displays an poly-line (between many points).
   * @param  Points: pointer to the points array.
@@ -1915,18 +2613,447 @@ static void LCD_AF_GPIOConfig(void)
 }
 
 /**
-  * @brief  Displays a pixel.
-  * @param  x: pixel x.
-  * @param  y: pixel y.  
+  * @brief  Stores a pixel value at a frame buffer address.
+  * @param  Address: pixel address.
+  * @param  Value: value returned by LCD_PixelValue().
+  * @param  PixelSize: 1 for a L8 layer, 2 for a RGB565 layer.
   * @retval None
   */
-static void PutPixel(int16_t x, int16_t y)
+static __INLINE void LCD_StorePixel(uint32_t Address, uint16_t Value, uint32_t PixelSize)
 { 
-  if(x < 0 || x > 239 || y < 0 || y > 319)
+  if (PixelSize == 1)
+  {
+    *(__IO uint8_t*) (Address) = (uint8_t)Value;
+  }
+  else
+  {
+    *(__IO uint16_t*) (Address) = Value;
+  }
+}
+
+/**
+  * @brief  Tests a box against the clip rectangle.
+  * @param  X0, Y0: top left corner, in screen coordinates.
+  * @param  X1, Y1: bottom right corner (included), in screen coordinates.
+  * @retval 1 if the box is fully clipped, 0 otherwise.
+  */
+static uint32_t LCD_ClipReject(int32_t X0, int32_t Y0, int32_t X1, int32_t Y1)
+{
+  return ((X1 < CurrentClip.X0) || (X0 >= CurrentClip.X1) || 
+          (Y1 < CurrentClip.Y0) || (Y0 >= CurrentClip.Y1)) ? 1 : 0;
+}
+
+/**
+  * @brief  Writes a pixel value in the current layer if it is not clipped.
+  * @param  Xpos: pixel x, in screen coordinates.
+  * @param  Ypos: pixel y, in screen coordinates.
+  * @param  Value: value returned by LCD_PixelValue().
+  * @retval None
+  */
+static void LCD_PutClippedPixel(int32_t Xpos, int32_t Ypos, uint16_t Value)
+{
+  if ((Xpos < CurrentClip.X0) || (Xpos >= CurrentClip.X1) || 
+      (Ypos < CurrentClip.Y0) || (Ypos >= CurrentClip.Y1))
+  {
+    return;
+  }
+  LCD_WritePixel(Xpos + (LCD_PIXEL_WIDTH*Ypos), Value);
+}
+
+/**
+  * @brief  Fills a rectangle of the current layer, trimmed to the clip rectangle.
+  * @param  Xpos: specifies the X position, in screen coordinates.
+  * @param  Ypos: specifies the Y position, in screen coordinates.
+  * @param  Width: rectangle width.
+  * @param  Height: rectangle height.
+  * @param  Color: color code RGB(5-6-5).
+  * @retval None
+  */
+static void LCD_FillClippedRect(int32_t Xpos, int32_t Ypos, int32_t Width, int32_t Height, uint16_t Color)
+{
+  DMA2D_InitTypeDef      DMA2D_InitStruct;
+  
+  uint32_t  Xaddress = 0; 
+  uint16_t Red_Value = 0, Green_Value = 0, Blue_Value = 0;
+  int32_t x1 = Xpos + Width, y1 = Ypos + Height;
+  
+  /* Trim the span before any DMA2D setup */
+  if (Xpos < CurrentClip.X0) Xpos = CurrentClip.X0;
+  if (Ypos < CurrentClip.Y0) Ypos = CurrentClip.Y0;
+  if (x1 > CurrentClip.X1) x1 = CurrentClip.X1;
+  if (y1 > CurrentClip.Y1) y1 = CurrentClip.Y1;
+  if ((x1 <= Xpos) || (y1 <= Ypos))
+  {
+    return;
+  }
+  Width = x1 - Xpos;
+  Height = y1 - Ypos;
+  
+  if (LayerPalette[CurrentLayer].Colors != 0)
+  {
+    /* L8 mode: the DMA2D cannot output indexes, fill with the CPU */
+    LCD_FillRect8(LCD_PIXEL_WIDTH*Ypos + Xpos, Width, Height, LCD_PixelValue(Color));
+    return;
+  }
+ 
+  Red_Value = (0xF800 & Color) >> 11;
+  Blue_Value = 0x001F & Color;
+  Green_Value = (0x07E0 & Color) >> 5;
+  
+  Xaddress = CurrentFrameBuffer + 2*(LCD_PIXEL_WIDTH*Ypos + Xpos);
+  
+  /* configure DMA2D */
+  DMA2D_DeInit();
+  DMA2D_InitStruct.DMA2D_Mode = DMA2D_R2M;       
+  DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;      
+  DMA2D_InitStruct.DMA2D_OutputGreen = Green_Value;      
+  DMA2D_InitStruct.DMA2D_OutputBlue = Blue_Value;     
+  DMA2D_InitStruct.DMA2D_OutputRed = Red_Value;                
+  DMA2D_InitStruct.DMA2D_OutputAlpha = 0x0F;                  
+  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = Xaddress;                
+  DMA2D_InitStruct.DMA2D_OutputOffset = (LCD_PIXEL_WIDTH - Width);                
+  DMA2D_InitStruct.DMA2D_NumberOfLine = Height;            
+  DMA2D_InitStruct.DMA2D_PixelPerLine = Width;
+  DMA2D_Init(&DMA2D_InitStruct); 
+  
+  /* Start Transfer */ 
+  DMA2D_StartTransfer();
+  
+  /* Wait for CTC Flag activation */
+  while(DMA2D_GetFlagStatus(DMA2D_FLAG_TC) == RESET)
+  {
+  } 
+}
+
+/**
+  * @brief  Decodes the headers of a BMP picture.
+  * @param  pHeader: first BMP_HEADER_SIZE bytes of the picture.
+  * @param  pInfo: pointer to the picture layout to fill.
+  * @retval ERROR if the picture format is not supported, SUCCESS otherwise
+  */
+static ErrorStatus LCD_BMPParse(const uint8_t *pHeader, LCD_BmpInfo_TypeDef *pInfo)
+{
+  uint32_t header_size = 0, bit_pixel = 0, compression = 0, colors = 0;
+  int32_t width = 0, height = 0;
+  
+  if ((pHeader[0] != 'B') || (pHeader[1] != 'M'))
+  {
+    return ERROR;
+  }
+  
+  pInfo->DataOffset = pHeader[10] | (pHeader[11] << 8) | (pHeader[12] << 16) | ((uint32_t)pHeader[13] << 24);
+  header_size = pHeader[14] | (pHeader[15] << 8) | (pHeader[16] << 16) | ((uint32_t)pHeader[17] << 24);
+  width = (int32_t)(pHeader[18] | (pHeader[19] << 8) | (pHeader[20] << 16) | ((uint32_t)pHeader[21] << 24));
+  height = (int32_t)(pHeader[22] | (pHeader[23] << 8) | (pHeader[24] << 16) | ((uint32_t)pHeader[25] << 24));
+  bit_pixel = pHeader[28] | (pHeader[29] << 8);
+  compression = pHeader[30] | (pHeader[31] << 8) | (pHeader[32] << 16) | ((uint32_t)pHeader[33] << 24);
+  colors = pHeader[46] | (pHeader[47] << 8) | (pHeader[48] << 16) | ((uint32_t)pHeader[49] << 24);
+  
+  if ((width <= 0) || (height == 0) || (width > 0x3FFF) || (height > 0xFFFF) || (height < -0xFFFF))
+  {
+    return ERROR;
+  }
+  pInfo->Width = width;
+  pInfo->TopDown = (height < 0) ? 1 : 0;
+  pInfo->Height = (height < 0) ? -height : height;
+  pInfo->Stride = ((pInfo->Width*bit_pixel + 31)/32)*4;
+  pInfo->NumColors = 0;
+  pInfo->PaletteOffset = 14 + header_size;
+  
+  /* BI_RGB (0) for every format, BI_BITFIELDS (3) for the 16 and 32 bit/pixel ones */
+  if ((compression != 0) && ((compression != 3) || (bit_pixel == 8) || (bit_pixel == 24)))
+  {
+    return ERROR;
+  }
+  
+  switch (bit_pixel)
+  {
+  case 32:
+    /* B, G, R, A bytes: ARGB8888 in little endian */
+    pInfo->ColorMode = CM_ARGB8888;
+    break;
+  case 24:
+    pInfo->ColorMode = CM_RGB888;
+    break;
+  case 16:
+    /* X1R5G5B5 unless the red mask says R5G6B5 */
+    if ((compression == 3) && (pHeader[54] == 0x00) && (pHeader[55] == 0xF8))
+    {
+      pInfo->ColorMode = CM_RGB565;
+    }
+    else
+    {
+      pInfo->ColorMode = CM_ARGB1555;
+    }
+    break;
+  case 8:
+    /* B, G, R, 0 palette entries: ARGB8888 CLUT */
+    pInfo->ColorMode = CM_L8;
+    pInfo->NumColors = ((colors == 0) || (colors > BMP_MAX_COLORS)) ? BMP_MAX_COLORS : colors;
+    break;
+  default:
+    return ERROR;
+  }
+  pInfo->PixelSize = bit_pixel/8;
+  
+  return SUCCESS;
+}
+
+/**
+  * @brief  Clips a BMP picture drawn at Xpos, Ypos.
+  * @param  pInfo: picture layout.
+  * @param  pXpos, pYpos: picture position, returned in screen coordinates
+  *         for its first visible column.
+  * @param  pFirst, pLast: visible rows range, in file order (pLast excluded).
+  * @param  pXskip: hidden columns on the left of the picture.
+  * @param  pWidth: visible columns.
+  * @retval ERROR if the current layer is not in RGB565 mode, SUCCESS otherwise
+  */
+static ErrorStatus LCD_BMPClip(const LCD_BmpInfo_TypeDef *pInfo, int32_t *pXpos, int32_t *pYpos,
+                               uint32_t *pFirst, uint32_t *pLast, uint32_t *pXskip, uint32_t *pWidth)
+{
+  int32_t x0 = *pXpos - ViewportX, y0 = *pYpos - ViewportY;
+  int32_t x1 = x0 + pInfo->Width, y1 = y0 + pInfo->Height;
+  int32_t top = 0, bottom = 0;
+  
+  /* The DMA2D cannot output L8 indexes */
+  if (LayerPalette[CurrentLayer].Colors != 0)
+  {
+    return ERROR;
+  }
+  
+  *pYpos = y0;
+  *pFirst = 0;
+  *pLast = 0;
+  
+  if (x0 < CurrentClip.X0) x0 = CurrentClip.X0;
+  if (x1 > CurrentClip.X1) x1 = CurrentClip.X1;
+  top = (y0 < CurrentClip.Y0) ? CurrentClip.Y0 : y0;
+  bottom = (y1 > CurrentClip.Y1) ? CurrentClip.Y1 : y1;
+  if ((x1 <= x0) || (bottom <= top))
+  {
+    return SUCCESS;
+  }
+  
+  *pXskip = x0 - (*pXpos - ViewportX);
+  *pXpos = x0;
+  *pWidth = x1 - x0;
+  
+  if (pInfo->TopDown != 0)
+  {
+    *pFirst = top - y0;
+    *pLast = bottom - y0;
+  }
+  else
   {
-    return;  
+    *pFirst = y1 - bottom;
+    *pLast = y1 - top;
+  }
+  
+  return SUCCESS;
+}
+
+/**
+  * @brief  Configures the DMA2D to convert a BMP picture to RGB565.
+  * @note   The foreground and output addresses are set by the caller for
+  *         each job. In CM_L8 mode the CLUT is loaded from BmpClut.
+  * @param  pInfo: picture layout.
+  * @param  Width: pixels per line.
+  * @param  Height: lines per job.
+  * @param  FGOffset: pixels skipped at the end of each picture line.
+  * @retval None
+  */
+static void LCD_BMPConfig(const LCD_BmpInfo_TypeDef *pInfo, uint32_t Width, uint32_t Height, uint32_t FGOffset)
+{
+  DMA2D_InitTypeDef      DMA2D_InitStruct;
+  DMA2D_FG_InitTypeDef   DMA2D_FG_InitStruct;
+  
+  DMA2D_DeInit();
+  DMA2D_InitStruct.DMA2D_Mode = DMA2D_M2M_PFC;
+  DMA2D_InitStruct.DMA2D_CMode = DMA2D_RGB565;
+  DMA2D_InitStruct.DMA2D_OutputGreen = 0;
+  DMA2D_InitStruct.DMA2D_OutputBlue = 0;
+  DMA2D_InitStruct.DMA2D_OutputRed = 0;
+  DMA2D_InitStruct.DMA2D_OutputAlpha = 0;
+  DMA2D_InitStruct.DMA2D_OutputMemoryAdd = CurrentFrameBuffer;
+  DMA2D_InitStruct.DMA2D_OutputOffset = LCD_PIXEL_WIDTH - Width;
+  DMA2D_InitStruct.DMA2D_NumberOfLine = Height;
+  DMA2D_InitStruct.DMA2D_PixelPerLine = Width;
+  DMA2D_Init(&DMA2D_InitStruct);
+  
+  DMA2D_FG_StructInit(&DMA2D_FG_InitStruct);
+  DMA2D_FG_InitStruct.DMA2D_FGO = FGOffset;
+  DMA2D_FG_InitStruct.DMA2D_FGCM = pInfo->ColorMode;
+  if (pInfo->NumColors != 0)
+  {
+    DMA2D_FG_InitStruct.DMA2D_FG_CLUT_CM = CLUT_CM_ARGB8888;
+    DMA2D_FG_InitStruct.DMA2D_FG_CLUT_SIZE = pInfo->NumColors - 1;
+    DMA2D_FG_InitStruct.DMA2D_FGCMAR = (uint32_t)BmpClut;
+  }
+  DMA2D_FGConfig(&DMA2D_FG_InitStruct);
+  
+  if (pInfo->NumColors != 0)
+  {
+    /* Load the CLUT once for all the jobs of the picture */
+    DMA2D_FGStart(ENABLE);
+    while(DMA2D_GetFlagStatus(DMA2D_FLAG_CTC) == RESET)
+    {
+    }
+    DMA2D_ClearFlag(DMA2D_FLAG_CTC);
+  }
+}
+
+/**
+  * @brief  Block source read function of a memory mapped BMP picture.
+  * @param  pSource: picture address.
+  * @param  Offset: first byte to copy.
+  * @param  pBuffer: destination buffer.
+  * @param  Size: bytes to copy.
+  * @retval Bytes copied
+  */
+static uint32_t LCD_BMPReadMemory(void *pSource, uint32_t Offset, uint8_t *pBuffer, uint32_t Size)
+{
+  memcpy(pBuffer, (const uint8_t *)pSource + Offset, Size);
+  
+  return Size;
+}
+
+/**
+  * @brief  Programs the LTDC window of a layer from its LayerWindow settings.
+  * @param  Layerx: specifies the Layer foreground or background.
+  * @retval None
+  */
+static void LCD_LayerWindowUpdate(uint32_t Layerx)
+{
+  LTDC_Layer_TypeDef *LTDC_Layerx;
+  uint32_t Address = 0, hbp = 0, vbp = 0;
+  int32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+  
+  if (Layerx == LCD_BACKGROUND_LAYER)
+  {
+    LTDC_Layerx = LTDC_Layer1;
+    Address = LCD_FRAME_BUFFER;
+  }
+  else
+  {
+    LTDC_Layerx = LTDC_Layer2;
+    Address = LCD_LAYER2_FRAME_BUFFER;
+  }
+  
+  /* Clip the window to the active area */
+  x0 = LayerWindow[Layerx].Xpos;
+  y0 = LayerWindow[Layerx].Ypos;
+  x1 = x0 + LayerWindow[Layerx].Width;
+  y1 = y0 + LayerWindow[Layerx].Height;
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 > LCD_PIXEL_WIDTH) x1 = LCD_PIXEL_WIDTH;
+  if (y1 > LCD_PIXEL_HEIGHT) y1 = LCD_PIXEL_HEIGHT;
+  
+  if ((x1 <= x0) || (y1 <= y0))
+  {
+    /* Nothing left to show */
+    LTDC_LayerCmd(LTDC_Layerx, DISABLE);
+  }
+  else
+  {
+    /* Skip the clipped pixels at the beginning of the sprite */
+    Address += LAYER_PIXEL_SIZE(Layerx)*((x0 - LayerWindow[Layerx].Xpos) + LCD_PIXEL_WIDTH*(y0 - LayerWindow[Layerx].Ypos));
+    
+    /* Window positions are relative to the accumulated back porches */
+    hbp = (LTDC->BPCR >> 16) & 0xFFF;
+    vbp = LTDC->BPCR & 0x7FF;
+    LTDC_Layerx->WHPCR = (hbp + 1 + x0) | ((hbp + x1) << 16);
+    LTDC_Layerx->WVPCR = (vbp + 1 + y0) | ((vbp + y1) << 16);
+    
+    /* Keep the full frame buffer pitch, fetch only the visible pixels */
+    LTDC_Layerx->CFBAR = Address;
+    LTDC_Layerx->CFBLR = ((LCD_PIXEL_WIDTH * LAYER_PIXEL_SIZE(Layerx)) << 16) | (((x1 - x0) * LAYER_PIXEL_SIZE(Layerx)) + 3);
+    LTDC_Layerx->CFBLNR = y1 - y0;
+    
+    LTDC_LayerCmd(LTDC_Layerx, ENABLE);
+  }
+  
+  /* Apply the new window during the next vertical blanking */
+  LTDC_ReloadConfig(LTDC_VBReload);
+}
+
+/**
+  * @brief  Converts a color into the value stored in the current layer.
+  * @param  Color: color code RGB(5-6-5).
+  * @retval The color itself in RGB565 mode, the matching palette index (or the
+  *         nearest one) in L8 mode.
+  */
+static uint16_t LCD_PixelValue(uint16_t Color)
+{
+  const uint16_t *Colors = LayerPalette[CurrentLayer].Colors;
+  uint32_t index = 0, best = 0, distance = 0, bestdistance = 0xFFFFFFFF;
+  int32_t dr = 0, dg = 0, db = 0;
+  
+  if (Colors == 0)
+  {
+    return Color;
+  }
+  
+  for (index = 0; index < LayerPalette[CurrentLayer].NumColors; index++)
+  {
+    if (Colors[index] == Color)
+    {
+      return index;
+    }
+    dr = (int32_t)((Colors[index] >> 11) & 0x1F) - (int32_t)((Color >> 11) & 0x1F);
+    dg = (int32_t)((Colors[index] >> 5) & 0x3F) - (int32_t)((Color >> 5) & 0x3F);
+    db = (int32_t)(Colors[index] & 0x1F) - (int32_t)(Color & 0x1F);
+    distance = (4*dr*dr) + (dg*dg) + (4*db*db);
+    if (distance < bestdistance)
+    {
+      bestdistance = distance;
+      best = index;
+    }
+  }
+  
+  return best;
+}
+
+/**
+  * @brief  Writes a pixel value in the current layer.
+  * @param  Offset: pixel offset from the frame buffer start (X + 240*Y).
+  * @param  Value: value returned by LCD_PixelValue().
+  * @retval None
+  */
+static void LCD_WritePixel(uint32_t Offset, uint16_t Value)
+{
+  if (LayerPalette[CurrentLayer].Colors != 0)
+  {
+    *(__IO uint8_t*) (CurrentFrameBuffer + Offset) = (uint8_t)Value;
+  }
+  else
+  {
+    *(__IO uint16_t*) (CurrentFrameBuffer + (2*Offset)) = Value;
+  }
+}
+
+/**
+  * @brief  Fills a rectangle of the current L8 layer with a palette index.
+  * @param  Offset: pixel offset of the top left corner (X + 240*Y).
+  * @param  Width: rectangle width.
+  * @param  Height: rectangle height.
+  * @param  Index: palette index.
+  * @retval None
+  */
+static void LCD_FillRect8(uint32_t Offset, uint16_t Width, uint16_t Height, uint8_t Index)
+{
+  uint32_t Address = 0, counter = 0;
+  
+  Address = CurrentFrameBuffer + Offset;
+  while (Height--)
+  {
+    for (counter = 0; counter < Width; counter++)
+    {
+      *(__IO uint8_t*) (Address + counter) = Index;
+    }
+    Address += LCD_PIXEL_WIDTH;
   }
-  LCD_DrawLine(x, y, 1, LCD_DIR_HORIZONTAL);
 }
 
 #ifndef USE_Delay
@@ -38,6 +38,7 @@
 #include "stm32f4xx.h"
 #include "stm32f429i_discovery.h"
 #include "stm32f429i_discovery_sdram.h"
+#include "stm32f429i_discovery_sdram_alloc.h"
 #include "../Common/fonts.h"
 
 /** @addtogroup Utilities
@@ -65,6 +66,13 @@ typedef struct
   int16_t X;
   int16_t Y;
 } Point, * pPoint;   
+
+/** 
+  * @brief  BMP block source: copies Size bytes of the picture, starting at
+  *         byte Offset of the file, to pBuffer and returns the number of
+  *         bytes copied.
+  */ 
+typedef uint32_t (*LCD_ReadBlock_TypeDef)(void *pSource, uint32_t Offset, uint8_t *pBuffer, uint32_t Size);
 /**
   * @}
   */ 
@@ -79,6 +87,26 @@ typedef struct
 
 #define LCD_FRAME_BUFFER       ((uint32_t)0xD0000000)
 #define BUFFER_OFFSET          ((uint32_t)0x50000) 
+
+/* Placement of the frame buffers in the SDRAM internal banks (A22:A21).
+   Each internal bank keeps one row open: when the LTDC reads the two layers
+   and the CPU or the DMA2D draws in the same bank, every switch between the
+   streams costs a precharge and an activate.
+    - LCD_FB_PLACEMENT_CONTIGUOUS: layer 2 follows layer 1 (BUFFER_OFFSET),
+      all the buffers are in bank 0.
+    - LCD_FB_PLACEMENT_INTERLEAVED: layer 1 in bank 0, layer 2 in bank 1. */
+#define LCD_FB_PLACEMENT_CONTIGUOUS    0
+#define LCD_FB_PLACEMENT_INTERLEAVED   1
+
+#ifndef LCD_FB_PLACEMENT
+ #define LCD_FB_PLACEMENT       LCD_FB_PLACEMENT_CONTIGUOUS
+#endif /* LCD_FB_PLACEMENT */
+
+#if (LCD_FB_PLACEMENT == LCD_FB_PLACEMENT_INTERLEAVED)
+ #define LCD_LAYER2_FRAME_BUFFER  (LCD_FRAME_BUFFER + SDRAM_INTERNAL_BANK_SIZE)
+#else
+ #define LCD_LAYER2_FRAME_BUFFER  (LCD_FRAME_BUFFER + BUFFER_OFFSET)
+#endif /* LCD_FB_PLACEMENT */
 /**
  * @brief Uncomment the line below if you want to use user defined Delay function
  *        (for precise timing), otherwise default _delay_ function defined within
@@ -242,6 +270,16 @@ typedef struct
 #define LCD_BACKGROUND_LAYER     0x0000
 #define LCD_FOREGROUND_LAYER     0x0001
 
+/** 
+  * @brief  LCD clip stack depth (nested LCD_PushClipRect calls)  
+  */ 
+#define LCD_CLIP_STACK_SIZE      8
+
+/** 
+  * @brief  LCD point batch size (points drawn at once by LCD_FlushPoints)  
+  */ 
+#define LCD_POINT_BUFFER_SIZE    64
+
 /**
   * @}
   */ 
@@ -270,9 +308,14 @@ void     LCD_SetBackColor(uint16_t Color);
 void     LCD_SetTransparency(uint8_t transparency);
 void     LCD_ClearLine(uint16_t Line);
 void     LCD_Clear(uint16_t Color);
+void     LCD_MoveLines(uint16_t YposSrc, uint16_t YposDst, uint16_t Height);
 uint32_t LCD_SetCursor(uint16_t Xpos, uint16_t Ypos);
 void     LCD_SetColorKeying(uint32_t RGBValue);
 void     LCD_ReSetColorKeying(void);
+void     LCD_SetPalette(const uint16_t *Palette, uint16_t NumColors);
+void     LCD_ReSetPalette(void);
+uint32_t LCD_GetScanoutBytes(void);
+uint16_t LCD_GetPixel(uint16_t Xpos, uint16_t Ypos);
 void     LCD_DrawChar(uint16_t Xpos, uint16_t Ypos, const uint16_t *c);
 void     LCD_DisplayChar(uint16_t Line, uint16_t Column, uint8_t Ascii);
 void     LCD_SetFont(sFONT *fonts);
@@ -280,6 +323,11 @@ sFONT *  LCD_GetFont(void);
 void     LCD_DisplayStringLine(uint16_t Line, uint8_t *ptr);
 void     LCD_SetDisplayWindow(uint16_t Xpos, uint16_t Ypos, uint16_t Height, uint16_t Width);
 void     LCD_WindowModeDisable(void);
+ErrorStatus LCD_PushClipRect(int16_t Xpos, int16_t Ypos, uint16_t Width, uint16_t Height);
+void     LCD_PopClipRect(void);
+void     LCD_SetViewport(int16_t Xorigin, int16_t Yorigin);
+void     LCD_SetLayerWindow(uint32_t Layerx, uint16_t Width, uint16_t Height);
+void     LCD_SetLayerPosition(uint32_t Layerx, int16_t Xpos, int16_t Ypos);
 void     LCD_DrawLine(uint16_t Xpos, uint16_t Ypos, uint16_t Length, uint8_t Direction);
 void     LCD_DrawRect(uint16_t Xpos, uint16_t Ypos, uint16_t Height, uint16_t Width);
 void     LCD_DrawCircle(uint16_t Xpos, uint16_t Ypos, uint16_t Radius);
@@ -287,6 +335,8 @@ void     LCD_DrawEllipse(int Xpos, int Ypos, int Radius, int Radius2);
 void     LCD_DrawFullEllipse(int Xpos, int Ypos, int Radius, int Radius2);
 void     LCD_DrawMonoPict(const uint32_t *Pict);
 void     LCD_WriteBMP(uint32_t BmpAddress);
+ErrorStatus LCD_DrawBMP(uint32_t BmpAddress, int16_t Xpos, int16_t Ypos);
+ErrorStatus LCD_DrawBMPFromSource(LCD_ReadBlock_TypeDef ReadBlock, void *pSource, int16_t Xpos, int16_t Ypos);
 void     LCD_DrawUniLine(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
 void     LCD_DrawFullRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Height);
 void     LCD_DrawFullCircle(uint16_t Xpos, uint16_t Ypos, uint16_t Radius);
@@ -297,6 +347,9 @@ void     LCD_ClosedPolyLineRelative(pPoint Points, uint16_t PointCount);
 void     LCD_FillPolyLine(pPoint Points, uint16_t PointCount);
 void     LCD_Triangle(pPoint Points, uint16_t PointCount);
 void     LCD_FillTriangle(uint16_t x1, uint16_t x2, uint16_t x3, uint16_t y1, uint16_t y2, uint16_t y3);
+void     LCD_AddPoint(int16_t Xpos, int16_t Ypos);
+void     LCD_FlushPoints(void);
+void     LCD_DrawPoints(pPoint Points, uint16_t PointCount);
 void     LCD_WriteCommand(uint8_t LCD_Reg);
 void     LCD_WriteData(uint8_t value);
 void     LCD_PowerOn(void);
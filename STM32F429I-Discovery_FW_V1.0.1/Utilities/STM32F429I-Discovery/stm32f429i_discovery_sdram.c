@@ -29,6 +29,8 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery_sdram.h"
 #include "stm32f4xx_fmc.h"
+#include "stm32f4xx_dma.h"
+#include "misc.h"
 /** @addtogroup Utilities
   * @{
   */ 
@@ -51,9 +53,28 @@
   * @{
   */
 
+/* Largest DMA chunk: NDTR is 16-bit, a multiple of the 4 beats bursts */
+#define SDRAM_DMA_MAX_WORDS      ((uint32_t)65532)
+
+/* The CCM data RAM is only on the CPU D-bus: the DMA cannot reach it */
+#define SDRAM_IS_CCM(ADDRESS)    (((ADDRESS) >= CCMDATARAM_BASE) && ((ADDRESS) < (CCMDATARAM_BASE + 0x10000)))
+
+/* Asynchronous copy state */
+static uint8_t  SDRAM_DMAReady = 0;
+static __IO uint32_t SDRAM_DMAStatus = SDRAM_DMA_OK;
+static uint32_t SDRAM_DMASource = 0;
+static uint32_t SDRAM_DMADestination = 0;
+static uint32_t SDRAM_DMARemaining = 0;               /* words after the current chunk */
+static SDRAM_DMACallback_TypeDef SDRAM_DMACallback = 0;
+static void *SDRAM_DMAContext = 0;
+
 #ifndef USE_Delay
 static void delay(__IO uint32_t nCount);
 #endif /* USE_Delay*/
+static uint32_t SDRAM_DMAStart(uint32_t Source, uint32_t Destination, uint32_t Words,
+                               SDRAM_DMACallback_TypeDef Callback, void *pContext);
+static void SDRAM_DMANext(void);
+static void SDRAM_CopyWords(uint32_t *pDestination, const uint32_t *pSource, uint32_t Words);
 
 /**
   * @brief  Configures the FMC and GPIOs to interface with the SDRAM memory.
@@ -337,6 +358,10 @@ void SDRAM_InitSequence(void)
 
 /**
   * @brief  Writes a Entire-word buffer to the SDRAM memory. 
+  * @note   Buffers of SDRAM_DMA_THRESHOLD words or more are copied by the DMA2
+  *         stream, the function waits for the end of the copy. The CPU copies
+  *         the buffers in the CCM data RAM, and all the buffers in interrupt
+  *         context: the DMA interrupt could not preempt the wait.
   * @param  pBuffer: pointer to buffer. 
   * @param  uwWriteAddress: SDRAM memory internal address from which the data will be 
   *         written.
@@ -345,8 +370,6 @@ void SDRAM_InitSequence(void)
   */
 void SDRAM_WriteBuffer(uint32_t* pBuffer, uint32_t uwWriteAddress, uint32_t uwBufferSize)
 {
-  __IO uint32_t write_pointer = (uint32_t)uwWriteAddress;
-
   /* Disable write protection */
   FMC_SDRAMWriteProtectionConfig(FMC_Bank2_SDRAM, DISABLE);
   
@@ -355,20 +378,24 @@ void SDRAM_WriteBuffer(uint32_t* pBuffer, uint32_t uwWriteAddress, uint32_t uwBu
   {
   }
 
-  /* While there is data to write */
-  for (; uwBufferSize != 0; uwBufferSize--) 
+  /* Short buffer, interrupt context, CCM buffer or DMA used by an
+     asynchronous copy: CPU copy */
+  if ((uwBufferSize < SDRAM_DMA_THRESHOLD) || (__get_IPSR() != 0) ||
+      (SDRAM_DMAStart((uint32_t)pBuffer, SDRAM_BANK_ADDR + uwWriteAddress, uwBufferSize, 0, 0) != SDRAM_DMA_OK))
   {
-    /* Transfer data to the memory */
-    *(uint32_t *) (SDRAM_BANK_ADDR + write_pointer) = *pBuffer++;
-
-    /* Increment the address*/
-    write_pointer += 4;
+    SDRAM_CopyWords((uint32_t *)(SDRAM_BANK_ADDR + uwWriteAddress), pBuffer, uwBufferSize);
+    return;
   }
-    
+
+  SDRAM_DMA_Wait();
 }
 
 /**
   * @brief  Reads data buffer from the SDRAM memory. 
+  * @note   Buffers of SDRAM_DMA_THRESHOLD words or more are copied by the DMA2
+  *         stream, the function waits for the end of the copy. The CPU copies
+  *         the buffers in the CCM data RAM, and all the buffers in interrupt
+  *         context: the DMA interrupt could not preempt the wait.
   * @param  pBuffer: pointer to buffer. 
   * @param  ReadAddress: SDRAM memory internal address from which the data will be 
   *         read.
@@ -377,22 +404,271 @@ void SDRAM_WriteBuffer(uint32_t* pBuffer, uint32_t uwWriteAddress, uint32_t uwBu
   */
 void SDRAM_ReadBuffer(uint32_t* pBuffer, uint32_t uwReadAddress, uint32_t uwBufferSize)
 {
-  __IO uint32_t write_pointer = (uint32_t)uwReadAddress;
-  
-   
   /* Wait until the SDRAM controller is ready */ 
   while(FMC_GetFlagStatus(FMC_Bank2_SDRAM, FMC_FLAG_Busy) != RESET)
   {
   }
   
-  /* Read data */
-  for(; uwBufferSize != 0x00; uwBufferSize--)
+  /* Short buffer, interrupt context, CCM buffer or DMA used by an
+     asynchronous copy: CPU copy */
+  if ((uwBufferSize < SDRAM_DMA_THRESHOLD) || (__get_IPSR() != 0) ||
+      (SDRAM_DMAStart(SDRAM_BANK_ADDR + uwReadAddress, (uint32_t)pBuffer, uwBufferSize, 0, 0) != SDRAM_DMA_OK))
   {
-   *pBuffer++ = *(__IO uint32_t *)(SDRAM_BANK_ADDR + write_pointer );
-    
-   /* Increment the address*/
-    write_pointer += 4;
-  } 
+    SDRAM_CopyWords(pBuffer, (uint32_t *)(SDRAM_BANK_ADDR + uwReadAddress), uwBufferSize);
+    return;
+  }
+
+  SDRAM_DMA_Wait();
+}
+
+/**
+  * @brief  Starts writing an Entire-word buffer to the SDRAM memory with the
+  *         DMA2 stream, the function returns at once.
+  * @note   The buffer must not be changed before the end of the copy.
+  * @param  pBuffer: pointer to buffer. 
+  * @param  uwWriteAddress: SDRAM memory internal address from which the data will be 
+  *         written.
+  * @param  uwBufferSize: number of words to write. 
+  * @param  Callback: function called at the end of the copy, from the DMA
+  *         interrupt, may be 0.
+  * @param  pContext: parameter of the callback.
+  * @retval SDRAM_DMA_OK if the copy started, SDRAM_DMA_BUSY if a copy is in
+  *         progress, SDRAM_DMA_ERROR if the buffer is in the CCM data RAM.
+  */
+uint32_t SDRAM_WriteBufferAsync(uint32_t* pBuffer, uint32_t uwWriteAddress, uint32_t uwBufferSize,
+                                SDRAM_DMACallback_TypeDef Callback, void *pContext)
+{
+  /* Disable write protection */
+  FMC_SDRAMWriteProtectionConfig(FMC_Bank2_SDRAM, DISABLE);
+  
+  return SDRAM_DMAStart((uint32_t)pBuffer, SDRAM_BANK_ADDR + uwWriteAddress, uwBufferSize,
+                        Callback, pContext);
+}
+
+/**
+  * @brief  Starts reading data buffer from the SDRAM memory with the DMA2
+  *         stream, the function returns at once.
+  * @param  pBuffer: pointer to buffer. 
+  * @param  uwReadAddress: SDRAM memory internal address from which the data will be 
+  *         read.
+  * @param  uwBufferSize: number of words to read. 
+  * @param  Callback: function called at the end of the copy, from the DMA
+  *         interrupt, may be 0.
+  * @param  pContext: parameter of the callback.
+  * @retval SDRAM_DMA_OK if the copy started, SDRAM_DMA_BUSY if a copy is in
+  *         progress, SDRAM_DMA_ERROR if the buffer is in the CCM data RAM.
+  */
+uint32_t SDRAM_ReadBufferAsync(uint32_t* pBuffer, uint32_t uwReadAddress, uint32_t uwBufferSize,
+                               SDRAM_DMACallback_TypeDef Callback, void *pContext)
+{
+  return SDRAM_DMAStart(SDRAM_BANK_ADDR + uwReadAddress, (uint32_t)pBuffer, uwBufferSize,
+                        Callback, pContext);
+}
+
+/**
+  * @brief  Checks if an asynchronous copy is in progress.
+  * @param  None
+  * @retval 1 if the DMA stream is busy, 0 otherwise.
+  */
+uint8_t SDRAM_DMA_IsBusy(void)
+{
+  return (SDRAM_DMAStatus == SDRAM_DMA_BUSY);
+}
+
+/**
+  * @brief  Waits for the end of the asynchronous copy.
+  * @param  None
+  * @retval SDRAM_DMA_OK or SDRAM_DMA_ERROR, status of the last copy.
+  */
+uint32_t SDRAM_DMA_Wait(void)
+{
+  while (SDRAM_DMAStatus == SDRAM_DMA_BUSY)
+  {
+  }
+
+  return SDRAM_DMAStatus;
+}
+
+/**
+  * @brief  This function handles the SDRAM DMA stream interrupt: starts the
+  *         next chunk of the copy or ends it.
+  * @param  None
+  * @retval None
+  */
+void SDRAM_DMA_IRQHandler(void)
+{
+  SDRAM_DMACallback_TypeDef callback = SDRAM_DMACallback;
+  void *context = SDRAM_DMAContext;
+  uint32_t status = SDRAM_DMA_OK;
+
+  if (DMA_GetITStatus(SDRAM_DMA_STREAM, SDRAM_DMA_IT_TE) != RESET)
+  {
+    DMA_ClearITPendingBit(SDRAM_DMA_STREAM, SDRAM_DMA_IT_TE | SDRAM_DMA_IT_TC);
+    DMA_Cmd(SDRAM_DMA_STREAM, DISABLE);
+    status = SDRAM_DMA_ERROR;
+  }
+  else if (DMA_GetITStatus(SDRAM_DMA_STREAM, SDRAM_DMA_IT_TC) != RESET)
+  {
+    DMA_ClearITPendingBit(SDRAM_DMA_STREAM, SDRAM_DMA_IT_TC);
+    if (SDRAM_DMARemaining != 0)
+    {
+      SDRAM_DMANext();
+      return;
+    }
+  }
+  else
+  {
+    return;
+  }
+
+  /* The callback may start the next copy */
+  SDRAM_DMARemaining = 0;
+  SDRAM_DMAStatus = status;
+  if (callback != 0)
+  {
+    callback(status, context);
+  }
+}
+
+/**
+  * @brief  Starts a memory-to-memory copy on the DMA2 stream.
+  * @param  Source: first source address, word aligned.
+  * @param  Destination: first destination address, word aligned.
+  * @param  Words: number of words.
+  * @param  Callback: end of copy callback, may be 0.
+  * @param  pContext: parameter of the callback.
+  * @retval SDRAM_DMA_OK if the copy started, SDRAM_DMA_BUSY if a copy is in
+  *         progress, SDRAM_DMA_ERROR if the DMA cannot reach the buffer.
+  */
+static uint32_t SDRAM_DMAStart(uint32_t Source, uint32_t Destination, uint32_t Words,
+                               SDRAM_DMACallback_TypeDef Callback, void *pContext)
+{
+  NVIC_InitTypeDef NVIC_InitStructure;
+  uint32_t primask = __get_PRIMASK();
+
+  if (SDRAM_IS_CCM(Source) || SDRAM_IS_CCM(Destination))
+  {
+    return SDRAM_DMA_ERROR;
+  }
+
+  /* Claim the stream: the callbacks run in interrupt context */
+  __disable_irq();
+  if (SDRAM_DMAStatus == SDRAM_DMA_BUSY)
+  {
+    __set_PRIMASK(primask);
+    return SDRAM_DMA_BUSY;
+  }
+  SDRAM_DMAStatus = SDRAM_DMA_BUSY;
+  __set_PRIMASK(primask);
+
+  if (SDRAM_DMAReady == 0)
+  {
+    RCC_AHB1PeriphClockCmd(SDRAM_DMA_CLK, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = SDRAM_DMA_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = SDRAM_DMA_PREPRIO;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = SDRAM_DMA_SUBPRIO;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    SDRAM_DMAReady = 1;
+  }
+
+  SDRAM_DMASource = Source;
+  SDRAM_DMADestination = Destination;
+  SDRAM_DMARemaining = Words;
+  SDRAM_DMACallback = Callback;
+  SDRAM_DMAContext = pContext;
+
+  if (Words == 0)
+  {
+    SDRAM_DMAStatus = SDRAM_DMA_OK;
+    if (Callback != 0)
+    {
+      Callback(SDRAM_DMA_OK, pContext);
+    }
+    return SDRAM_DMA_OK;
+  }
+
+  SDRAM_DMANext();
+
+  return SDRAM_DMA_OK;
+}
+
+/**
+  * @brief  Programs and starts the next chunk of the copy.
+  * @param  None
+  * @retval None
+  */
+static void SDRAM_DMANext(void)
+{
+  DMA_InitTypeDef DMA_InitStructure;
+  uint32_t words = SDRAM_DMARemaining, burst = DMA_MemoryBurst_Single;
+
+  if (words > SDRAM_DMA_MAX_WORDS)
+  {
+    words = SDRAM_DMA_MAX_WORDS;
+  }
+
+  /* Bursts of 4 words (INC16 is only allowed with byte data in a 16 bytes
+     FIFO): aligned on 16 bytes they never cross a 1 KB boundary */
+  if ((((SDRAM_DMASource | SDRAM_DMADestination) & 0xF) == 0) && ((words & 3) == 0))
+  {
+    burst = DMA_MemoryBurst_INC4;
+  }
+
+  DMA_StructInit(&DMA_InitStructure);
+  DMA_InitStructure.DMA_Channel = SDRAM_DMA_CHANNEL;
+  DMA_InitStructure.DMA_PeripheralBaseAddr = SDRAM_DMASource;
+  DMA_InitStructure.DMA_Memory0BaseAddr = SDRAM_DMADestination;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToMemory;
+  DMA_InitStructure.DMA_BufferSize = words;
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Enable;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+  DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Enable;
+  DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+  DMA_InitStructure.DMA_MemoryBurst = burst;
+  /* Same encoding for the peripheral (source) side */
+  DMA_InitStructure.DMA_PeripheralBurst = (burst == DMA_MemoryBurst_INC4) ? DMA_PeripheralBurst_INC4 : DMA_PeripheralBurst_Single;
+  DMA_Init(SDRAM_DMA_STREAM, &DMA_InitStructure);
+
+  SDRAM_DMASource += words * 4;
+  SDRAM_DMADestination += words * 4;
+  SDRAM_DMARemaining -= words;
+
+  DMA_ClearFlag(SDRAM_DMA_STREAM, SDRAM_DMA_FLAGS);
+  DMA_ITConfig(SDRAM_DMA_STREAM, DMA_IT_TC | DMA_IT_TE, ENABLE);
+  DMA_Cmd(SDRAM_DMA_STREAM, ENABLE);
+}
+
+/**
+  * @brief  Copies words with the CPU.
+  * @param  pDestination: destination, word aligned.
+  * @param  pSource: source, word aligned.
+  * @param  Words: number of words.
+  * @retval None
+  */
+static void SDRAM_CopyWords(uint32_t *pDestination, const uint32_t *pSource, uint32_t Words)
+{
+  /* Not volatile: the compiler groups the accesses in LDM/STM bursts */
+  for (; Words >= 4; Words -= 4)
+  {
+    pDestination[0] = pSource[0];
+    pDestination[1] = pSource[1];
+    pDestination[2] = pSource[2];
+    pDestination[3] = pSource[3];
+    pDestination += 4;
+    pSource += 4;
+  }
+
+  for (; Words != 0; Words--)
+  {
+    *pDestination++ = *pSource++;
+  }
 }
 
 #ifndef USE_Delay
@@ -123,10 +123,52 @@
 #define SDRAM_MODEREG_WRITEBURST_MODE_PROGRAMMED ((uint16_t)0x0000) 
 #define SDRAM_MODEREG_WRITEBURST_MODE_SINGLE     ((uint16_t)0x0200)      
 
+/**
+  * @brief  SDRAM copy engine: DMA2 memory-to-memory stream
+  */
+#define SDRAM_DMA_CLK            RCC_AHB1Periph_DMA2
+#define SDRAM_DMA_STREAM         DMA2_Stream0
+#define SDRAM_DMA_CHANNEL        DMA_Channel_0
+#define SDRAM_DMA_IT_TC          DMA_IT_TCIF0
+#define SDRAM_DMA_IT_TE          DMA_IT_TEIF0
+#define SDRAM_DMA_FLAGS          (DMA_FLAG_FEIF0 | DMA_FLAG_DMEIF0 | DMA_FLAG_TEIF0 | \
+                                  DMA_FLAG_HTIF0 | DMA_FLAG_TCIF0)
+#define SDRAM_DMA_IRQn           DMA2_Stream0_IRQn
+#define SDRAM_DMA_IRQHandler     DMA2_Stream0_IRQHandler
+#define SDRAM_DMA_PREPRIO        1
+#define SDRAM_DMA_SUBPRIO        0
+
+/* Buffers shorter than SDRAM_DMA_THRESHOLD words are copied by the CPU by
+   SDRAM_WriteBuffer() and SDRAM_ReadBuffer(): the DMA setup costs more */
+#ifndef SDRAM_DMA_THRESHOLD
+ #define SDRAM_DMA_THRESHOLD     64
+#endif /* SDRAM_DMA_THRESHOLD */
+
+/**
+  * @brief  SDRAM copy engine status
+  */
+#define SDRAM_DMA_OK             0
+#define SDRAM_DMA_BUSY           1
+#define SDRAM_DMA_ERROR          2
+
 /**
   * @}
   */  
 
+/** @defgroup STM32429I_DISCO_SDRAM_Exported_Types
+  * @{
+  */
+
+/**
+  * @brief  Asynchronous copy completion callback, called from the DMA
+  *         interrupt with SDRAM_DMA_OK or SDRAM_DMA_ERROR
+  */
+typedef void (*SDRAM_DMACallback_TypeDef)(uint32_t Status, void *pContext);
+
+/**
+  * @}
+  */
+
 /** @defgroup STM32429I_DISCO_SDRAM_Exported_Functions
   * @{
   */ 
@@ -135,6 +177,13 @@ void  SDRAM_GPIOConfig(void);
 void  SDRAM_InitSequence(void);
 void  SDRAM_WriteBuffer(uint32_t* pBuffer, uint32_t uwWriteAddress, uint32_t uwBufferSize);
 void  SDRAM_ReadBuffer(uint32_t* pBuffer, uint32_t uwReadAddress, uint32_t uwBufferSize);
+uint32_t SDRAM_WriteBufferAsync(uint32_t* pBuffer, uint32_t uwWriteAddress, uint32_t uwBufferSize,
+                                SDRAM_DMACallback_TypeDef Callback, void *pContext);
+uint32_t SDRAM_ReadBufferAsync(uint32_t* pBuffer, uint32_t uwReadAddress, uint32_t uwBufferSize,
+                               SDRAM_DMACallback_TypeDef Callback, void *pContext);
+uint8_t  SDRAM_DMA_IsBusy(void);
+uint32_t SDRAM_DMA_Wait(void);
+void     SDRAM_DMA_IRQHandler(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,696 @@
+/**
+  ******************************************************************************
+  * @file    stm32f429i_discovery_sdram_alloc.c
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    28-October-2013
+  * @brief   This file provides the allocation of the SDRAM memory
+  *          (IS42S16400J) mounted on STM32F429I-DISCO Kit between its users:
+  *          LCD frame buffers, graphic library heap, pools and arenas.
+  *
+  *          ===================================================================
+  *          Notes:
+  *           - The SDRAM is split in named regions, recorded in a table sorted
+  *             by address. A region is either reserved at a fixed address
+  *             (SDRAM_RegionReserve(), for the buffers whose address is set by
+  *             the hardware configuration) or placed by the allocator in the
+  *             first free gap (SDRAM_RegionAlloc()). An overlap is refused, so
+  *             two users can no longer share a buffer by mistake.
+  *           - The regions are the memory map of the application: they are
+  *             set up at startup and never freed. SDRAM_RegionPrintMap()
+  *             prints them with the free gaps.
+  *           - SDRAM_RegionAllocInBank() places a region in one internal bank
+  *             of the SDRAM. Buffers accessed at the same time (two LTDC
+  *             layers, a layer and the drawing target) should be placed in
+  *             different banks: each bank keeps its own row open.
+  *           - A pool (SDRAM_PoolInit()) gives blocks of a fixed size, for
+  *             sprites or decoded pictures. Its free blocks are linked through
+  *             their first word. SDRAM_PoolAlloc() and SDRAM_PoolFree() can be
+  *             called from interrupts.
+  *           - An arena (SDRAM_ArenaInit()) gives buffers of any size,
+  *             released all together or back to a mark.
+  *           - The SDRAM must be initialized (SDRAM_Init()) before a pool is
+  *             used. The region functions only update the table.
+  *          ===================================================================
+  *
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f429i_discovery_sdram_alloc.h"
+
+/** @addtogroup Utilities
+  * @{
+  */
+
+/** @addtogroup STM32F4_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY_SDRAM_ALLOC
+  * @brief      This file provides the SDRAM region allocator of STM32F429I
+  *             Discovery Kit.
+  * @{
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Private_Types
+  * @{
+  */
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Private_Defines
+  * @{
+  */
+#define SDRAM_END_ADDR          (SDRAM_BANK_ADDR + SDRAM_SIZE)
+#define SDRAM_MAP_LINE_SIZE     96
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Private_Macros
+  * @{
+  */
+#define SDRAM_ALIGN(ADDRESS, ALIGNMENT)  (((ADDRESS) + (ALIGNMENT) - 1) & ~((ALIGNMENT) - 1))
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Private_Variables
+  * @{
+  */
+static SDRAM_Region_TypeDef SDRAMRegions[SDRAM_REGIONS_MAX];   /* sorted by address */
+static uint32_t SDRAMRegionCount = 0;
+
+static const char * const SDRAMRegionTypeName[] =
+{
+  "framebuffer",
+  "heap",
+  "pool",
+  "arena",
+  "buffer"
+};
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Private_Function_Prototypes
+  * @{
+  */
+static uint32_t SDRAM_RegionFit(uint32_t Start, uint32_t End, uint32_t Size, uint32_t Alignment);
+static uint32_t SDRAM_RegionInsert(const char *pName, SDRAM_RegionType_TypeDef Type, uint32_t Address, uint32_t Size);
+static void     SDRAM_MapLine(void (*pPutString)(const char *pString), uint32_t Address, uint32_t Size,
+                              const char *pType, const char *pName);
+static char*    SDRAM_FormatHex(char *pLine, uint32_t Value);
+static char*    SDRAM_FormatDecimal(char *pLine, uint32_t Value, uint32_t Width);
+static char*    SDRAM_FormatString(char *pLine, const char *pString, uint32_t Width);
+/**
+  * @}
+  */
+
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  Reserves a region at a fixed address.
+  * @note   Reserving again the same region (same address, size and type)
+  *         succeeds, so that an initialization function can be called again.
+  * @param  pName: region name, a static string shown in the memory map.
+  * @param  Type: region use.
+  * @param  Address: region start, in the SDRAM.
+  * @param  Size: region size in bytes.
+  * @retval Region start, 0 if the region is out of the SDRAM, overlaps another
+  *         region or the table is full.
+  */
+uint32_t SDRAM_RegionReserve(const char *pName, SDRAM_RegionType_TypeDef Type, uint32_t Address, uint32_t Size)
+{
+  uint32_t index = 0;
+
+  if ((Size == 0) || (Address < SDRAM_BANK_ADDR) || (Address >= SDRAM_END_ADDR) ||
+      (Size > (SDRAM_END_ADDR - Address)))
+  {
+    return 0;
+  }
+
+  for (index = 0; index < SDRAMRegionCount; index++)
+  {
+    if ((SDRAMRegions[index].Address == Address) && (SDRAMRegions[index].Size == Size) &&
+        (SDRAMRegions[index].Type == Type))
+    {
+      return Address;
+    }
+    if ((Address < (SDRAMRegions[index].Address + SDRAMRegions[index].Size)) &&
+        (SDRAMRegions[index].Address < (Address + Size)))
+    {
+      return 0;
+    }
+  }
+
+  return SDRAM_RegionInsert(pName, Type, Address, Size);
+}
+
+/**
+  * @brief  Allocates a region in the first free gap of the SDRAM.
+  * @param  pName: region name, a static string shown in the memory map.
+  * @param  Type: region use.
+  * @param  Size: region size in bytes.
+  * @param  Alignment: alignment of the region start, a power of 2. 0 selects
+  *         a word alignment.
+  * @retval Region start, 0 if there is no free gap large enough or the table
+  *         is full.
+  */
+uint32_t SDRAM_RegionAlloc(const char *pName, SDRAM_RegionType_TypeDef Type, uint32_t Size, uint32_t Alignment)
+{
+  uint32_t address = 0;
+
+  address = SDRAM_RegionFit(SDRAM_BANK_ADDR, SDRAM_END_ADDR, Size, Alignment);
+  if (address == 0)
+  {
+    return 0;
+  }
+
+  return SDRAM_RegionInsert(pName, Type, address, Size);
+}
+
+/**
+  * @brief  Allocates a region in one internal bank of the SDRAM, aligned on
+  *         a row.
+  * @param  pName: region name, a static string shown in the memory map.
+  * @param  Type: region use.
+  * @param  Size: region size in bytes, at most SDRAM_INTERNAL_BANK_SIZE.
+  * @param  Bank: internal bank, from 0 to SDRAM_INTERNAL_BANKS - 1.
+  * @retval Region start, 0 if the bank has no free gap large enough or the
+  *         table is full.
+  */
+uint32_t SDRAM_RegionAllocInBank(const char *pName, SDRAM_RegionType_TypeDef Type, uint32_t Size, uint32_t Bank)
+{
+  uint32_t address = 0;
+
+  if (Bank >= SDRAM_INTERNAL_BANKS)
+  {
+    return 0;
+  }
+
+  address = SDRAM_RegionFit(SDRAM_BANK_START(Bank), SDRAM_BANK_START(Bank + 1), Size, SDRAM_ROW_SIZE);
+  if (address == 0)
+  {
+    return 0;
+  }
+
+  return SDRAM_RegionInsert(pName, Type, address, Size);
+}
+
+/**
+  * @brief  Gets a region of the memory map.
+  * @param  Index: region index, the regions are sorted by address.
+  * @retval Pointer to the region, 0 after the last region.
+  */
+const SDRAM_Region_TypeDef* SDRAM_RegionGet(uint32_t Index)
+{
+  if (Index >= SDRAMRegionCount)
+  {
+    return 0;
+  }
+  return &SDRAMRegions[Index];
+}
+
+/**
+  * @brief  Gets the SDRAM size left out of the regions.
+  * @param  None
+  * @retval Free size in bytes, all gaps included.
+  */
+uint32_t SDRAM_RegionGetFree(void)
+{
+  uint32_t index = 0, used = 0;
+
+  for (index = 0; index < SDRAMRegionCount; index++)
+  {
+    used += SDRAMRegions[index].Size;
+  }
+  return SDRAM_SIZE - used;
+}
+
+/**
+  * @brief  Prints the memory map: one line per region and per free gap.
+  * @param  pPutString: function printing a string, the lines end with CR LF.
+  * @retval None
+  */
+void SDRAM_RegionPrintMap(void (*pPutString)(const char *pString))
+{
+  uint32_t index = 0, address = SDRAM_BANK_ADDR;
+  char line[SDRAM_MAP_LINE_SIZE];
+  char *pLine = line;
+
+  pPutString("SDRAM memory map\r\n");
+
+  for (index = 0; index <= SDRAMRegionCount; index++)
+  {
+    /* Free gap before the region, or before the end of the SDRAM */
+    if (index < SDRAMRegionCount)
+    {
+      if (SDRAMRegions[index].Address > address)
+      {
+        SDRAM_MapLine(pPutString, address, SDRAMRegions[index].Address - address, "free", "");
+      }
+      SDRAM_MapLine(pPutString, SDRAMRegions[index].Address, SDRAMRegions[index].Size,
+                    SDRAMRegionTypeName[SDRAMRegions[index].Type], SDRAMRegions[index].pName);
+      address = SDRAMRegions[index].Address + SDRAMRegions[index].Size;
+    }
+    else if (address < SDRAM_END_ADDR)
+    {
+      SDRAM_MapLine(pPutString, address, SDRAM_END_ADDR - address, "free", "");
+    }
+  }
+
+  pLine = SDRAM_FormatString(pLine, "Free: ", 0);
+  pLine = SDRAM_FormatDecimal(pLine, SDRAM_RegionGetFree() / 1024, 0);
+  pLine = SDRAM_FormatString(pLine, " KB\r\n", 0);
+  *pLine = '\0';
+  pPutString(line);
+}
+
+/**
+  * @brief  Creates a pool of fixed size blocks in a new region.
+  * @param  pPool: pointer to the pool structure.
+  * @param  pName: region name, a static string shown in the memory map.
+  * @param  BlockSize: block size in bytes, rounded up to a multiple of 4.
+  * @param  Blocks: number of blocks.
+  * @retval Region start, 0 if the region could not be allocated.
+  */
+uint32_t SDRAM_PoolInit(SDRAM_Pool_TypeDef *pPool, const char *pName, uint32_t BlockSize, uint32_t Blocks)
+{
+  uint32_t index = 0, address = 0;
+
+  BlockSize = SDRAM_ALIGN((BlockSize == 0) ? 4 : BlockSize, 4);
+
+  if ((Blocks == 0) || (Blocks > (SDRAM_SIZE / BlockSize)))
+  {
+    return 0;
+  }
+
+  address = SDRAM_RegionAlloc(pName, SDRAM_REGION_POOL, BlockSize * Blocks, 4);
+  if (address == 0)
+  {
+    return 0;
+  }
+
+  pPool->Address = address;
+  pPool->BlockSize = BlockSize;
+  pPool->Blocks = Blocks;
+  pPool->Used = 0;
+  pPool->Peak = 0;
+
+  /* Free list in the address order: the first word of each block points to
+     the next free block */
+  for (index = 0; index < (Blocks - 1); index++)
+  {
+    *(__IO uint32_t*)(address + index * BlockSize) = address + (index + 1) * BlockSize;
+  }
+  *(__IO uint32_t*)(address + index * BlockSize) = 0;
+  pPool->pFree = (void*)address;
+
+  return address;
+}
+
+/**
+  * @brief  Allocates a block from a pool.
+  * @param  pPool: pointer to the pool structure.
+  * @retval Pointer to the block, 0 if all the blocks are used.
+  */
+void* SDRAM_PoolAlloc(SDRAM_Pool_TypeDef *pPool)
+{
+  uint32_t primask = __get_PRIMASK();
+  void *pBlock = 0;
+
+  __disable_irq();
+  pBlock = pPool->pFree;
+  if (pBlock != 0)
+  {
+    pPool->pFree = *(void**)pBlock;
+    pPool->Used++;
+    if (pPool->Used > pPool->Peak)
+    {
+      pPool->Peak = pPool->Used;
+    }
+  }
+  __set_PRIMASK(primask);
+
+  return pBlock;
+}
+
+/**
+  * @brief  Returns a block to its pool.
+  * @param  pPool: pointer to the pool structure.
+  * @param  pBlock: pointer to a block allocated from this pool. A pointer out
+  *         of the pool is ignored.
+  * @retval None
+  */
+void SDRAM_PoolFree(SDRAM_Pool_TypeDef *pPool, void *pBlock)
+{
+  uint32_t primask = 0;
+  uint32_t offset = (uint32_t)pBlock - pPool->Address;
+
+  if ((pBlock == 0) || ((uint32_t)pBlock < pPool->Address) ||
+      (offset >= (pPool->BlockSize * pPool->Blocks)) || ((offset % pPool->BlockSize) != 0))
+  {
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *(void**)pBlock = pPool->pFree;
+  pPool->pFree = pBlock;
+  pPool->Used--;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Creates an arena in a new region.
+  * @param  pArena: pointer to the arena structure.
+  * @param  pName: region name, a static string shown in the memory map.
+  * @param  Size: arena size in bytes.
+  * @retval Region start, 0 if the region could not be allocated.
+  */
+uint32_t SDRAM_ArenaInit(SDRAM_Arena_TypeDef *pArena, const char *pName, uint32_t Size)
+{
+  uint32_t address = 0;
+
+  address = SDRAM_RegionAlloc(pName, SDRAM_REGION_ARENA, Size, SDRAM_ROW_SIZE);
+  if (address == 0)
+  {
+    return 0;
+  }
+
+  pArena->Address = address;
+  pArena->Size = Size;
+  pArena->Offset = 0;
+  pArena->Peak = 0;
+
+  return address;
+}
+
+/**
+  * @brief  Allocates a buffer from an arena.
+  * @note   The arena functions must not be called from interrupts.
+  * @param  pArena: pointer to the arena structure.
+  * @param  Size: buffer size in bytes.
+  * @param  Alignment: alignment of the buffer, a power of 2. 0 selects a word
+  *         alignment.
+  * @retval Pointer to the buffer, 0 if the arena is full.
+  */
+void* SDRAM_ArenaAlloc(SDRAM_Arena_TypeDef *pArena, uint32_t Size, uint32_t Alignment)
+{
+  uint32_t address = 0;
+
+  if (Alignment == 0)
+  {
+    Alignment = 4;
+  }
+
+  address = SDRAM_ALIGN(pArena->Address + pArena->Offset, Alignment);
+  if ((address < pArena->Address) || (Size > (pArena->Address + pArena->Size - address)))
+  {
+    return 0;
+  }
+
+  pArena->Offset = address + Size - pArena->Address;
+  if (pArena->Offset > pArena->Peak)
+  {
+    pArena->Peak = pArena->Offset;
+  }
+
+  return (void*)address;
+}
+
+/**
+  * @brief  Gets the current position of an arena, to release the buffers
+  *         allocated after it with SDRAM_ArenaRelease().
+  * @param  pArena: pointer to the arena structure.
+  * @retval Mark.
+  */
+uint32_t SDRAM_ArenaMark(SDRAM_Arena_TypeDef *pArena)
+{
+  return pArena->Offset;
+}
+
+/**
+  * @brief  Releases the buffers allocated after a mark.
+  * @param  pArena: pointer to the arena structure.
+  * @param  Mark: value returned by SDRAM_ArenaMark(), 0 releases all the
+  *         buffers.
+  * @retval None
+  */
+void SDRAM_ArenaRelease(SDRAM_Arena_TypeDef *pArena, uint32_t Mark)
+{
+  if (Mark <= pArena->Offset)
+  {
+    pArena->Offset = Mark;
+  }
+}
+
+/**
+  * @brief  Finds the first free gap able to hold an aligned region.
+  * @param  Start: start of the searched range.
+  * @param  End: end of the searched range (excluded).
+  * @param  Size: region size in bytes.
+  * @param  Alignment: alignment of the region start, a power of 2 or 0.
+  * @retval Region start, 0 if no gap is large enough.
+  */
+static uint32_t SDRAM_RegionFit(uint32_t Start, uint32_t End, uint32_t Size, uint32_t Alignment)
+{
+  uint32_t index = 0, address = 0;
+
+  if (Alignment == 0)
+  {
+    Alignment = 4;
+  }
+  if ((Size == 0) || ((Alignment & (Alignment - 1)) != 0))
+  {
+    return 0;
+  }
+
+  address = SDRAM_ALIGN(Start, Alignment);
+  for (index = 0; index <= SDRAMRegionCount; index++)
+  {
+    if (address >= End)
+    {
+      return 0;
+    }
+    if ((index == SDRAMRegionCount) || (SDRAMRegions[index].Address >= End))
+    {
+      /* Last gap, up to the end of the range */
+      return (Size <= (End - address)) ? address : 0;
+    }
+    if ((SDRAMRegions[index].Address >= address) && (Size <= (SDRAMRegions[index].Address - address)))
+    {
+      return address;
+    }
+    /* Skip the region */
+    if ((SDRAMRegions[index].Address + SDRAMRegions[index].Size) > address)
+    {
+      address = SDRAM_ALIGN(SDRAMRegions[index].Address + SDRAMRegions[index].Size, Alignment);
+    }
+  }
+
+  return 0;
+}
+
+/**
+  * @brief  Inserts a free region in the table, keeping the address order.
+  * @param  pName: region name.
+  * @param  Type: region use.
+  * @param  Address: region start.
+  * @param  Size: region size in bytes.
+  * @retval Region start, 0 if the table is full.
+  */
+static uint32_t SDRAM_RegionInsert(const char *pName, SDRAM_RegionType_TypeDef Type, uint32_t Address, uint32_t Size)
+{
+  uint32_t index = SDRAMRegionCount;
+
+  if (SDRAMRegionCount >= SDRAM_REGIONS_MAX)
+  {
+    return 0;
+  }
+
+  while ((index > 0) && (SDRAMRegions[index - 1].Address > Address))
+  {
+    SDRAMRegions[index] = SDRAMRegions[index - 1];
+    index--;
+  }
+
+  SDRAMRegions[index].pName = pName;
+  SDRAMRegions[index].Address = Address;
+  SDRAMRegions[index].Size = Size;
+  SDRAMRegions[index].Type = Type;
+  SDRAMRegionCount++;
+
+  return Address;
+}
+
+/**
+  * @brief  Prints one line of the memory map:
+  *         "0xD0000000-0xD004AFFF    300 KB  bank 0    framebuffer  LCD layer 1"
+  * @param  pPutString: function printing a string.
+  * @param  Address: range start.
+  * @param  Size: range size in bytes.
+  * @param  pType: range use.
+  * @param  pName: range name.
+  * @retval None
+  */
+static void SDRAM_MapLine(void (*pPutString)(const char *pString), uint32_t Address, uint32_t Size,
+                          const char *pType, const char *pName)
+{
+  char line[SDRAM_MAP_LINE_SIZE];
+  char *pLine = line;
+  uint32_t first = SDRAM_INTERNAL_BANK(Address);
+  uint32_t last = SDRAM_INTERNAL_BANK(Address + Size - 1);
+
+  pLine = SDRAM_FormatHex(pLine, Address);
+  *pLine++ = '-';
+  pLine = SDRAM_FormatHex(pLine, Address + Size - 1);
+  pLine = SDRAM_FormatDecimal(pLine, (Size + 1023) / 1024, 7);
+  pLine = SDRAM_FormatString(pLine, " KB  bank ", 0);
+  *pLine++ = (char)('0' + first);
+  if (last != first)
+  {
+    *pLine++ = '-';
+    *pLine++ = (char)('0' + last);
+  }
+  else
+  {
+    pLine = SDRAM_FormatString(pLine, "  ", 0);
+  }
+  pLine = SDRAM_FormatString(pLine, "  ", 0);
+  pLine = SDRAM_FormatString(pLine, pType, ((pName != 0) && (*pName != '\0')) ? 13 : 0);
+  pLine = SDRAM_FormatString(pLine, (pName != 0) ? pName : "", 0);
+  pLine = SDRAM_FormatString(pLine, "\r\n", 0);
+  *pLine = '\0';
+
+  pPutString(line);
+}
+
+/**
+  * @brief  Formats a value as "0x" and 8 hexadecimal digits.
+  * @param  pLine: pointer to the output.
+  * @param  Value: value to format.
+  * @retval Pointer after the output.
+  */
+static char* SDRAM_FormatHex(char *pLine, uint32_t Value)
+{
+  int32_t shift = 0;
+  uint32_t digit = 0;
+
+  *pLine++ = '0';
+  *pLine++ = 'x';
+  for (shift = 28; shift >= 0; shift -= 4)
+  {
+    digit = (Value >> shift) & 0x0F;
+    *pLine++ = (char)((digit < 10) ? ('0' + digit) : ('A' + digit - 10));
+  }
+  return pLine;
+}
+
+/**
+  * @brief  Formats a decimal value, right aligned.
+  * @param  pLine: pointer to the output.
+  * @param  Value: value to format.
+  * @param  Width: field width, 0 for the digits only.
+  * @retval Pointer after the output.
+  */
+static char* SDRAM_FormatDecimal(char *pLine, uint32_t Value, uint32_t Width)
+{
+  char digits[10];
+  uint32_t count = 0;
+
+  do
+  {
+    digits[count++] = (char)('0' + (Value % 10));
+    Value /= 10;
+  } while (Value != 0);
+
+  while (Width > count)
+  {
+    *pLine++ = ' ';
+    Width--;
+  }
+  while (count > 0)
+  {
+    *pLine++ = digits[--count];
+  }
+  return pLine;
+}
+
+/**
+  * @brief  Formats a string, left aligned. The string is cut to fit the map
+  *         line.
+  * @param  pLine: pointer to the output.
+  * @param  pString: string to format.
+  * @param  Width: field width, 0 for the string only.
+  * @retval Pointer after the output.
+  */
+static char* SDRAM_FormatString(char *pLine, const char *pString, uint32_t Width)
+{
+  uint32_t count = 0;
+
+  while ((*pString != '\0') && (count < 32))
+  {
+    *pLine++ = *pString++;
+    count++;
+  }
+  while (count < Width)
+  {
+    *pLine++ = ' ';
+    count++;
+  }
+  return pLine;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
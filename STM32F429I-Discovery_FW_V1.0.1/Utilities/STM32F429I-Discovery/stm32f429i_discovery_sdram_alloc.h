@@ -0,0 +1,187 @@
+/**
+  ******************************************************************************
+  * @file    stm32f429i_discovery_sdram_alloc.h
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    28-October-2013
+  * @brief   This file contains all the functions prototypes for
+  *          the stm32f429i_discovery_sdram_alloc.c firmware driver.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F429I_DISCOVERY_SDRAM_ALLOC_H
+#define __STM32F429I_DISCOVERY_SDRAM_ALLOC_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f429i_discovery_sdram.h"
+
+/** @addtogroup Utilities
+  * @{
+  */
+
+/** @addtogroup STM32F4_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY
+  * @{
+  */
+
+/** @addtogroup STM32F429I_DISCOVERY_SDRAM_ALLOC
+  * @{
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Exported_Types
+  * @{
+  */
+
+/**
+  * @brief  SDRAM region use, shown in the memory map
+  */
+typedef enum
+{
+  SDRAM_REGION_FRAMEBUFFER = 0,  /* LTDC layers and back buffers */
+  SDRAM_REGION_HEAP,             /* graphic library heap */
+  SDRAM_REGION_POOL,             /* fixed size blocks, SDRAM_PoolInit() */
+  SDRAM_REGION_ARENA,            /* stack allocator, SDRAM_ArenaInit() */
+  SDRAM_REGION_BUFFER            /* other buffers: pictures, traces, test areas */
+}SDRAM_RegionType_TypeDef;
+
+/**
+  * @brief  SDRAM region
+  */
+typedef struct
+{
+  const char *pName;             /* static string */
+  uint32_t Address;
+  uint32_t Size;                 /* bytes */
+  SDRAM_RegionType_TypeDef Type;
+}SDRAM_Region_TypeDef;
+
+/**
+  * @brief  Pool of fixed size blocks (sprites, asset cache entries)
+  */
+typedef struct
+{
+  uint32_t Address;              /* first block */
+  uint32_t BlockSize;            /* bytes, multiple of 4 */
+  uint32_t Blocks;
+  uint32_t Used;                 /* blocks allocated */
+  uint32_t Peak;                 /* highest Used */
+  void     *pFree;               /* free blocks, linked by their first word */
+}SDRAM_Pool_TypeDef;
+
+/**
+  * @brief  Arena: allocations released together, or back to a mark (traces,
+  *         per-screen data)
+  */
+typedef struct
+{
+  uint32_t Address;
+  uint32_t Size;                 /* bytes */
+  uint32_t Offset;               /* first free byte */
+  uint32_t Peak;                 /* highest Offset */
+}SDRAM_Arena_TypeDef;
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Exported_Constants
+  * @{
+  */
+
+/* IS42S16400J: 8 MB in 4 internal banks of 4096 rows. The internal bank is
+   selected by the highest address bits (A22:A21), each bank keeps one row
+   open: buffers read at the same time (LTDC layers, drawing target) are
+   best placed in different banks */
+#define SDRAM_SIZE                ((uint32_t)0x00800000)
+#define SDRAM_INTERNAL_BANKS      4
+#define SDRAM_INTERNAL_BANK_SIZE  (SDRAM_SIZE / SDRAM_INTERNAL_BANKS)
+#define SDRAM_ROW_SIZE            ((uint32_t)0x00000200)   /* 256 columns of 16 bits */
+
+/* Maximum number of regions */
+#ifndef SDRAM_REGIONS_MAX
+ #define SDRAM_REGIONS_MAX        16
+#endif /* SDRAM_REGIONS_MAX */
+
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Exported_Macros
+  * @{
+  */
+#define SDRAM_INTERNAL_BANK(ADDRESS)   (((ADDRESS) - SDRAM_BANK_ADDR) / SDRAM_INTERNAL_BANK_SIZE)
+#define SDRAM_BANK_START(BANK)         (SDRAM_BANK_ADDR + (uint32_t)(BANK) * SDRAM_INTERNAL_BANK_SIZE)
+/**
+  * @}
+  */
+
+/** @defgroup STM32F429I_DISCOVERY_SDRAM_ALLOC_Exported_Functions
+  * @{
+  */
+uint32_t SDRAM_RegionReserve(const char *pName, SDRAM_RegionType_TypeDef Type, uint32_t Address, uint32_t Size);
+uint32_t SDRAM_RegionAlloc(const char *pName, SDRAM_RegionType_TypeDef Type, uint32_t Size, uint32_t Alignment);
+uint32_t SDRAM_RegionAllocInBank(const char *pName, SDRAM_RegionType_TypeDef Type, uint32_t Size, uint32_t Bank);
+const SDRAM_Region_TypeDef* SDRAM_RegionGet(uint32_t Index);
+uint32_t SDRAM_RegionGetFree(void);
+void     SDRAM_RegionPrintMap(void (*pPutString)(const char *pString));
+
+uint32_t SDRAM_PoolInit(SDRAM_Pool_TypeDef *pPool, const char *pName, uint32_t BlockSize, uint32_t Blocks);
+void*    SDRAM_PoolAlloc(SDRAM_Pool_TypeDef *pPool);
+void     SDRAM_PoolFree(SDRAM_Pool_TypeDef *pPool, void *pBlock);
+
+uint32_t SDRAM_ArenaInit(SDRAM_Arena_TypeDef *pArena, const char *pName, uint32_t Size);
+void*    SDRAM_ArenaAlloc(SDRAM_Arena_TypeDef *pArena, uint32_t Size, uint32_t Alignment);
+uint32_t SDRAM_ArenaMark(SDRAM_Arena_TypeDef *pArena);
+void     SDRAM_ArenaRelease(SDRAM_Arena_TypeDef *pArena, uint32_t Mark);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F429I_DISCOVERY_SDRAM_ALLOC_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/